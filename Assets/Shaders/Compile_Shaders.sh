@@ -1,2 +0,0 @@
-"${VULKAN_SDK}"/bin/glslangValidator -V ./test.vert
-"${VULKAN_SDK}"/bin/glslangValidator -V ./test.frag
\ No newline at end of file
@@ -0,0 +1,44 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 inNormal;
+layout(location = 1) in vec2 inUv;
+layout(location = 2) flat in uint inMaterial;
+layout(location = 0) out vec4 outColor;
+
+const uint INVALID_INDEX = 0xFFFFFFFFu;
+
+struct Material {
+    vec4 color;
+    uint textureIndex;
+    uint samplerIndex;
+    uint pad0;
+    uint pad1;
+};
+
+layout(set = 0, binding = 0) uniform texture2D gTextures[];
+layout(set = 0, binding = 1) readonly buffer MaterialBuffer { Material materials[]; } gBuffers[];
+layout(set = 0, binding = 2) uniform sampler gSamplers[];
+
+layout(push_constant) uniform SceneConstants {
+    mat4 viewProjection;
+    uint vertexBuffer;
+    uint instanceBuffer;
+    uint meshBuffer;
+    uint materialBuffer;
+} scene;
+
+void main() {
+    // Fixed directional light until the scene has lights.
+    float light = max(dot(normalize(inNormal), normalize(vec3(0.3, 1.0, 0.5))), 0.0) * 0.8 + 0.2;
+    outColor = vec4(vec3(light), 1.0);
+
+    if (scene.materialBuffer != INVALID_INDEX) {
+        Material material = gBuffers[scene.materialBuffer].materials[inMaterial];
+        outColor *= material.color;
+
+        if (material.textureIndex != INVALID_INDEX) {
+            outColor *= texture(sampler2D(gTextures[nonuniformEXT(material.textureIndex)], gSamplers[nonuniformEXT(material.samplerIndex)]), inUv);
+        }
+    }
+}
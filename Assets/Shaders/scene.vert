@@ -0,0 +1,44 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Scene objects (VulkanGpuScene), drawn with indirect commands; the instance index is the object's index.
+struct Vertex {
+    float px, py, pz;
+    float nx, ny, nz;
+    float u, v;
+};
+
+struct Instance {
+    mat4 transform;
+    uint mesh;
+    uint material;
+    uint batch;
+    uint pad;
+};
+
+// Global bindless set (VulkanBindlessHeap); both blocks alias the storage buffer binding.
+layout(set = 0, binding = 1) readonly buffer VertexBuffer { Vertex vertices[]; } gVertexBuffers[];
+layout(set = 0, binding = 1) readonly buffer InstanceBuffer { Instance instances[]; } gInstanceBuffers[];
+
+layout(push_constant) uniform SceneConstants {
+    mat4 viewProjection;
+    uint vertexBuffer;
+    uint instanceBuffer;
+    uint meshBuffer;
+    uint materialBuffer;
+} scene;
+
+layout(location = 0) out vec3 outNormal;
+layout(location = 1) out vec2 outUv;
+layout(location = 2) flat out uint outMaterial;
+
+void main() {
+    // gl_VertexIndex already includes the mesh's vertex offset.
+    Vertex vertex = gVertexBuffers[scene.vertexBuffer].vertices[gl_VertexIndex];
+    Instance instance = gInstanceBuffers[scene.instanceBuffer].instances[gl_InstanceIndex];
+
+    gl_Position = scene.viewProjection * instance.transform * vec4(vertex.px, vertex.py, vertex.pz, 1.0);
+    outNormal = mat3(instance.transform) * vec3(vertex.nx, vertex.ny, vertex.nz);
+    outUv = vec2(vertex.u, vertex.v);
+    outMaterial = instance.material;
+}
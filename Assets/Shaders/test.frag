@@ -1,8 +1,39 @@
 #version 450    // Vrersion 4.5
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec3 fragColor;     // Interpoated color from vertex (Location must match).
 layout(location = 0) out vec4 outColor;     // Final output color (Must also have location).
 
+const uint INVALID_INDEX = 0xFFFFFFFFu;
+
+struct Material {
+    vec4 color;
+    uint textureIndex;      // Into gTextures.
+    uint samplerIndex;      // Into gSamplers.
+    uint pad0;
+    uint pad1;
+};
+
+// Global bindless set (VulkanBindlessHeap); bound once per frame, indexed through push constants.
+layout(set = 0, binding = 0) uniform texture2D gTextures[];
+layout(set = 0, binding = 1) readonly buffer MaterialBuffer { Material materials[]; } gBuffers[];
+layout(set = 0, binding = 2) uniform sampler gSamplers[];
+
+layout(push_constant) uniform DrawConstants {
+    uint materialBuffer;    // Into gBuffers, INVALID_INDEX for none.
+    uint materialIndex;     // Into that buffer's materials.
+} draw;
+
 void main() {
     outColor = vec4(fragColor, 1.0);
-}
\ No newline at end of file
+
+    if (draw.materialBuffer != INVALID_INDEX) {
+        Material material = gBuffers[nonuniformEXT(draw.materialBuffer)].materials[draw.materialIndex];
+        outColor *= material.color;
+
+        if (material.textureIndex != INVALID_INDEX) {
+            sampler2D tex = sampler2D(gTextures[nonuniformEXT(material.textureIndex)], gSamplers[nonuniformEXT(material.samplerIndex)]);
+            outColor *= texture(tex, fragColor.xy);
+        }
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Renderers/RendererType.h"
+#include "Renderers/LatencyProfile.h"
 
 namespace Vkr
 {
@@ -27,6 +28,26 @@ namespace Vkr
         // Type of renderer to use for this application.
         RendererType rendererType = RendererType::Vulkan;
 
+        // Number of frames the renderer may have in flight on the GPU at once (1 - 3), 0 for the latency profile's.
+        unsigned char framesInFlight = 0;
+
+        // How the renderer trades input latency against smoothness and power.
+        LatencyProfile latencyProfile = LatencyProfile::Balanced;
+
+        // Whether the renderer picks a discrete GPU over an integrated one, or the other way round, e.g. to save power.
+        bool preferDiscreteGpu = true;
+
+        // Whether the renderer may fall back to a CPU implementation (e.g. lavapipe) when no GPU qualifies.
+        bool allowCpuDevice = true;
+
+        // Whether to render into offscreen images without a window, e.g. for benchmarks and image tests. Frames are
+        // read back to host memory and run as fast as the GPU renders them. Also set by the VKR_HEADLESS variable.
+        bool offscreen = false;
+
+        // Rate (per second) at which Update keeps being called while the window is invisible.
+        // Nothing is rendered while suspended; 0 pauses the application entirely.
+        float suspendedUpdateRate = 0;
+
         // Function pointer to the application's initialize function.
         virtual bool Initialize() = 0;
 
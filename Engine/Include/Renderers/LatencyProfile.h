@@ -0,0 +1,12 @@
+#pragma once
+
+namespace Vkr
+{
+    // Trade-off between input latency, smoothness and power the renderer presents frames with.
+    enum class LatencyProfile : char
+    {
+        LowLatency,     // Starts each frame as late as it can still make the next vblank; one frame in flight.
+        Balanced,       // Renders ahead by a frame, without tearing.
+        PowerSaving     // Never renders frames that aren't shown; the CPU and GPU idle between vblanks.
+    };
+}
@@ -1,9 +1,12 @@
 #include "ApplicationManager.h"
 #include "Platform/Platform.h"
+#include "Core/Input/InputSystem.h"
 #include "Core/Event/Keyboard/KeyEvent.h"
 #include "Core/Event/Mouse/MouseMovedEvent.h"
 #include "Core/Event/Mouse/MouseButtonEvent.h"
 #include "Core/Event/Mouse/MouseScrolledEvent.h"
+#include "Core/Event/Application/WindowResizeEvent.h"
+#include "Core/Event/Application/AppSuspendEvent.h"
 
 namespace Vkr
 {
@@ -48,6 +51,43 @@ namespace Vkr
         return true;
     }
 
+    bool ApplicationManager::OnWindowResize(const SenderType senderType, const ListenerType listenerType, Event *event)
+    {
+        auto ev = (WindowResizeEvent *)event;
+
+        if (ev->GetWidth() == mWidth && ev->GetHeight() == mHeight)
+            return true;
+
+        mWidth = ev->GetWidth();
+        mHeight = ev->GetHeight();
+
+        // The renderer only records the new size here; the swapchain is recreated once the resize settles.
+        mpRendererClient->OnResize(mWidth, mHeight);
+        mpApp->OnResize(mWidth, mHeight);
+
+        return true;
+    }
+
+    bool ApplicationManager::OnAppSuspend(const SenderType senderType, const ListenerType listenerType, Event *event)
+    {
+        auto ev = (AppSuspendEvent *)event;
+
+        if (ev->IsSuspended() == mSuspended)
+            return true;
+
+        mSuspended = ev->IsSuspended();
+        VINFO("Application %s.", mSuspended ? "suspended" : "resumed")
+
+        // Don't hand the time spent suspended to the next update as one huge delta.
+        if (!mSuspended && mpCLock)
+        {
+            mpCLock->Update();
+            mLastTime = mpCLock->GetElapsedTime();
+        }
+
+        return true;
+    }
+
     StatusCode ApplicationManager::InitializeSubsystems()
     {
         StatusCode statusCode = Logger::InitializeLogging();
@@ -74,12 +114,31 @@ namespace Vkr
 		statusCode = EventSystemManager::RegisterEvent(EventType::WindowClose, ListenerType::Application, BIND_CALLBACK_FUNCTION(OnWindowClose));
         ENSURE_SUCCESS(statusCode, "An error occurred while registering `WindowClose` event.")
 
+		statusCode = EventSystemManager::RegisterEvent(EventType::WindowResize, ListenerType::Application, BIND_CALLBACK_FUNCTION(OnWindowResize));
+        ENSURE_SUCCESS(statusCode, "An error occurred while registering `WindowResize` event.")
+
+		statusCode = EventSystemManager::RegisterEvent(EventType::AppSuspended, ListenerType::Application, BIND_CALLBACK_FUNCTION(OnAppSuspend));
+        ENSURE_SUCCESS(statusCode, "An error occurred while registering `AppSuspended` event.")
+
+		statusCode = EventSystemManager::RegisterEvent(EventType::AppResumed, ListenerType::Application, BIND_CALLBACK_FUNCTION(OnAppSuspend));
+        ENSURE_SUCCESS(statusCode, "An error occurred while registering `AppResumed` event.")
+
 		statusCode = mPlatform->CreateNewWindow(mpApp->name, mpApp->startX, mpApp->startY, mpApp->width, mpApp->height);
         ENSURE_SUCCESS(statusCode, "Error occurred while initializing platform.")
 
         // Renderer startup
+        RendererConfig rendererConfig{};
+        rendererConfig.appName = mpApp->name;
+        rendererConfig.width = mpApp->width;
+        rendererConfig.height = mpApp->height;
+        rendererConfig.framesInFlight = mpApp->framesInFlight;
+        rendererConfig.latencyProfile = mpApp->latencyProfile;
+        rendererConfig.preferDiscreteGpu = mpApp->preferDiscreteGpu;
+        rendererConfig.allowCpuDevice = mpApp->allowCpuDevice;
+        rendererConfig.offscreen = mpApp->offscreen;
+
         mpRendererClient = std::make_unique<RendererClient>();
-        return mpRendererClient->Initialize(mPlatform, mpApp->rendererType, mpApp->name);
+        return mpRendererClient->Initialize(mPlatform, mpApp->rendererType, rendererConfig);
     }
 
     StatusCode ApplicationManager::TerminateSubsystems()
@@ -116,6 +175,8 @@ namespace Vkr
         mpApp = pApp;
         mRunning = true;
         mSuspended = false;
+        mWidth = mpApp->width;
+        mHeight = mpApp->height;
 
         StatusCode statusCode = InitializeSubsystems();
 		RETURN_ON_FAIL(statusCode)
@@ -150,10 +211,16 @@ namespace Vkr
         mLastTime = mpCLock->GetStartTime();
         f64 runningTime = 0;
         u8 frameCount = 0;
-        const f64 targetFrameSeconds = 1.0f / 60;
+        f64 targetFrameSeconds = 1.0f / 60;
 
         while (mRunning)
         {
+            // A renderer pacing frames returns when the frame should start, so input is read as late as possible.
+            const bool paced = !mSuspended && mpRendererClient->PaceFrame();
+
+            // Roll the input tables over before the platform writes this frame's input into them.
+            InputSystem::Update();
+
             if (!mPlatform->PollForEvents())
             {
                 mRunning = false;
@@ -182,10 +249,23 @@ namespace Vkr
                     break;
                 }
 
-                // TODO: refactor packet creation
-                // render_packet packet;
-                // packet.delta_time = delta;
-                // renderer_draw_frame(&packet);
+                // Hand the frame over to the renderer.
+                RendererPacket packet{};
+                packet.deltaTime = (f32)delta;
+
+                if (mpRendererClient->DrawFrame(&packet) != StatusCode::Successful)
+                {
+                    VFATAL("Renderer failed to draw the frame.")
+                    mRunning = false;
+                    break;
+                }
+
+                // Pace to the refresh rate of the display the frames are actually shown on, when the platform knows it.
+                PresentationTiming timing{};
+                if (mPlatform->GetPresentationTiming(&timing) && timing.refreshInterval > 0)
+                {
+                    targetFrameSeconds = timing.refreshInterval;
+                }
 
                 // Figure out how long the frame took and, if below
                 f64 frameEndTime = mPlatform->GetAbsoluteTime();
@@ -193,7 +273,8 @@ namespace Vkr
                 runningTime += frameElapsedTime;
                 f64 remainingSeconds = targetFrameSeconds - frameElapsedTime;
 
-                if (remainingSeconds > 0)
+                // A renderer pacing frames already waited for the display, and offscreen frames aren't shown on one.
+                if (remainingSeconds > 0 && !paced && !mpApp->offscreen)
                 {
                     u64 remainingMilliSecs = (remainingSeconds * 1000);
 
@@ -212,6 +293,40 @@ namespace Vkr
                 // Update last time
                 mLastTime = currentTime;
             }
+            else
+            {
+                // The window may have been closed while minimized; waiting now would never return.
+                if (!mRunning)
+                    break;
+
+                // Nothing is visible, so nothing is rendered. Block until the platform has something to say instead
+                // of spinning, waking up only for the reduced simulation ticks if the application asked for them.
+                if (mpApp->suspendedUpdateRate <= 0)
+                {
+                    mPlatform->WaitForEvents(-1);
+                    continue;
+                }
+
+                mpCLock->Update();
+
+                const f64 currentTime = mpCLock->GetElapsedTime();
+                const f64 untilNextTick = mLastTime + 1.0 / mpApp->suspendedUpdateRate - currentTime;
+
+                if (untilNextTick > 0)
+                {
+                    mPlatform->WaitForEvents((i32)(untilNextTick * 1000) + 1);
+                    continue;
+                }
+
+                if (!mpApp->Update((f32)(currentTime - mLastTime)))
+                {
+                    VFATAL("Game update failed.")
+                    mRunning = false;
+                    break;
+                }
+
+                mLastTime = currentTime;
+            }
         }
 
         mRunning = false;
@@ -64,6 +64,12 @@ namespace Vkr
         // Event handler to handle window close events.
         bool OnWindowClose(const SenderType senderType, const ListenerType listenerType, Event *event);
 
+        // Event handler to handle window resize events.
+        bool OnWindowResize(const SenderType senderType, const ListenerType listenerType, Event *event);
+
+        // Event handler to handle the application being suspended or resumed.
+        bool OnAppSuspend(const SenderType senderType, const ListenerType listenerType, Event *event);
+
     public:
         explicit ApplicationManager(const std::shared_ptr<Platform> &platform);
         DESTRUCTOR_LOG(ApplicationManager)
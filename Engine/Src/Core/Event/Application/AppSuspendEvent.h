@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Core/Event/Event.h"
+#include "Core/Event/Enums/EventCategory.h"
+
+namespace Vkr
+{
+    // A class to represent the application window becoming invisible (unmapped, minimized or fully obscured)
+    // or visible again.
+    class AppSuspendEvent : public Event
+    {
+    public:
+        explicit AppSuspendEvent(bool suspended) : suspended(suspended) {}
+
+        [[nodiscard]] inline i32 GetCategoryFlags() const override
+        {
+            return to_underlying(EventCategory::ApplicationEvent);
+        }
+
+        [[nodiscard]] inline EventType GetEventType() const override { return suspended ? EventType::AppSuspended : EventType::AppResumed; }
+        [[nodiscard]] inline bool IsSuspended() const { return suspended; }
+
+    private:
+        bool suspended;
+    };
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Core/Event/Event.h"
+#include "Core/Event/Enums/EventCategory.h"
+
+namespace Vkr
+{
+    // A class to represent a change in the size of the application window.
+    class WindowResizeEvent : public Event
+    {
+    public:
+        WindowResizeEvent(const u16 width, const u16 height) : mWidth(width), mHeight(height) {}
+
+        [[nodiscard]] inline u16 GetWidth() const { return mWidth; }
+        [[nodiscard]] inline u16 GetHeight() const { return mHeight; }
+
+        [[nodiscard]] inline EventType GetEventType() const override { return EventType::WindowResize; }
+
+        [[nodiscard]] inline i32 GetCategoryFlags() const override
+        {
+            return to_underlying(EventCategory::ApplicationEvent);
+        }
+
+    private:
+        const u16 mWidth, mHeight;
+    };
+}
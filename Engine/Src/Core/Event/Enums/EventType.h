@@ -13,6 +13,8 @@ namespace Vkr
         AppUpdate,           // Application update event.
         AppRender,           // Application render event.
         AppShutDown,         // Application shutdown event.
+        AppSuspended,        // Application window became invisible event.
+        AppResumed,          // Application window became visible again event.
         KeyPressed,          // Keyboard button pressed event.
         KeyReleased,         // Keyboard button released event.
         MouseButtonPressed,  // Mouse button pressed event.
@@ -0,0 +1,125 @@
+#include "InputSystem.h"
+
+namespace Vkr
+{
+    InputSystem::InputState InputSystem::current;
+    InputSystem::InputState InputSystem::previous;
+    InputSystem::InputEdges InputSystem::edges;
+    i32 InputSystem::scrollDelta = 0;
+    f32 InputSystem::rawDeltaX = 0;
+    f32 InputSystem::rawDeltaY = 0;
+    bool InputSystem::rawMotionAvailable = false;
+
+    void InputSystem::Update()
+    {
+        previous = current;
+        edges = {};
+        scrollDelta = 0;
+        rawDeltaX = 0;
+        rawDeltaY = 0;
+    }
+
+    void InputSystem::Reset()
+    {
+        current.keys.reset();
+        current.mouseButtons.reset();
+        previous = current;
+        edges = {};
+        scrollDelta = 0;
+        rawDeltaX = 0;
+        rawDeltaY = 0;
+    }
+
+    void InputSystem::ProcessKey(Key key, bool pressed)
+    {
+        // Platforms may hand over codes which have no `Key` equivalent.
+        const auto index = (u32)to_underlying(key);
+        if (index >= KEY_COUNT)
+            return;
+
+        // Auto-repeat delivers further presses of a key that is already down; those are not edges.
+        if (pressed && !current.keys.test(index))
+            edges.keysPressed.set(index);
+        else if (!pressed && current.keys.test(index))
+            edges.keysReleased.set(index);
+
+        current.keys.set(index, pressed);
+    }
+
+    void InputSystem::ProcessMouseButton(MouseButton button, bool pressed)
+    {
+        const auto index = (u32)to_underlying(button);
+        if (index >= MOUSE_BUTTON_COUNT)
+            return;
+
+        if (pressed && !current.mouseButtons.test(index))
+            edges.mouseButtonsPressed.set(index);
+        else if (!pressed && current.mouseButtons.test(index))
+            edges.mouseButtonsReleased.set(index);
+
+        current.mouseButtons.set(index, pressed);
+    }
+
+    void InputSystem::ProcessMouseMove(i32 x, i32 y)
+    {
+        current.mouseX = x;
+        current.mouseY = y;
+    }
+
+    void InputSystem::ProcessMouseWheel(i32 delta)
+    {
+        scrollDelta += delta;
+    }
+
+    void InputSystem::ProcessRawMouseMotion(f32 dx, f32 dy)
+    {
+        rawDeltaX += dx;
+        rawDeltaY += dy;
+    }
+
+    bool InputSystem::IsKeyDown(Key key)
+    {
+        const auto index = (u32)to_underlying(key);
+        return index < KEY_COUNT && current.keys.test(index);
+    }
+
+    bool InputSystem::IsKeyUp(Key key)
+    {
+        return !IsKeyDown(key);
+    }
+
+    bool InputSystem::WasKeyPressed(Key key)
+    {
+        const auto index = (u32)to_underlying(key);
+        return index < KEY_COUNT && edges.keysPressed.test(index);
+    }
+
+    bool InputSystem::WasKeyReleased(Key key)
+    {
+        const auto index = (u32)to_underlying(key);
+        return index < KEY_COUNT && edges.keysReleased.test(index);
+    }
+
+    bool InputSystem::IsMouseButtonDown(MouseButton button)
+    {
+        const auto index = (u32)to_underlying(button);
+        return index < MOUSE_BUTTON_COUNT && current.mouseButtons.test(index);
+    }
+
+    bool InputSystem::IsMouseButtonUp(MouseButton button)
+    {
+        return !IsMouseButtonDown(button);
+    }
+
+    bool InputSystem::WasMouseButtonPressed(MouseButton button)
+    {
+        const auto index = (u32)to_underlying(button);
+        return index < MOUSE_BUTTON_COUNT && edges.mouseButtonsPressed.test(index);
+    }
+
+    bool InputSystem::WasMouseButtonReleased(MouseButton button)
+    {
+        const auto index = (u32)to_underlying(button);
+        return index < MOUSE_BUTTON_COUNT && edges.mouseButtonsReleased.test(index);
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Defines.h"
+#include "Key.h"
+#include "MouseButton.h"
+#include <bitset>
+
+namespace Vkr
+{
+    // A class that keeps the polled state of the keyboard and the mouse.
+    // The platform writes into the current tables while pumping its events; at the start of every frame
+    // the current tables are copied into the previous ones, so queries are plain bit tests with no dispatch.
+    // Presses and releases are also latched as they arrive, so a tap shorter than a frame is not lost.
+    class InputSystem
+    {
+    private:
+        static constexpr u32 KEY_COUNT = to_underlying(Key::Unknown) + 1;
+        static constexpr u32 MOUSE_BUTTON_COUNT = to_underlying(MouseButton::Unknown) + 1;
+
+        struct InputState
+        {
+            std::bitset<KEY_COUNT> keys;
+            std::bitset<MOUSE_BUTTON_COUNT> mouseButtons;
+            i32 mouseX{};
+            i32 mouseY{};
+        };
+
+        // Transitions seen during the current frame, whatever the state at its end.
+        struct InputEdges
+        {
+            std::bitset<KEY_COUNT> keysPressed;
+            std::bitset<KEY_COUNT> keysReleased;
+            std::bitset<MOUSE_BUTTON_COUNT> mouseButtonsPressed;
+            std::bitset<MOUSE_BUTTON_COUNT> mouseButtonsReleased;
+        };
+
+        static InputState current;
+        static InputState previous;
+        static InputEdges edges;
+        static i32 scrollDelta;
+        static f32 rawDeltaX;
+        static f32 rawDeltaY;
+        static bool rawMotionAvailable;
+
+    public:
+        InputSystem(const InputSystem &) = delete;
+        void operator=(InputSystem const &) = delete;
+
+        // Starts a new input frame. Should be called once per frame, just before the platform polls for events.
+        static void Update();
+
+        // Clears all input state, e.g. when the window loses focus and releases will never arrive.
+        static void Reset();
+
+        /**
+         * Records a key press or release.
+         * @param key The key whose state changed.
+         * @param pressed true if the key was pressed; false if it was released.
+         */
+        static void ProcessKey(Key key, bool pressed);
+
+        /**
+         * Records a mouse button press or release.
+         * @param button The mouse button whose state changed.
+         * @param pressed true if the button was pressed; false if it was released.
+         */
+        static void ProcessMouseButton(MouseButton button, bool pressed);
+
+        /**
+         * Records the position of the cursor.
+         * @param x The x coordinate of the cursor relative to the window.
+         * @param y The y coordinate of the cursor relative to the window.
+         */
+        static void ProcessMouseMove(i32 x, i32 y);
+
+        /**
+         * Records a scroll wheel step.
+         * @param delta Positive when scrolled up; negative when scrolled down.
+         */
+        static void ProcessMouseWheel(i32 delta);
+
+        /**
+         * Accumulates unaccelerated pointer motion, as reported by the device rather than the cursor.
+         * @param dx Motion along the x axis, in device units.
+         * @param dy Motion along the y axis, in device units.
+         */
+        static void ProcessRawMouseMotion(f32 dx, f32 dy);
+
+        // Set by the platform when it delivers raw pointer motion through ProcessRawMouseMotion.
+        inline static void SetRawMotionAvailable(bool available) { rawMotionAvailable = available; }
+
+        // Keyboard queries.
+        [[nodiscard]] static bool IsKeyDown(Key key);
+        [[nodiscard]] static bool IsKeyUp(Key key);
+        [[nodiscard]] static bool WasKeyPressed(Key key);  // Went down during this frame, even if it is up again.
+        [[nodiscard]] static bool WasKeyReleased(Key key); // Went up during this frame, even if it is down again.
+
+        // Mouse queries.
+        [[nodiscard]] static bool IsMouseButtonDown(MouseButton button);
+        [[nodiscard]] static bool IsMouseButtonUp(MouseButton button);
+        [[nodiscard]] static bool WasMouseButtonPressed(MouseButton button);
+        [[nodiscard]] static bool WasMouseButtonReleased(MouseButton button);
+
+        [[nodiscard]] inline static i32 GetMouseX() { return current.mouseX; }
+        [[nodiscard]] inline static i32 GetMouseY() { return current.mouseY; }
+        [[nodiscard]] inline static i32 GetMouseDeltaX() { return current.mouseX - previous.mouseX; }
+        [[nodiscard]] inline static i32 GetMouseDeltaY() { return current.mouseY - previous.mouseY; }
+        [[nodiscard]] inline static i32 GetScrollDelta() { return scrollDelta; }
+
+        // Pointer motion of this frame for camera-style controls. Unaccelerated device deltas when the platform
+        // provides them; otherwise the cursor delta.
+        [[nodiscard]] inline static bool IsRawMotionAvailable() { return rawMotionAvailable; }
+        [[nodiscard]] inline static f32 GetRawMouseDeltaX() { return rawMotionAvailable ? rawDeltaX : (f32)GetMouseDeltaX(); }
+        [[nodiscard]] inline static f32 GetRawMouseDeltaY() { return rawMotionAvailable ? rawDeltaY : (f32)GetMouseDeltaY(); }
+    };
+}
@@ -0,0 +1,97 @@
+#include "ThreadPool.h"
+
+namespace Vkr
+{
+    static thread_local i32 currentWorkerIndex = -1;
+
+    ThreadPool::~ThreadPool()
+    {
+        Shutdown();
+    }
+
+    void ThreadPool::Initialize(u32 workerCount)
+    {
+        if (workerCount == 0)
+            workerCount = VMAX(std::thread::hardware_concurrency(), 2u) - 1;
+
+        mStopping = false;
+        mWorkers.reserve(workerCount);
+        for (u32 i = 0; i < workerCount; ++i)
+        {
+            mWorkers.emplace_back(&ThreadPool::WorkerLoop, this, (i32)i);
+        }
+
+        VDEBUG("Thread pool started with %u workers.", workerCount)
+    }
+
+    void ThreadPool::Shutdown()
+    {
+        if (mWorkers.empty())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+
+        mJobAvailable.notify_all();
+        for (auto &worker : mWorkers)
+        {
+            worker.join();
+        }
+
+        mWorkers.clear();
+    }
+
+    void ThreadPool::Submit(std::function<void()> &&job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mJobs.push_back(std::move(job));
+        }
+
+        mJobAvailable.notify_one();
+    }
+
+    void ThreadPool::WaitIdle()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mIdle.wait(lock, [this]() { return mJobs.empty() && mActiveJobs == 0; });
+    }
+
+    i32 ThreadPool::GetCurrentWorkerIndex()
+    {
+        return currentWorkerIndex;
+    }
+
+    void ThreadPool::WorkerLoop(i32 workerIndex)
+    {
+        currentWorkerIndex = workerIndex;
+
+        while (true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mJobAvailable.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+
+                // Drain the queue before stopping, so nothing submitted is silently dropped.
+                if (mJobs.empty())
+                    return;
+
+                job = std::move(mJobs.front());
+                mJobs.pop_front();
+                ++mActiveJobs;
+            }
+
+            job();
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                --mActiveJobs;
+                if (mJobs.empty() && mActiveJobs == 0)
+                    mIdle.notify_all();
+            }
+        }
+    }
+}
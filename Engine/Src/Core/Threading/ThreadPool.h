@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Defines.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Vkr
+{
+    // A fixed set of worker threads running jobs in submission order.
+    class ThreadPool
+    {
+    private:
+        std::vector<std::thread> mWorkers;
+        std::deque<std::function<void()>> mJobs;
+        std::mutex mMutex;
+        std::condition_variable mJobAvailable;
+        std::condition_variable mIdle;
+        u32 mActiveJobs{};
+        bool mStopping = false;
+
+        void WorkerLoop(i32 workerIndex);
+
+    public:
+        ThreadPool() = default;
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        void operator=(ThreadPool const &) = delete;
+
+        /**
+         * Starts the worker threads.
+         * @param workerCount Number of workers, 0 for one less than the number of hardware threads (at least 1).
+         */
+        void Initialize(u32 workerCount = 0);
+
+        // Runs the jobs still queued, then joins the workers.
+        void Shutdown();
+
+        // Queues a job to run on one of the workers.
+        void Submit(std::function<void()> &&job);
+
+        // Blocks until the queue is empty and no job is running.
+        void WaitIdle();
+
+        [[nodiscard]] inline u32 GetWorkerCount() const { return (u32)mWorkers.size(); }
+
+        // Index of the worker the caller runs on, or -1 when not called from a worker of any pool.
+        static i32 GetCurrentWorkerIndex();
+    };
+}
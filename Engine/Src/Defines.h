@@ -52,7 +52,9 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 
 // For Vulkan surface creation
 #define VK_USE_PLATFORM_XCB_KHR
-// #define VK_USE_PLATFORM_WAYLAND_KHR
+#if defined(VKR_WAYLAND)
+#define VK_USE_PLATFORM_WAYLAND_KHR
+#endif
 
 #include <xcb/xcb.h>
 #include <X11/keysym.h>
@@ -2,7 +2,9 @@
 #include "Defines.h"
 #include "Core/Application/ApplicationManager.h"
 #include "Platform/LinuxPlatform.h"
+#include "Platform/WaylandPlatform.h"
 #include "Platform/PlatformWindows.h"
+#include "Platform/HeadlessPlatform.h"
 
 #if defined(_DEBUG)
 // void *operator new(size_t size)
@@ -20,8 +22,20 @@
         return to_underlying(statusCode);                   \
     }
 
-std::shared_ptr<Vkr::Platform> GetPlatform() {
+std::shared_ptr<Vkr::Platform> GetPlatform(bool headless) {
+	// Offscreen rendering needs no window; VKR_HEADLESS_FRAMES bounds the run, e.g. for benchmarks.
+	if (headless)
+	{
+		const char *frameLimit = getenv("VKR_HEADLESS_FRAMES");
+		return std::make_shared<Vkr::HeadlessPlatform>(frameLimit ? strtoull(frameLimit, nullptr, 10) : 0);
+	}
+
 #if defined(VPLATFORM_LINUX)
+#if defined(VKR_WAYLAND)
+	// Prefer the native backend when running under a Wayland compositor.
+	if (getenv("WAYLAND_DISPLAY") != nullptr)
+		return std::make_shared<Vkr::WaylandPlatform>();
+#endif
 	return std::make_shared<Vkr::LinuxPlatform>();
 #elif defined(VPLATFORM_WINDOWS)
 	return std::make_shared<Vkr::PlatformWindows>();
@@ -29,10 +43,16 @@ std::shared_ptr<Vkr::Platform> GetPlatform() {
 }
 
 int main(int argc, char **argv) {
-	auto appManager = std::make_unique<Vkr::ApplicationManager>(GetPlatform());
+	Vkr::Application *pApp = GetApplication();
+
+	// Renders any application offscreen, e.g. on machines without a display.
+	if (getenv("VKR_HEADLESS") != nullptr)
+		pApp->offscreen = true;
+
+	auto appManager = std::make_unique<Vkr::ApplicationManager>(GetPlatform(pApp->offscreen));
 
 	// Initialize the application.
-	Vkr::StatusCode statusCode = appManager->InitializeApplication(GetApplication());
+	Vkr::StatusCode statusCode = appManager->InitializeApplication(pApp);
 	CHECK_APPLICATION_STATUS(statusCode, "Failed to initialize the application!")
 
 	// Run the application.
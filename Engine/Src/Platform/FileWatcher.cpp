@@ -0,0 +1,83 @@
+#include "FileWatcher.h"
+#include <filesystem>
+
+#if defined(VPLATFORM_LINUX)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Vkr
+{
+#if defined(VPLATFORM_LINUX)
+    FileWatcher::~FileWatcher()
+    {
+        // Closing the descriptor removes every watch.
+        if (mFd != -1)
+            close(mFd);
+    }
+
+    bool FileWatcher::Watch(const std::string &directory)
+    {
+        if (mFd == -1)
+        {
+            mFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (mFd == -1)
+            {
+                VWARN("Failed to initialize inotify; file changes won't be picked up.")
+                return false;
+            }
+        }
+
+        // Editors either write in place or write a temporary file and rename it over the original; catch both.
+        i32 wd = inotify_add_watch(mFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd == -1)
+        {
+            VWARN("Failed to watch '%s'.", directory.c_str())
+            return false;
+        }
+
+        mDirectories[wd] = directory;
+        return true;
+    }
+
+    void FileWatcher::Poll(std::vector<std::string> *outPaths)
+    {
+        if (mFd == -1)
+            return;
+
+        alignas(inotify_event) char buffer[4096];
+        while (true)
+        {
+            ssize_t length = read(mFd, buffer, sizeof(buffer));
+            if (length <= 0)
+                break;
+
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += (ssize_t)(sizeof(inotify_event) + event->len);
+
+                auto directory = mDirectories.find(event->wd);
+                if (event->len == 0 || directory == mDirectories.end())
+                    continue;
+
+                std::string path = (std::filesystem::path(directory->second) / event->name).string();
+                if (std::find(outPaths->begin(), outPaths->end(), path) == outPaths->end())
+                    outPaths->push_back(std::move(path));
+            }
+        }
+    }
+
+#else
+    FileWatcher::~FileWatcher() = default;
+
+    bool FileWatcher::Watch(const std::string &directory)
+    {
+        return false;
+    }
+
+    void FileWatcher::Poll(std::vector<std::string> *outPaths)
+    {
+    }
+#endif
+}
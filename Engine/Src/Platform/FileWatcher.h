@@ -0,0 +1,35 @@
+#pragma once
+#include "Defines.h"
+
+namespace Vkr
+{
+    // Reports files written in a set of watched directories. Polled, never blocks.
+    // Only implemented on Linux (inotify); elsewhere watching fails and nothing is ever reported.
+    class FileWatcher
+    {
+    private:
+#if defined(VPLATFORM_LINUX)
+        i32 mFd = -1;
+        std::unordered_map<i32, std::string> mDirectories;     // Watched directories by watch descriptor.
+#endif
+
+    public:
+        FileWatcher() = default;
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher &) = delete;
+        void operator=(FileWatcher const &) = delete;
+
+        /**
+         * Starts watching a directory (not its subdirectories).
+         * @return Whether the directory is being watched.
+         */
+        bool Watch(const std::string &directory);
+
+        /**
+         * Collects the files written since the last poll. A file written several times is reported once.
+         * @param outPaths Receives the paths, as the watched directory joined with the file name.
+         */
+        void Poll(std::vector<std::string> *outPaths);
+    };
+}
@@ -0,0 +1,58 @@
+#include "HeadlessPlatform.h"
+#include <chrono>
+#include <thread>
+
+namespace Vkr
+{
+    StatusCode HeadlessPlatform::CreateNewWindow(const char *windowName, i16 x, i16 y, u16 width, u16 height)
+    {
+        // There is no window; the renderer is created at the requested size regardless.
+        VINFO("Running headless at %ux%u.", width, height)
+        return StatusCode::Successful;
+    }
+
+    StatusCode HeadlessPlatform::CloseWindow()
+    {
+        return StatusCode::Successful;
+    }
+
+    bool HeadlessPlatform::PollForEvents()
+    {
+        // Polled once per frame, before the frame is rendered; the frame polling false is still the last one rendered.
+        ++mFrameCount;
+        return mFrameLimit == 0 || mFrameCount < mFrameLimit;
+    }
+
+    void HeadlessPlatform::WaitForEvents(i32 timeoutMs)
+    {
+        // No event ever arrives; only wait out the timeout.
+        if (timeoutMs > 0)
+            SleepForDuration(timeoutMs);
+    }
+
+    f64 HeadlessPlatform::GetAbsoluteTime()
+    {
+        const auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration<f64>(now).count();
+    }
+
+    bool HeadlessPlatform::GetPresentationTiming(PresentationTiming *timing)
+    {
+        // Nothing is presented.
+        return false;
+    }
+
+    void HeadlessPlatform::SleepForDuration(u64 ms)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+
+    void HeadlessPlatform::AddRequiredVulkanExtensions(std::vector<const char *> &extensions)
+    {
+    }
+
+    StatusCode HeadlessPlatform::CreateVulkanSurface(VkInstance *instance, VkAllocationCallbacks *allocator, VkSurfaceKHR *surface)
+    {
+        return StatusCode::PlatformHeadlessHasNoSurface;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Platform.h"
+
+namespace Vkr
+{
+    // Platform without a window or input, for rendering offscreen: benchmarks, image tests and server-side rendering.
+    // The renderer draws into its own images instead of a surface. Runs until the frame limit is reached, if any.
+    class HeadlessPlatform final : public Platform
+    {
+    private:
+        u64 mFrameLimit{};          // Number of frames polled for before the application is told to quit, 0 for none.
+        u64 mFrameCount{};          // Number of times events were polled for, i.e. frames run.
+
+    public:
+        /**
+         * @param frameLimit Number of frames to run before the application quits, 0 to run until it quits itself.
+         */
+        explicit HeadlessPlatform(u64 frameLimit = 0) : mFrameLimit(frameLimit) {}
+        ~HeadlessPlatform() override = default;
+
+        HeadlessPlatform(const HeadlessPlatform &) = delete;
+        void operator=(HeadlessPlatform const &) = delete;
+
+        StatusCode CreateNewWindow(const char *windowName, i16 x, i16 y, u16 width, u16 height) override;
+        StatusCode CloseWindow() override;
+        bool PollForEvents() override;
+        void WaitForEvents(i32 timeoutMs) override;
+        f64 GetAbsoluteTime() override;
+        bool GetPresentationTiming(PresentationTiming *timing) override;
+        void SleepForDuration(u64 duration) override;
+        void AddRequiredVulkanExtensions(std::vector<const char *> &extensions) override;
+        StatusCode CreateVulkanSurface(VkInstance *instance, VkAllocationCallbacks *allocator, VkSurfaceKHR *surface) override;
+    };
+}
@@ -1,15 +1,53 @@
 #include "LinuxPlatform.h"
 
 #if defined(VPLATFORM_LINUX)
+#include "Core/Input/InputSystem.h"
 #include "Core/Event/Registrar/EventSystemManager.h"
 #include "Core/Event/Keyboard/KeyEvent.h"
 #include "Core/Event/Mouse/MouseMovedEvent.h"
 #include "Core/Event/Mouse/MouseButtonEvent.h"
 #include "Core/Event/Mouse/MouseScrolledEvent.h"
 #include "Core/Event/Application/WindowCloseEvent.h"
+#include "Core/Event/Application/WindowResizeEvent.h"
+#include "Core/Event/Application/AppSuspendEvent.h"
+#include <poll.h>
+
+#if defined(VKR_XINPUT2)
+#include <xcb/xinput.h>
+#endif
 
 namespace Vkr
 {
+#if defined(VKR_XINPUT2)
+    namespace
+    {
+        inline f64 FixedToDouble(const xcb_input_fp3232_t &value)
+        {
+            return value.integral + value.frac / 4294967296.0;
+        }
+
+        // Reads the unaccelerated x/y deltas of a raw motion event. Values are only sent for the valuators set
+        // in the mask, packed in increasing valuator order; valuators 0 and 1 are the pointer's x and y axes.
+        void ReadRawMotionDelta(const xcb_input_raw_motion_event_t *event, f64 *dx, f64 *dy)
+        {
+            *dx = 0;
+            *dy = 0;
+
+            if (xcb_input_raw_button_press_valuator_mask_length(event) == 0)
+                return;
+
+            const u32 mask = xcb_input_raw_button_press_valuator_mask(event)[0];
+            const xcb_input_fp3232_t *values = xcb_input_raw_button_press_axisvalues_raw(event);
+
+            if (mask & BIT(0))
+                *dx = FixedToDouble(*values++);
+
+            if (mask & BIT(1))
+                *dy = FixedToDouble(*values);
+        }
+    }
+#endif
+
     LinuxPlatform::~LinuxPlatform()
     {
         CleanUp();
@@ -60,7 +98,8 @@ namespace Vkr
                              XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION |
                              XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_LEAVE_WINDOW |
                              XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE |
-                             XCB_EVENT_MASK_STRUCTURE_NOTIFY};
+                             XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_FOCUS_CHANGE |
+                             XCB_EVENT_MASK_VISIBILITY_CHANGE};
 
         /* Create the window */
         xcb_create_window(mConnection,                   /* Connection          */
@@ -122,6 +161,9 @@ namespace Vkr
             1,
             &wm_delete_reply->atom);
 
+        // Prefer unaccelerated pointer motion at the device's full report rate when the server supports it.
+        SelectRawMotionEvents();
+
         /* Map the window on the screen */
         xcb_map_window(mConnection, mWindow);
 
@@ -134,6 +176,8 @@ namespace Vkr
             return StatusCode::XcbFlushError;
         }
 
+        mWidth = width;
+        mHeight = height;
         mInitialized = true;
 
         return StatusCode::Successful;
@@ -151,6 +195,16 @@ namespace Vkr
         xcb_generic_event_t *event;
         bool quit = false;
 
+        // A window drag produces a burst of configure notifications; only the last size in the burst is reported.
+        bool resized = false;
+
+        // Visibility may flip several times within a poll; only the final state is reported.
+        const bool wasSuspended = !mMapped || mObscured;
+
+        // A high-rate mouse produces many raw motion events per frame; they are summed and handed over once.
+        f64 rawDeltaX = 0;
+        f64 rawDeltaY = 0;
+
         while ((event = xcb_poll_for_event(mConnection)))
         {
             if (quit)
@@ -174,6 +228,8 @@ namespace Vkr
                     0,
                     kp->detail & ShiftMask ? 1 : 0));
 
+                InputSystem::ProcessKey(key, pressed);
+
                 KeyEvent kEvent(key, pressed);
                 EventSystemManager::Dispatch(&kEvent, SenderType::Platform);
 
@@ -209,12 +265,16 @@ namespace Vkr
                 {
                     if (pressed)
                     {
+                        InputSystem::ProcessMouseWheel(mouseButton == MouseButton::ScrollWheelUp ? 1 : -1);
+
                         MouseScrolledEvent mEvent(mouseButton == MouseButton::ScrollWheelUp, bp->event_x, bp->event_y);
                         EventSystemManager::Dispatch(&mEvent, SenderType::Platform);
                     }
                 }
                 else
                 {
+                    InputSystem::ProcessMouseButton(mouseButton, pressed);
+
                     MouseButtonEvent mEvent(mouseButton, pressed, bp->event_x, bp->event_y);
                     EventSystemManager::Dispatch(&mEvent, SenderType::Platform);
                 }
@@ -224,6 +284,7 @@ namespace Vkr
             case XCB_MOTION_NOTIFY:
             {
                 auto *mv = (xcb_motion_notify_event_t *)event;
+                InputSystem::ProcessMouseMove(mv->event_x, mv->event_y);
 
                 // MouseMovedEvent event(mv->event_x, mv->event_y);
                 // EventSystemManager::Dispatch(&event, SenderType::Platform);
@@ -257,10 +318,64 @@ namespace Vkr
             }
             case XCB_CONFIGURE_NOTIFY:
             {
-                // VDEBUG("Window modified!!!")
-                // TODO: Resizing
+                // Also fired on window moves, so only react to an actual change in size.
+                auto *cn = (xcb_configure_notify_event_t *)event;
+
+                if (cn->width != mWidth || cn->height != mHeight)
+                {
+                    mWidth = cn->width;
+                    mHeight = cn->height;
+                    resized = true;
+                }
+
+                break;
+            }
+            case XCB_MAP_NOTIFY:
+            case XCB_UNMAP_NOTIFY:
+            {
+                // Sent when the window is minimized, hidden or moved to another workspace, and back.
+                mMapped = (event->response_type & ~0x80) == XCB_MAP_NOTIFY;
+                break;
+            }
+            case XCB_VISIBILITY_NOTIFY:
+            {
+                auto *vn = (xcb_visibility_notify_event_t *)event;
+                mObscured = vn->state == XCB_VISIBILITY_FULLY_OBSCURED;
                 break;
             }
+            case XCB_FOCUS_IN:
+            case XCB_FOCUS_OUT:
+            {
+                mFocused = (event->response_type & ~0x80) == XCB_FOCUS_IN;
+
+                // Releases which happen while unfocused never arrive, so don't keep anything held down.
+                if (!mFocused)
+                    InputSystem::Reset();
+
+                break;
+            }
+#if defined(VKR_XINPUT2)
+            case XCB_GE_GENERIC:
+            {
+                auto *ge = (xcb_ge_generic_event_t *)event;
+
+                if (mRawMotion && ge->extension == mXInputOpcode && ge->event_type == XCB_INPUT_RAW_MOTION)
+                {
+                    f64 dx, dy;
+                    ReadRawMotionDelta((xcb_input_raw_motion_event_t *)event, &dx, &dy);
+                    rawDeltaX += dx;
+                    rawDeltaY += dy;
+
+                    if (!mRawMotionSeen)
+                    {
+                        VINFO("Receiving XInput 2 raw pointer motion.")
+                        mRawMotionSeen = true;
+                    }
+                }
+
+                break;
+            }
+#endif
             case XCB_CLIENT_MESSAGE:
             {
                 auto *cm = (xcb_client_message_event_t *)event;
@@ -286,9 +401,84 @@ namespace Vkr
             free(event);
         }
 
+        if (mFocused && (rawDeltaX != 0 || rawDeltaY != 0))
+        {
+            InputSystem::ProcessRawMouseMotion((f32)rawDeltaX, (f32)rawDeltaY);
+        }
+
+        const bool suspended = !mMapped || mObscured;
+        if (suspended != wasSuspended && !quit)
+        {
+            AppSuspendEvent sEvent(suspended);
+            EventSystemManager::Dispatch(&sEvent, SenderType::Platform);
+        }
+
+        if (resized && !quit)
+        {
+            WindowResizeEvent rEvent(mWidth, mHeight);
+            EventSystemManager::Dispatch(&rEvent, SenderType::Platform);
+        }
+
         return !quit;
     }
 
+    void LinuxPlatform::WaitForEvents(i32 timeoutMs)
+    {
+        // PollForEvents drains XCB's queue, so anything new has to come through the connection's socket.
+        xcb_flush(mConnection);
+
+        pollfd fd{};
+        fd.fd = xcb_get_file_descriptor(mConnection);
+        fd.events = POLLIN;
+
+        poll(&fd, 1, timeoutMs < 0 ? -1 : timeoutMs);
+    }
+
+    void LinuxPlatform::SelectRawMotionEvents()
+    {
+#if defined(VKR_XINPUT2)
+        const xcb_query_extension_reply_t *extension = xcb_get_extension_data(mConnection, &xcb_input_id);
+        if (extension == nullptr || !extension->present)
+        {
+            VWARN("XInput extension is not available, using core pointer motion.")
+            return;
+        }
+
+        // Raw events were introduced with XInput 2.0.
+        xcb_input_xi_query_version_reply_t *version = xcb_input_xi_query_version_reply(
+            mConnection,
+            xcb_input_xi_query_version(mConnection, 2, 0),
+            nullptr);
+
+        if (version == nullptr || version->major_version < 2)
+        {
+            VWARN("XInput 2 is not supported by the X server, using core pointer motion.")
+            free(version);
+            return;
+        }
+
+        free(version);
+
+        // Raw events are only delivered to the root window, for every master device.
+        struct
+        {
+            xcb_input_event_mask_t header;
+            u32 mask;
+        } eventMask{};
+
+        eventMask.header.deviceid = XCB_INPUT_DEVICE_ALL_MASTER;
+        eventMask.header.mask_len = 1; // In 4 byte units.
+        eventMask.mask = XCB_INPUT_XI_EVENT_MASK_RAW_MOTION;
+
+        xcb_input_xi_select_events(mConnection, mScreen->root, 1, &eventMask.header);
+
+        mXInputOpcode = extension->major_opcode;
+        mRawMotion = true;
+        InputSystem::SetRawMotionAvailable(true);
+        VINFO("Using XInput 2 raw pointer motion.")
+#endif
+    }
+
     void LinuxPlatform::AddRequiredVulkanExtensions(std::vector<const char *> &extensions)
     {
         extensions.emplace_back(VK_KHR_XCB_SURFACE_EXTENSION_NAME);
@@ -319,6 +509,12 @@ namespace Vkr
         return now.tv_sec + now.tv_nsec * 0.000000001;
     }
 
+    bool LinuxPlatform::GetPresentationTiming(PresentationTiming *timing)
+    {
+        // X11 has no presentation feedback without the Present extension.
+        return false;
+    }
+
     void LinuxPlatform::SleepForDuration(u64 ms)
     {
 #if _POSIX_C_SOURCE >= 199309L
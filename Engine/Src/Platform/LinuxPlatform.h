@@ -16,11 +16,22 @@ namespace Vkr
         xcb_screen_t *mScreen{};
         xcb_atom_t mProtocols{};
         xcb_atom_t mDeleteWin{};
+        u16 mWidth{};
+        u16 mHeight{};
+        bool mMapped = false;       // Whether the window is mapped (i.e. not minimized or hidden).
+        bool mObscured = false;     // Whether the window is fully covered by other windows.
+        bool mFocused = true;       // Raw input is delivered regardless of focus, so it is only used while focused.
+        bool mRawMotion = false;    // Whether XInput2 raw pointer motion has been subscribed to.
+        u8 mXInputOpcode{};         // Major opcode of the XInput extension, identifies its generic events.
+        bool mRawMotionSeen = false; // Whether a raw motion event has arrived yet; logged once.
 
-        static Key TranslateKeycode(KeySym xKeycode);
+        void SelectRawMotionEvents();
         void CleanUp();
 
     public:
+        // Translates an X keysym. XKB keysyms share the same values, so the Wayland backend uses this as well.
+        static Key TranslateKeycode(KeySym xKeycode);
+
         LinuxPlatform() = default;
         ~LinuxPlatform() override;
 
@@ -30,7 +41,9 @@ namespace Vkr
         StatusCode CreateNewWindow(const char *windowName, i16 x, i16 y, u16 width, u16 height) override;
         StatusCode CloseWindow() override;
         bool PollForEvents() override;
+        void WaitForEvents(i32 timeoutMs) override;
         f64 GetAbsoluteTime() override;
+        bool GetPresentationTiming(PresentationTiming *timing) override;
         void SleepForDuration(u64 duration) override;
         void AddRequiredVulkanExtensions(std::vector<const char *> &extensions) override;
 		StatusCode CreateVulkanSurface(VkInstance *instance, VkAllocationCallbacks *allocator, VkSurfaceKHR *surface) override;
@@ -0,0 +1,110 @@
+#include "MappedFile.h"
+
+#if defined(VPLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(VPLATFORM_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace Vkr
+{
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+#if defined(VPLATFORM_LINUX)
+    bool MappedFile::Open(const std::string &path)
+    {
+        Close();
+
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            return false;
+
+        struct stat fileStat{};
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        void *data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        // The mapping keeps its own reference to the file.
+        close(fd);
+
+        if (data == MAP_FAILED)
+            return false;
+
+        mpData = data;
+        mSize = (size_t)fileStat.st_size;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (mpData)
+            munmap(const_cast<void *>(mpData), mSize);
+
+        mpData = nullptr;
+        mSize = 0;
+    }
+
+#elif defined(VPLATFORM_WINDOWS)
+    bool MappedFile::Open(const std::string &path)
+    {
+        Close();
+
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        mFileHandle = file;
+        mMappingHandle = mapping;
+        mpData = data;
+        mSize = (size_t)fileSize.QuadPart;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (mpData)
+            UnmapViewOfFile(mpData);
+        if (mMappingHandle)
+            CloseHandle(mMappingHandle);
+        if (mFileHandle)
+            CloseHandle(mFileHandle);
+
+        mpData = nullptr;
+        mMappingHandle = nullptr;
+        mFileHandle = nullptr;
+        mSize = 0;
+    }
+#endif
+}
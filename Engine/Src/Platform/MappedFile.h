@@ -0,0 +1,36 @@
+#pragma once
+#include "Defines.h"
+
+namespace Vkr
+{
+    // A read-only memory mapping of a whole file. The data is page aligned, so it can be read as any
+    // fundamental type without copying. The mapping is released when the object is destroyed.
+    class MappedFile
+    {
+    private:
+        const void *mpData{};
+        size_t mSize{};
+#if defined(VPLATFORM_WINDOWS)
+        void *mFileHandle{};
+        void *mMappingHandle{};
+#endif
+
+        void Close();
+
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        void operator=(MappedFile const &) = delete;
+
+        /**
+         * Maps the file at the given path.
+         * @return Whether the file could be opened and mapped. Empty files can't be mapped.
+         */
+        bool Open(const std::string &path);
+
+        [[nodiscard]] inline const void *GetData() const { return mpData; }
+        [[nodiscard]] inline size_t GetSize() const { return mSize; }
+    };
+}
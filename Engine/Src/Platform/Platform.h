@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Defines.h"
+#include "PresentationTiming.h"
 
 namespace Vkr
 {
@@ -27,9 +28,20 @@ namespace Vkr
         /** Polls for events on the platform specific window. */
         virtual bool PollForEvents() = 0;
 
+        /** Blocks the calling thread until the platform has events to be polled, without spinning.
+         * @param timeoutMs Maximum time to wait in milliseconds; negative waits indefinitely.
+         */
+        virtual void WaitForEvents(i32 timeoutMs) = 0;
+
         /* Gets the absolute time from the underlying platform. */
         virtual f64 GetAbsoluteTime() = 0;
 
+        /** Gets the display timing of the most recently presented frames, used for frame pacing.
+         * @param timing Receives the timing information.
+         * @returns true if the platform reports presentation timing; otherwise false.
+         */
+        virtual bool GetPresentationTiming(PresentationTiming *timing) = 0;
+
         /** SleepForDuration on the thread for the provided ms. This blocks the main thread.
          * Should only be used for giving time back to the OS for unused update power.
          * Therefore it is not exported.
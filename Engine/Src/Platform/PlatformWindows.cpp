@@ -4,12 +4,15 @@
 
 #include "Core/Input/Key.h"
 #include "Core/Input/MouseButton.h"
+#include "Core/Input/InputSystem.h"
 #include "Core/Event/Registrar/EventSystemManager.h"
 #include "Core/Event/Keyboard/KeyEvent.h"
 #include "Core/Event/Mouse/MouseMovedEvent.h"
 #include "Core/Event/Mouse/MouseButtonEvent.h"
 #include "Core/Event/Mouse/MouseScrolledEvent.h"
 #include "Core/Event/Application/WindowCloseEvent.h"
+#include "Core/Event/Application/WindowResizeEvent.h"
+#include "Core/Event/Application/AppSuspendEvent.h"
 
 #include <vulkan/vulkan_win32.h>
 
@@ -125,6 +128,11 @@ namespace Vkr
         return true;
     }
 
+    void PlatformWindows::WaitForEvents(i32 timeoutMs)
+    {
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, timeoutMs < 0 ? INFINITE : (DWORD)timeoutMs, QS_ALLINPUT);
+    }
+
     void PlatformWindows::SleepForDuration(u64 duration)
     {
         Sleep(duration);
@@ -137,6 +145,11 @@ namespace Vkr
         return (f64)nowTime.QuadPart * mClockFrequency;
     }
 
+    bool PlatformWindows::GetPresentationTiming(PresentationTiming *timing)
+    {
+        return false;
+    }
+
     StatusCode PlatformWindows::CreateVulkanSurface(VkInstance *instance, VkAllocationCallbacks *allocator, VkSurfaceKHR *surface)
     {
         VkWin32SurfaceCreateInfoKHR createInfo = {VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR};
@@ -176,12 +189,17 @@ namespace Vkr
         case WM_SIZE:
         {
             // Get the updated size.
-            // RECT r;
-            // GetClientRect(hwnd, &r);
-            // u32 width = r.right - r.left;
-            // u32 height = r.bottom - r.top;
+            RECT r;
+            GetClientRect(hwnd, &r);
+            u32 width = r.right - r.left;
+            u32 height = r.bottom - r.top;
+
+            WindowResizeEvent event((u16)width, (u16)height);
+            EventSystemManager::Dispatch(&event, SenderType::Platform);
 
-            // TODO: Fire an event for window resize.
+            // Suspend while minimized; repeated notifications are ignored by the application.
+            AppSuspendEvent sEvent(w_param == SIZE_MINIMIZED);
+            EventSystemManager::Dispatch(&sEvent, SenderType::Platform);
 
             break;
         }
@@ -193,6 +211,7 @@ namespace Vkr
             // Key pressed/released
             bool pressed = (msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN);
             Key key = (Key)w_param;
+            InputSystem::ProcessKey(key, pressed);
 
             KeyEvent kEvent(key, pressed);
             EventSystemManager::Dispatch(&kEvent, SenderType::Platform);
@@ -204,6 +223,7 @@ namespace Vkr
             // Mouse move
             i32 xPosition = GET_X_LPARAM(l_param);
             i32 yPosition = GET_Y_LPARAM(l_param);
+            InputSystem::ProcessMouseMove(xPosition, yPosition);
 
             // MouseMovedEvent event(xPosition,yPosition);
             // EventSystemManager::Dispatch(&event, SenderType::Platform);
@@ -218,6 +238,8 @@ namespace Vkr
 
             if (zDelta != 0)
             {
+                InputSystem::ProcessMouseWheel(zDelta > 0 ? 1 : -1);
+
                 MouseScrolledEvent mEvent(zDelta > 0, xPosition, yPosition);
                 EventSystemManager::Dispatch(&mEvent, SenderType::Platform);
             }
@@ -253,6 +275,8 @@ namespace Vkr
                 break;
             }
 
+            InputSystem::ProcessMouseButton(mouseButton, pressed);
+
             // Pass over to the event subsystem.
             MouseButtonEvent mEvent(mouseButton, pressed, xPosition, yPosition);
             EventSystemManager::Dispatch(&mEvent, SenderType::Platform);
@@ -32,8 +32,12 @@ namespace Vkr
 
         bool PollForEvents() override;
 
+        void WaitForEvents(i32 timeoutMs) override;
+
         f64 GetAbsoluteTime() override;
 
+        bool GetPresentationTiming(PresentationTiming *timing) override;
+
         void SleepForDuration(u64 duration) override;
 
         void AddRequiredVulkanExtensions(std::vector<const char *> &extensions) override;
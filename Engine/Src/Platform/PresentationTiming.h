@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Defines.h"
+
+namespace Vkr
+{
+    // Display timing reported back by the compositor for frames which were actually shown.
+    struct PresentationTiming
+    {
+        f64 lastPresentTime{};  // Time the most recent frame turned into light, on the `GetAbsoluteTime` clock.
+        f64 refreshInterval{};  // Refresh interval of the output the frame was shown on in seconds; 0 if unknown.
+        u64 presentedFrames{};  // Number of frames reported as presented.
+        u64 discardedFrames{};  // Number of frames which were never shown.
+    };
+}
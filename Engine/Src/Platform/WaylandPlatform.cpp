@@ -0,0 +1,593 @@
+#include "WaylandPlatform.h"
+
+#if defined(VPLATFORM_LINUX) && defined(VKR_WAYLAND)
+#include "LinuxPlatform.h"
+#include "Core/Input/InputSystem.h"
+#include "Core/Event/Registrar/EventSystemManager.h"
+#include "Core/Event/Keyboard/KeyEvent.h"
+#include "Core/Event/Mouse/MouseButtonEvent.h"
+#include "Core/Event/Mouse/MouseScrolledEvent.h"
+#include "Core/Event/Application/WindowCloseEvent.h"
+#include "Core/Event/Application/WindowResizeEvent.h"
+#include "Core/Event/Application/AppSuspendEvent.h"
+
+#include <linux/input-event-codes.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Vkr
+{
+#if defined(XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION)
+    // Version 6 introduces the suspended toplevel state, sent when the window is minimized or fully hidden.
+    constexpr u32 XDG_WM_BASE_VERSION = 6;
+#else
+    constexpr u32 XDG_WM_BASE_VERSION = 1;
+#endif
+
+    WaylandPlatform::~WaylandPlatform()
+    {
+        CleanUp();
+    }
+
+    StatusCode WaylandPlatform::CreateNewWindow(const char *windowName, i16 x, i16 y, u16 width, u16 height)
+    {
+        if (mInitialized)
+        {
+            VWARN("Platform has already been initialized!")
+            return StatusCode::PlatformAlreadyInitialized;
+        }
+
+        // Connect to the compositor named by WAYLAND_DISPLAY.
+        mpDisplay = wl_display_connect(nullptr);
+
+        if (mpDisplay == nullptr)
+        {
+            VFATAL("Failed to connect to the Wayland compositor.")
+            return StatusCode::WaylandConnectionFailed;
+        }
+
+        static const wl_registry_listener registryListener{OnRegistryGlobal, OnRegistryGlobalRemove};
+
+        // Collect the globals; the first round trip returns all of them.
+        mpRegistry = wl_display_get_registry(mpDisplay);
+        wl_registry_add_listener(mpRegistry, &registryListener, this);
+        wl_display_roundtrip(mpDisplay);
+
+        if (mpCompositor == nullptr || mpWmBase == nullptr)
+        {
+            VFATAL("The Wayland compositor does not support wl_compositor and xdg_wm_base.")
+            return StatusCode::WaylandRequiredGlobalMissing;
+        }
+
+        if (mpPresentation == nullptr)
+        {
+            VWARN("The Wayland compositor does not support wp_presentation, frame pacing falls back to the target frame rate.")
+        }
+
+        mpXkbContext = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+
+        static const xdg_wm_base_listener wmBaseListener{OnWmBasePing};
+        static const xdg_surface_listener xdgSurfaceListener{OnXdgSurfaceConfigure};
+        static const xdg_toplevel_listener toplevelListener{
+            OnToplevelConfigure,
+            OnToplevelClose,
+#if defined(XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION)
+            [](void *, xdg_toplevel *, i32, i32) {},      // configure_bounds
+            [](void *, xdg_toplevel *, wl_array *) {},    // wm_capabilities
+#endif
+        };
+
+        xdg_wm_base_add_listener(mpWmBase, &wmBaseListener, this);
+
+        // Windows are positioned by the compositor on Wayland, so x and y are ignored.
+        mpSurface = wl_compositor_create_surface(mpCompositor);
+        mpXdgSurface = xdg_wm_base_get_xdg_surface(mpWmBase, mpSurface);
+        xdg_surface_add_listener(mpXdgSurface, &xdgSurfaceListener, this);
+
+        mpToplevel = xdg_surface_get_toplevel(mpXdgSurface);
+        xdg_toplevel_add_listener(mpToplevel, &toplevelListener, this);
+        xdg_toplevel_set_title(mpToplevel, windowName);
+        xdg_toplevel_set_app_id(mpToplevel, windowName);
+
+        // Nothing may be attached to the surface before the first configure has been acknowledged.
+        wl_surface_commit(mpSurface);
+
+        while (!mConfigured)
+        {
+            if (wl_display_dispatch(mpDisplay) < 0)
+            {
+                VFATAL("Lost the connection to the Wayland compositor while creating the window.")
+                return StatusCode::WaylandConnectionFailed;
+            }
+        }
+
+        // The compositor may have picked a size already; otherwise the requested one is used.
+        mWidth = mPendingWidth != 0 ? mPendingWidth : width;
+        mHeight = mPendingHeight != 0 ? mPendingHeight : height;
+        mPendingWidth = mPendingHeight = 0;
+        mInitialized = true;
+
+        return StatusCode::Successful;
+    }
+
+    StatusCode WaylandPlatform::CloseWindow()
+    {
+        CleanUp();
+
+        return StatusCode::Successful;
+    }
+
+    bool WaylandPlatform::PollForEvents()
+    {
+        ReadEvents(0);
+
+        if (wl_display_get_error(mpDisplay) != 0)
+        {
+            VFATAL("Lost the connection to the Wayland compositor.")
+            mQuit = true;
+        }
+
+        if (mQuit)
+            return false;
+
+        // Configures are only acted upon once per poll, after all of them have been received.
+        if (mPendingWidth != 0 && mPendingHeight != 0 && (mPendingWidth != mWidth || mPendingHeight != mHeight))
+        {
+            mWidth = mPendingWidth;
+            mHeight = mPendingHeight;
+
+            WindowResizeEvent rEvent(mWidth, mHeight);
+            EventSystemManager::Dispatch(&rEvent, SenderType::Platform);
+        }
+
+        if (mPendingSuspended != mSuspended)
+        {
+            mSuspended = mPendingSuspended;
+
+            AppSuspendEvent sEvent(mSuspended);
+            EventSystemManager::Dispatch(&sEvent, SenderType::Platform);
+        }
+
+        RequestPresentationFeedback();
+
+        return true;
+    }
+
+    void WaylandPlatform::WaitForEvents(i32 timeoutMs)
+    {
+        ReadEvents(timeoutMs < 0 ? -1 : timeoutMs);
+    }
+
+    void WaylandPlatform::ReadEvents(i32 timeoutMs)
+    {
+        // Events which are already queued have to be dispatched before the display may be read.
+        while (wl_display_prepare_read(mpDisplay) != 0)
+        {
+            wl_display_dispatch_pending(mpDisplay);
+        }
+
+        wl_display_flush(mpDisplay);
+
+        pollfd fd{};
+        fd.fd = wl_display_get_fd(mpDisplay);
+        fd.events = POLLIN;
+
+        if (poll(&fd, 1, timeoutMs) > 0)
+        {
+            wl_display_read_events(mpDisplay);
+        }
+        else
+        {
+            wl_display_cancel_read(mpDisplay);
+        }
+
+        wl_display_dispatch_pending(mpDisplay);
+    }
+
+    void WaylandPlatform::RequestPresentationFeedback()
+    {
+        if (mpPresentation == nullptr || mpFeedback != nullptr)
+            return;
+
+        static const wp_presentation_feedback_listener feedbackListener{OnFeedbackSyncOutput, OnFeedbackPresented, OnFeedbackDiscarded};
+
+        // The request applies to the next commit of the surface, which the Vulkan WSI makes when presenting.
+        mpFeedback = wp_presentation_feedback(mpPresentation, mpSurface);
+        wp_presentation_feedback_add_listener(mpFeedback, &feedbackListener, this);
+    }
+
+    void WaylandPlatform::AddRequiredVulkanExtensions(std::vector<const char *> &extensions)
+    {
+        extensions.emplace_back(VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME);
+    }
+
+    StatusCode WaylandPlatform::CreateVulkanSurface(VkInstance *instance, VkAllocationCallbacks *allocator, VkSurfaceKHR *surface)
+    {
+        VkWaylandSurfaceCreateInfoKHR createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_WAYLAND_SURFACE_CREATE_INFO_KHR;	// Vulkan Wayland Surface creation structure.
+        createInfo.display = mpDisplay;											// Connection to the compositor.
+        createInfo.surface = mpSurface;											// The surface of the window.
+
+        VkResult result = vkCreateWaylandSurfaceKHR(*instance, &createInfo, allocator, surface);
+        if (result != VK_SUCCESS)
+        {
+            return StatusCode::VulkanFailedToCreateWaylandSurface;
+        }
+
+        return StatusCode::Successful;
+    }
+
+    f64 WaylandPlatform::GetAbsoluteTime()
+    {
+        struct timespec now
+        {
+        };
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return now.tv_sec + now.tv_nsec * 0.000000001;
+    }
+
+    bool WaylandPlatform::GetPresentationTiming(PresentationTiming *timing)
+    {
+        if (mpPresentation == nullptr || mTiming.presentedFrames == 0)
+            return false;
+
+        *timing = mTiming;
+        return true;
+    }
+
+    void WaylandPlatform::SleepForDuration(u64 ms)
+    {
+        struct timespec ts;
+        ts.tv_sec = ms / 1000;
+        ts.tv_nsec = (ms % 1000) * 1000 * 1000;
+        nanosleep(&ts, nullptr);
+    }
+
+    void WaylandPlatform::OnRegistryGlobal(void *data, wl_registry *registry, u32 name, const char *interface, u32 version)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+        {
+            platform->mpCompositor = (wl_compositor *)wl_registry_bind(registry, name, &wl_compositor_interface, std::min(version, 4u));
+        }
+        else if (strcmp(interface, xdg_wm_base_interface.name) == 0)
+        {
+            platform->mpWmBase = (xdg_wm_base *)wl_registry_bind(registry, name, &xdg_wm_base_interface, std::min(version, XDG_WM_BASE_VERSION));
+        }
+        else if (strcmp(interface, wl_seat_interface.name) == 0 && platform->mpSeat == nullptr)
+        {
+            static const wl_seat_listener seatListener{OnSeatCapabilities, OnSeatName};
+
+            platform->mpSeat = (wl_seat *)wl_registry_bind(registry, name, &wl_seat_interface, std::min(version, 5u));
+            wl_seat_add_listener(platform->mpSeat, &seatListener, platform);
+        }
+        else if (strcmp(interface, wp_presentation_interface.name) == 0)
+        {
+            static const wp_presentation_listener presentationListener{OnPresentationClockId};
+
+            platform->mpPresentation = (wp_presentation *)wl_registry_bind(registry, name, &wp_presentation_interface, 1);
+            wp_presentation_add_listener(platform->mpPresentation, &presentationListener, platform);
+        }
+    }
+
+    void WaylandPlatform::OnRegistryGlobalRemove(void *data, wl_registry *registry, u32 name)
+    {
+    }
+
+    void WaylandPlatform::OnWmBasePing(void *data, xdg_wm_base *wmBase, u32 serial)
+    {
+        // Compositors consider clients which don't answer unresponsive.
+        xdg_wm_base_pong(wmBase, serial);
+    }
+
+    void WaylandPlatform::OnXdgSurfaceConfigure(void *data, xdg_surface *surface, u32 serial)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        xdg_surface_ack_configure(surface, serial);
+        platform->mConfigured = true;
+    }
+
+    void WaylandPlatform::OnToplevelConfigure(void *data, xdg_toplevel *toplevel, i32 width, i32 height, wl_array *states)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        // A size of 0 leaves the choice to the client, keep the current one.
+        if (width > 0 && height > 0)
+        {
+            platform->mPendingWidth = (u16)width;
+            platform->mPendingHeight = (u16)height;
+        }
+
+#if defined(XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION)
+        bool suspended = false;
+        auto *state = (u32 *)states->data;
+
+        for (size_t i = 0; i < states->size / sizeof(u32); ++i)
+        {
+            if (state[i] == XDG_TOPLEVEL_STATE_SUSPENDED)
+                suspended = true;
+        }
+
+        platform->mPendingSuspended = suspended;
+#endif
+    }
+
+    void WaylandPlatform::OnToplevelClose(void *data, xdg_toplevel *toplevel)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        WindowCloseEvent event{};
+        EventSystemManager::Dispatch(&event, SenderType::Platform);
+        platform->mQuit = true;
+    }
+
+    void WaylandPlatform::OnSeatCapabilities(void *data, wl_seat *seat, u32 capabilities)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        static const wl_keyboard_listener keyboardListener{
+            OnKeyboardKeymap, OnKeyboardEnter, OnKeyboardLeave, OnKeyboardKey, OnKeyboardModifiers, OnKeyboardRepeatInfo};
+
+        static const wl_pointer_listener pointerListener{
+            OnPointerEnter, OnPointerLeave, OnPointerMotion, OnPointerButton, OnPointerAxis,
+            [](void *, wl_pointer *) {},                         // frame
+            [](void *, wl_pointer *, u32) {},                    // axis_source
+            [](void *, wl_pointer *, u32, u32) {},               // axis_stop
+            [](void *, wl_pointer *, u32, i32) {},               // axis_discrete
+        };
+
+        const bool hasKeyboard = capabilities & WL_SEAT_CAPABILITY_KEYBOARD;
+        const bool hasPointer = capabilities & WL_SEAT_CAPABILITY_POINTER;
+
+        if (hasKeyboard && platform->mpKeyboard == nullptr)
+        {
+            platform->mpKeyboard = wl_seat_get_keyboard(seat);
+            wl_keyboard_add_listener(platform->mpKeyboard, &keyboardListener, platform);
+        }
+        else if (!hasKeyboard && platform->mpKeyboard != nullptr)
+        {
+            wl_keyboard_destroy(platform->mpKeyboard);
+            platform->mpKeyboard = nullptr;
+        }
+
+        if (hasPointer && platform->mpPointer == nullptr)
+        {
+            platform->mpPointer = wl_seat_get_pointer(seat);
+            wl_pointer_add_listener(platform->mpPointer, &pointerListener, platform);
+        }
+        else if (!hasPointer && platform->mpPointer != nullptr)
+        {
+            wl_pointer_destroy(platform->mpPointer);
+            platform->mpPointer = nullptr;
+        }
+    }
+
+    void WaylandPlatform::OnSeatName(void *data, wl_seat *seat, const char *name)
+    {
+    }
+
+    void WaylandPlatform::OnKeyboardKeymap(void *data, wl_keyboard *keyboard, u32 format, i32 fd, u32 size)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        if (format != WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1)
+        {
+            close(fd);
+            return;
+        }
+
+        char *keymapString = (char *)mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (keymapString == MAP_FAILED)
+        {
+            VERROR("Failed to map the keyboard keymap.")
+            return;
+        }
+
+        xkb_keymap *keymap = xkb_keymap_new_from_string(platform->mpXkbContext, keymapString, XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS);
+        munmap(keymapString, size);
+
+        if (keymap == nullptr)
+        {
+            VERROR("Failed to compile the keyboard keymap.")
+            return;
+        }
+
+        xkb_keymap_unref(platform->mpXkbKeymap);
+        platform->mpXkbKeymap = keymap;
+    }
+
+    void WaylandPlatform::OnKeyboardEnter(void *data, wl_keyboard *keyboard, u32 serial, wl_surface *surface, wl_array *keys)
+    {
+    }
+
+    void WaylandPlatform::OnKeyboardLeave(void *data, wl_keyboard *keyboard, u32 serial, wl_surface *surface)
+    {
+        // Releases which happen while unfocused never arrive, so don't keep anything held down.
+        InputSystem::Reset();
+    }
+
+    void WaylandPlatform::OnKeyboardKey(void *data, wl_keyboard *keyboard, u32 serial, u32 time, u32 key, u32 state)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        if (platform->mpXkbKeymap == nullptr)
+            return;
+
+        // Keys are evdev codes, which XKB offsets by 8. Use the unshifted level, same as the XCB backend.
+        const xkb_keysym_t *keysyms = nullptr;
+        Key translated = Key::Unknown;
+
+        if (xkb_keymap_key_get_syms_by_level(platform->mpXkbKeymap, key + 8, 0, 0, &keysyms) > 0)
+        {
+            translated = LinuxPlatform::TranslateKeycode(keysyms[0]);
+        }
+
+        const bool pressed = state == WL_KEYBOARD_KEY_STATE_PRESSED;
+        InputSystem::ProcessKey(translated, pressed);
+
+        KeyEvent kEvent(translated, pressed);
+        EventSystemManager::Dispatch(&kEvent, SenderType::Platform);
+    }
+
+    void WaylandPlatform::OnKeyboardModifiers(void *data, wl_keyboard *keyboard, u32 serial, u32 depressed, u32 latched, u32 locked, u32 group)
+    {
+    }
+
+    void WaylandPlatform::OnKeyboardRepeatInfo(void *data, wl_keyboard *keyboard, i32 rate, i32 delay)
+    {
+        // Key repeat is a client side feature on Wayland, and the engine doesn't want repeats.
+    }
+
+    void WaylandPlatform::OnPointerEnter(void *data, wl_pointer *pointer, u32 serial, wl_surface *surface, wl_fixed_t x, wl_fixed_t y)
+    {
+        OnPointerMotion(data, pointer, 0, x, y);
+    }
+
+    void WaylandPlatform::OnPointerLeave(void *data, wl_pointer *pointer, u32 serial, wl_surface *surface)
+    {
+    }
+
+    void WaylandPlatform::OnPointerMotion(void *data, wl_pointer *pointer, u32 time, wl_fixed_t x, wl_fixed_t y)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        platform->mPointerX = wl_fixed_to_int(x);
+        platform->mPointerY = wl_fixed_to_int(y);
+        InputSystem::ProcessMouseMove(platform->mPointerX, platform->mPointerY);
+    }
+
+    void WaylandPlatform::OnPointerButton(void *data, wl_pointer *pointer, u32 serial, u32 time, u32 button, u32 state)
+    {
+        auto *platform = (WaylandPlatform *)data;
+        MouseButton mouseButton = MouseButton::Unknown;
+
+        switch (button)
+        {
+        case BTN_LEFT:
+            mouseButton = MouseButton::Left;
+            break;
+        case BTN_MIDDLE:
+            mouseButton = MouseButton::ScrollWheel;
+            break;
+        case BTN_RIGHT:
+            mouseButton = MouseButton::Right;
+            break;
+        }
+
+        const bool pressed = state == WL_POINTER_BUTTON_STATE_PRESSED;
+        InputSystem::ProcessMouseButton(mouseButton, pressed);
+
+        MouseButtonEvent mEvent(mouseButton, pressed, platform->mPointerX, platform->mPointerY);
+        EventSystemManager::Dispatch(&mEvent, SenderType::Platform);
+    }
+
+    void WaylandPlatform::OnPointerAxis(void *data, wl_pointer *pointer, u32 time, u32 axis, wl_fixed_t value)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        if (axis != WL_POINTER_AXIS_VERTICAL_SCROLL || value == 0)
+            return;
+
+        // Positive values scroll down.
+        const bool up = value < 0;
+        InputSystem::ProcessMouseWheel(up ? 1 : -1);
+
+        MouseScrolledEvent mEvent(up, platform->mPointerX, platform->mPointerY);
+        EventSystemManager::Dispatch(&mEvent, SenderType::Platform);
+    }
+
+    void WaylandPlatform::OnPresentationClockId(void *data, wp_presentation *presentation, u32 clockId)
+    {
+        auto *platform = (WaylandPlatform *)data;
+        platform->mPresentationClock = (clockid_t)clockId;
+    }
+
+    void WaylandPlatform::OnFeedbackSyncOutput(void *data, struct wp_presentation_feedback *feedback, wl_output *output)
+    {
+    }
+
+    void WaylandPlatform::OnFeedbackPresented(void *data, struct wp_presentation_feedback *feedback, u32 secondsHi, u32 secondsLo,
+                                              u32 nanoseconds, u32 refresh, u32 sequenceHi, u32 sequenceLo, u32 flags)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        f64 presentTime = (f64)(((u64)secondsHi << 32) | secondsLo) + nanoseconds * 0.000000001;
+
+        // Timestamps are in the compositor's presentation clock; move them onto the clock of GetAbsoluteTime.
+        if (platform->mPresentationClock != CLOCK_MONOTONIC)
+        {
+            struct timespec presentationNow{}, monotonicNow{};
+            clock_gettime(platform->mPresentationClock, &presentationNow);
+            clock_gettime(CLOCK_MONOTONIC, &monotonicNow);
+
+            presentTime += (f64)(monotonicNow.tv_sec - presentationNow.tv_sec) +
+                           (monotonicNow.tv_nsec - presentationNow.tv_nsec) * 0.000000001;
+        }
+
+        platform->mTiming.lastPresentTime = presentTime;
+        platform->mTiming.refreshInterval = refresh * 0.000000001;
+        if (platform->mTiming.presentedFrames++ == 0)
+            VINFO("Receiving presentation feedback, refresh interval %.3f ms.", refresh * 0.000001)
+
+        wp_presentation_feedback_destroy(feedback);
+        platform->mpFeedback = nullptr;
+    }
+
+    void WaylandPlatform::OnFeedbackDiscarded(void *data, struct wp_presentation_feedback *feedback)
+    {
+        auto *platform = (WaylandPlatform *)data;
+
+        platform->mTiming.discardedFrames++;
+
+        wp_presentation_feedback_destroy(feedback);
+        platform->mpFeedback = nullptr;
+    }
+
+    void WaylandPlatform::CleanUp()
+    {
+        if (mpDisplay == nullptr)
+            return;
+
+        // Destroy in the opposite order of creation.
+        if (mpFeedback) wp_presentation_feedback_destroy(mpFeedback);
+        if (mpToplevel) xdg_toplevel_destroy(mpToplevel);
+        if (mpXdgSurface) xdg_surface_destroy(mpXdgSurface);
+        if (mpSurface) wl_surface_destroy(mpSurface);
+        if (mpPointer) wl_pointer_destroy(mpPointer);
+        if (mpKeyboard) wl_keyboard_destroy(mpKeyboard);
+        if (mpSeat) wl_seat_destroy(mpSeat);
+        if (mpPresentation) wp_presentation_destroy(mpPresentation);
+        if (mpWmBase) xdg_wm_base_destroy(mpWmBase);
+        if (mpCompositor) wl_compositor_destroy(mpCompositor);
+        if (mpRegistry) wl_registry_destroy(mpRegistry);
+
+        xkb_keymap_unref(mpXkbKeymap);
+        xkb_context_unref(mpXkbContext);
+
+        wl_display_disconnect(mpDisplay);
+
+        mpFeedback = nullptr;
+        mpToplevel = nullptr;
+        mpXdgSurface = nullptr;
+        mpSurface = nullptr;
+        mpPointer = nullptr;
+        mpKeyboard = nullptr;
+        mpSeat = nullptr;
+        mpPresentation = nullptr;
+        mpWmBase = nullptr;
+        mpCompositor = nullptr;
+        mpRegistry = nullptr;
+        mpXkbKeymap = nullptr;
+        mpXkbContext = nullptr;
+        mpDisplay = nullptr;
+
+        mInitialized = false;
+    }
+}
+
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+#include "Platform.h"
+
+#if defined(VPLATFORM_LINUX) && defined(VKR_WAYLAND)
+#include "Core/Input/Key.h"
+#include <wayland-client.h>
+#include <xkbcommon/xkbcommon.h>
+#include "xdg-shell-client-protocol.h"
+#include "presentation-time-client-protocol.h"
+
+namespace Vkr
+{
+    // Native Wayland backend. Selected over XCB when a Wayland compositor is available, which avoids the
+    // XWayland round trips and provides presentation feedback through `wp_presentation`.
+    class WaylandPlatform final : public Platform
+    {
+    private:
+        bool mInitialized = false;
+        bool mQuit = false;
+        bool mConfigured = false;                    // Whether the first xdg_surface.configure has been acknowledged.
+
+        wl_display *mpDisplay{};
+        wl_registry *mpRegistry{};
+        wl_compositor *mpCompositor{};
+        wl_surface *mpSurface{};
+        wl_seat *mpSeat{};
+        wl_keyboard *mpKeyboard{};
+        wl_pointer *mpPointer{};
+        xdg_wm_base *mpWmBase{};
+        xdg_surface *mpXdgSurface{};
+        xdg_toplevel *mpToplevel{};
+        wp_presentation *mpPresentation{};
+        struct wp_presentation_feedback *mpFeedback{}; // Outstanding feedback request for the next commit, if any.
+
+        xkb_context *mpXkbContext{};
+        xkb_keymap *mpXkbKeymap{};
+
+        u16 mWidth{};
+        u16 mHeight{};
+        u16 mPendingWidth{};                         // Size suggested by the last toplevel configure, 0 if none.
+        u16 mPendingHeight{};
+        bool mSuspended = false;
+        bool mPendingSuspended = false;
+        i32 mPointerX{};
+        i32 mPointerY{};
+
+        clockid_t mPresentationClock = CLOCK_MONOTONIC;
+        PresentationTiming mTiming{};
+
+        // Listeners. Wayland invokes these with the platform as user data.
+        static void OnRegistryGlobal(void *data, wl_registry *registry, u32 name, const char *interface, u32 version);
+        static void OnRegistryGlobalRemove(void *data, wl_registry *registry, u32 name);
+        static void OnWmBasePing(void *data, xdg_wm_base *wmBase, u32 serial);
+        static void OnXdgSurfaceConfigure(void *data, xdg_surface *surface, u32 serial);
+        static void OnToplevelConfigure(void *data, xdg_toplevel *toplevel, i32 width, i32 height, wl_array *states);
+        static void OnToplevelClose(void *data, xdg_toplevel *toplevel);
+        static void OnSeatCapabilities(void *data, wl_seat *seat, u32 capabilities);
+        static void OnSeatName(void *data, wl_seat *seat, const char *name);
+        static void OnKeyboardKeymap(void *data, wl_keyboard *keyboard, u32 format, i32 fd, u32 size);
+        static void OnKeyboardEnter(void *data, wl_keyboard *keyboard, u32 serial, wl_surface *surface, wl_array *keys);
+        static void OnKeyboardLeave(void *data, wl_keyboard *keyboard, u32 serial, wl_surface *surface);
+        static void OnKeyboardKey(void *data, wl_keyboard *keyboard, u32 serial, u32 time, u32 key, u32 state);
+        static void OnKeyboardModifiers(void *data, wl_keyboard *keyboard, u32 serial, u32 depressed, u32 latched, u32 locked, u32 group);
+        static void OnKeyboardRepeatInfo(void *data, wl_keyboard *keyboard, i32 rate, i32 delay);
+        static void OnPointerEnter(void *data, wl_pointer *pointer, u32 serial, wl_surface *surface, wl_fixed_t x, wl_fixed_t y);
+        static void OnPointerLeave(void *data, wl_pointer *pointer, u32 serial, wl_surface *surface);
+        static void OnPointerMotion(void *data, wl_pointer *pointer, u32 time, wl_fixed_t x, wl_fixed_t y);
+        static void OnPointerButton(void *data, wl_pointer *pointer, u32 serial, u32 time, u32 button, u32 state);
+        static void OnPointerAxis(void *data, wl_pointer *pointer, u32 time, u32 axis, wl_fixed_t value);
+        static void OnPresentationClockId(void *data, wp_presentation *presentation, u32 clockId);
+        static void OnFeedbackSyncOutput(void *data, struct wp_presentation_feedback *feedback, wl_output *output);
+        static void OnFeedbackPresented(void *data, struct wp_presentation_feedback *feedback, u32 secondsHi, u32 secondsLo,
+                                        u32 nanoseconds, u32 refresh, u32 sequenceHi, u32 sequenceLo, u32 flags);
+        static void OnFeedbackDiscarded(void *data, struct wp_presentation_feedback *feedback);
+
+        // Reads pending events from the display without blocking longer than the timeout.
+        void ReadEvents(i32 timeoutMs);
+
+        // Asks for presentation feedback of the next commit, which is the next vkQueuePresentKHR.
+        void RequestPresentationFeedback();
+
+        void CleanUp();
+
+    public:
+        WaylandPlatform() = default;
+        ~WaylandPlatform() override;
+
+        WaylandPlatform(const WaylandPlatform &) = delete;
+        void operator=(WaylandPlatform const &) = delete;
+
+        StatusCode CreateNewWindow(const char *windowName, i16 x, i16 y, u16 width, u16 height) override;
+        StatusCode CloseWindow() override;
+        bool PollForEvents() override;
+        void WaitForEvents(i32 timeoutMs) override;
+        f64 GetAbsoluteTime() override;
+        bool GetPresentationTiming(PresentationTiming *timing) override;
+        void SleepForDuration(u64 duration) override;
+        void AddRequiredVulkanExtensions(std::vector<const char *> &extensions) override;
+        StatusCode CreateVulkanSurface(VkInstance *instance, VkAllocationCallbacks *allocator, VkSurfaceKHR *surface) override;
+    };
+}
+
+#endif
@@ -2,7 +2,7 @@
 
 namespace Vkr
 {
-    StatusCode DirectXRenderer::Initialize(const char *appName)
+    StatusCode DirectXRenderer::Initialize(const RendererConfig &config)
     {
         return StatusCode::Successful;
     }
@@ -25,4 +25,9 @@ namespace Vkr
     {
         return StatusCode::Successful;
     }
+
+    bool DirectXRenderer::PaceFrame()
+    {
+        return false;
+    }
 }
\ No newline at end of file
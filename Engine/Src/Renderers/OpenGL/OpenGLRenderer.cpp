@@ -2,7 +2,7 @@
 
 namespace Vkr
 {
-    StatusCode OpenGLRenderer::Initialize(const char *appName)
+    StatusCode OpenGLRenderer::Initialize(const RendererConfig &config)
     {
         return StatusCode::Successful;
     }
@@ -25,4 +25,9 @@ namespace Vkr
     {
         return StatusCode::Successful;
     }
+
+    bool OpenGLRenderer::PaceFrame()
+    {
+        return false;
+    }
 }
\ No newline at end of file
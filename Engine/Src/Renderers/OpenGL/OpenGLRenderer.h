@@ -9,10 +9,11 @@ namespace Vkr
         CONSTRUCTOR_LOG(OpenGLRenderer)
         DESTRUCTOR_LOG(OpenGLRenderer)
 
-        StatusCode Initialize(const char *appName) override;
+        StatusCode Initialize(const RendererConfig &config) override;
         StatusCode Shutdown() override;
         void OnResize(u16 width, u16 height) override;
         StatusCode BeginFrame(f32 deltaTime) override;
         StatusCode EndFrame(f32 deltaTime) override;
+        bool PaceFrame() override;
     };
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "Defines.h"
+#include "RendererConfig.h"
 
 namespace Vkr
 {
@@ -9,10 +10,11 @@ namespace Vkr
     public:
         virtual ~Renderer() = default;
 
-        virtual StatusCode Initialize(const char *appName) = 0; // Initializes the renderer.
-        virtual StatusCode Shutdown() = 0;                      // Shuts the renderer down.
-        virtual void OnResize(u16 width, u16 height) = 0;       // Callback function to execute on window resize.
-        virtual StatusCode BeginFrame(f32 deltaTime) = 0;       // Callback function to execute when a frame begins.
-        virtual StatusCode EndFrame(f32 deltaTime) = 0;         // Callback function to execute when a frame ends.
+        virtual StatusCode Initialize(const RendererConfig &config) = 0; // Initializes the renderer.
+        virtual StatusCode Shutdown() = 0;                               // Shuts the renderer down.
+        virtual void OnResize(u16 width, u16 height) = 0;                // Callback function to execute on window resize.
+        virtual StatusCode BeginFrame(f32 deltaTime) = 0;                // Callback function to execute when a frame begins.
+        virtual StatusCode EndFrame(f32 deltaTime) = 0;                  // Callback function to execute when a frame ends.
+        virtual bool PaceFrame() = 0;                                    // Blocks until the next frame should start; false if it doesn't pace frames.
     };
 }
\ No newline at end of file
@@ -5,7 +5,7 @@
 
 namespace Vkr
 {
-    StatusCode RendererClient::Initialize(const std::shared_ptr<Platform> &platform, RendererType rendererType, const char *appName)
+    StatusCode RendererClient::Initialize(const std::shared_ptr<Platform> &platform, RendererType rendererType, const RendererConfig &config)
     {
         switch (rendererType)
         {
@@ -23,7 +23,7 @@ namespace Vkr
             break;
         }
 
-        return renderer->Initialize(appName);
+        return renderer->Initialize(config);
     }
 
     StatusCode RendererClient::Terminate()
@@ -31,22 +31,31 @@ namespace Vkr
         return renderer->Shutdown();
     }
 
-    void RendererClient::OnResize()
+    void RendererClient::OnResize(u16 width, u16 height)
     {
+        renderer->OnResize(width, height);
     }
 
     StatusCode RendererClient::DrawFrame(RendererPacket *packet)
     {
-        return StatusCode::Successful;
+        StatusCode statusCode = BeginFrame(packet->deltaTime);
+        RETURN_ON_FAIL(statusCode)
+
+        return EndFrame(packet->deltaTime);
+    }
+
+    bool RendererClient::PaceFrame()
+    {
+        return renderer->PaceFrame();
     }
 
     StatusCode RendererClient::BeginFrame(float deltaTime)
     {
-        return StatusCode::Successful;
+        return renderer->BeginFrame(deltaTime);
     }
 
     StatusCode RendererClient::EndFrame(float deltaTime)
     {
-        return StatusCode::Successful;
+        return renderer->EndFrame(deltaTime);
     }
 }
\ No newline at end of file
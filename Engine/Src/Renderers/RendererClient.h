@@ -18,14 +18,17 @@ namespace Vkr
         CONSTRUCTOR_LOG(RendererClient)
         DESTRUCTOR_LOG(RendererClient)
 
-        StatusCode Initialize(const std::shared_ptr<Platform> &platform, RendererType rendererType, const char *appName = "Vulkyrie Engine");
+        StatusCode Initialize(const std::shared_ptr<Platform> &platform, RendererType rendererType, const RendererConfig &config);
 
         StatusCode Terminate();
 
-        void OnResize();
+        void OnResize(u16 width, u16 height);
 
         StatusCode DrawFrame(RendererPacket *packet);
 
+        // Blocks until the next frame should start. Returns false if the renderer doesn't pace frames itself.
+        bool PaceFrame();
+
     private:
         std::unique_ptr<Renderer> renderer;
 
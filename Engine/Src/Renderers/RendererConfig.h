@@ -0,0 +1,33 @@
+#pragma once
+#include "Defines.h"
+#include "Renderers/LatencyProfile.h"
+
+namespace Vkr
+{
+    // Settings the renderer is initialized with.
+    struct RendererConfig
+    {
+        const char *appName = "Vulkyrie Engine"; // Name of the application.
+        u16 width{};                             // Initial width of the frame-buffer.
+        u16 height{};                            // Initial height of the frame-buffer.
+        u8 framesInFlight = 0;                   // Number of frames the CPU may record ahead of the GPU, 0 for the latency profile's.
+        LatencyProfile latencyProfile = LatencyProfile::Balanced; // Picks the present mode, swapchain images and frame pacing.
+        u64 hostMemoryLimit{};                   // Cap on the graphics driver's host memory in bytes, 0 for none.
+        const char *pipelineCachePath = "PipelineCache.bin"; // File compiled pipelines are kept in between runs.
+        const char *assetRoot = "Assets";        // Directory asset paths (shaders, etc.) are relative to.
+        u64 uploadRingSize = 64ull << 20;        // Staging memory for uploads; also the largest image that can be uploaded.
+        u64 uploadFrameBudget = 16ull << 20;     // Bytes staged for upload per frame; the rest waits for later frames.
+        u32 bindlessImages = 16384;              // Sampled image slots in the global descriptor set.
+        u32 bindlessBuffers = 4096;              // Storage buffer slots in the global descriptor set.
+        u32 bindlessSamplers = 64;               // Sampler slots in the global descriptor set.
+        u32 bindlessStorageImages = 64;          // Storage image slots in the global descriptor set.
+        const char *shaderPack = "Shaders/Shaders.pack"; // Offline built shader permutations, relative to the asset root.
+        const char *shaderCacheDirectory = "ShaderCache"; // Directory compiled GLSL shaders are cached in.
+        bool shaderHotReload = true;             // Whether edited shaders are reloaded while running.
+        bool gpuProfiling = true;                // Whether frames and passes are timed on the GPU and the timings logged.
+        bool gpuCulling = true;                  // Whether scene objects are frustum and occlusion culled on the GPU.
+        bool preferDiscreteGpu = true;           // Whether discrete GPUs rank above integrated ones, or the other way round.
+        bool allowCpuDevice = true;              // Whether a CPU implementation (e.g. lavapipe) may be selected when no GPU qualifies.
+        bool offscreen = false;                  // Whether to render into engine-owned images and read them back, instead of presenting.
+    };
+}
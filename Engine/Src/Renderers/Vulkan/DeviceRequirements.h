@@ -12,5 +12,9 @@ namespace Vkr
         std::vector<const char *> deviceExtensionNames;
         bool samplerAnisotropy;
         bool discreteGpu;
+        bool cpuDevice;             // Whether CPU implementations are acceptable.
+        bool descriptorIndexing;    // Update-after-bind, partially bound, non-uniformly indexed descriptor arrays.
+        bool drawIndirectCount;     // Multi draw indirect, with the draw count read from a buffer.
+        u32 apiVersion;             // Lowest Vulkan version the device has to support.
     };
 }
\ No newline at end of file
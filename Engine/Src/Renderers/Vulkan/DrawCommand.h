@@ -0,0 +1,25 @@
+#pragma once
+#include "Defines.h"
+#include "VulkanBindlessHeap.h"
+#include "VulkanPipelineManager.h"
+
+namespace Vkr
+{
+    // Push constants of a draw, laid out as the DrawConstants block of the shaders.
+    struct DrawConstants
+    {
+        BindlessIndex materialBuffer = BINDLESS_INVALID_INDEX;  // Storage buffer holding the material, none by default.
+        u32 materialIndex{};                                    // Material within that buffer.
+    };
+
+    // A non-indexed draw queued for the current frame.
+    struct DrawCommand
+    {
+        PipelineHandle pipeline;
+        u32 vertexCount{};
+        u32 instanceCount = 1;
+        u32 firstVertex{};
+        u32 firstInstance{};
+        DrawConstants constants;
+    };
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Defines.h"
+
+namespace Vkr
+{
+    struct ShaderStageInfo
+    {
+        VkShaderStageFlagBits stage;
+        VkShaderModule module;          // From the shader registry, which keeps it alive while the pipeline compiles.
+        u64 hash;                       // Content hash of the module, identifying the shader in the pipeline state.
+        std::string entryPoint = "main";
+    };
+
+    // Everything that goes into a graphics pipeline. Two infos that compare equal produce the same pipeline.
+    // Viewport and scissor are always dynamic, and pipelines are built for dynamic rendering against attachment formats
+    // rather than a render pass, so they survive swapchain resizes and need no framebuffers.
+    struct GraphicsPipelineInfo
+    {
+        std::vector<ShaderStageInfo> stages;
+        std::vector<VkVertexInputBindingDescription> vertexBindings;
+        std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+
+        VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+        VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+        VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+        bool depthTest = false;
+        bool depthWrite = false;
+        VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+
+        // Blending uses equation: (srcColorBlendFactor * new color) colorBlendOp (dstColorBlendFactor * old color)
+        bool blendEnable = false;
+        VkBlendFactor srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        VkBlendFactor dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        VkBlendOp colorBlendOp = VK_BLEND_OP_ADD;
+        VkBlendFactor srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        VkBlendFactor dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        VkBlendOp alphaBlendOp = VK_BLEND_OP_ADD;
+
+        VkPipelineLayout layout{};
+        std::vector<VkFormat> colorFormats;                 // One per color attachment, each blended as above.
+        VkFormat depthFormat = VK_FORMAT_UNDEFINED;         // VK_FORMAT_UNDEFINED without a depth attachment.
+        VkFormat stencilFormat = VK_FORMAT_UNDEFINED;       // VK_FORMAT_UNDEFINED without a stencil attachment.
+    };
+}
@@ -6,11 +6,16 @@ namespace Vkr {
 		VkImageType imageType;
 		u32 width;
 		u32 height;
+		u32 mipLevels = 1;
+		u32 arrayLayers = 1;
+		VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
 		VkFormat format;
 		VkImageTiling tiling;
 		VkImageUsageFlags usage;
+		// VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, for transient attachments, falls back to the other flags on devices
+		// without lazily allocated memory.
 		VkMemoryPropertyFlags memoryFlags;
 		bool createView;
 		VkImageAspectFlags viewAspectFlags;
 	};
-}
\ No newline at end of file
+}
@@ -4,6 +4,8 @@ namespace Vkr {
 	struct PhysicalDeviceInfo {
 		const VkPhysicalDeviceProperties *properties;
 		const VkPhysicalDeviceFeatures *features;
+		const VkPhysicalDeviceVulkan12Features *features12;
+		const VkPhysicalDeviceMemoryProperties *memory;
 		const DeviceRequirements *requirements;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Layout of a shader pack: every shader permutation of a build, compiled to optimized SPIR-V and stored in one file
+// the renderer memory-maps. Shared with the offline packer (Tools/ShaderPack), so it depends on the standard library only.
+//
+//   Header
+//   Entry[entryCount]      Sorted by key, for binary search.
+//   SPIR-V                 Each module at a multiple of `ALIGNMENT`.
+namespace Vkr::ShaderPackFormat
+{
+    constexpr uint32_t MAGIC = 0x4B505356;      // "VSPK"
+    constexpr uint32_t VERSION = 1;
+    constexpr uint64_t ALIGNMENT = 16;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t reserved;
+    };
+
+    struct Entry
+    {
+        uint64_t key;               // `PermutationKey` of the shader path and defines.
+        uint64_t contentHash;       // `Hash` of the SPIR-V, as the shader registry computes it for loose files.
+        uint64_t offset;            // From the start of the file.
+        uint64_t size;              // In bytes.
+    };
+
+    static_assert(sizeof(Header) == 16 && sizeof(Entry) == 32, "Shader pack structures must not contain padding.");
+
+    // 64-bit FNV-1a, identical to `HashBytes`.
+    inline uint64_t Hash(const void *data, size_t size, uint64_t seed = 0xCBF29CE484222325ull)
+    {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        uint64_t hash = seed;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+
+        return hash;
+    }
+
+    /**
+     * Identifies a permutation. The order the defines are given in doesn't matter.
+     * @param path Path of the GLSL source, relative to the asset root (e.g. "Shaders/test.vert").
+     * @param defines Preprocessor definitions, each either "NAME" or "NAME=VALUE".
+     */
+    inline uint64_t PermutationKey(const std::string &path, std::vector<std::string> defines)
+    {
+        std::sort(defines.begin(), defines.end());
+
+        uint64_t key = Hash(path.data(), path.size() + 1);
+        for (const auto &define : defines)
+        {
+            key = Hash(define.data(), define.size() + 1, key);
+        }
+
+        return key;
+    }
+}
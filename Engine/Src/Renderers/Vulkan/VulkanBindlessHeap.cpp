@@ -0,0 +1,254 @@
+#include "VulkanBindlessHeap.h"
+
+namespace Vkr
+{
+	BindlessIndex VulkanBindlessHeap::SlotAllocator::Allocate()
+	{
+		if (!freed.empty())
+		{
+			BindlessIndex index = freed.back();
+			freed.pop_back();
+			return index;
+		}
+
+		return next < capacity ? next++ : BINDLESS_INVALID_INDEX;
+	}
+
+	void VulkanBindlessHeap::SlotAllocator::Release(BindlessIndex index)
+	{
+		if (index != BINDLESS_INVALID_INDEX)
+			freed.push_back(index);
+	}
+
+	StatusCode VulkanBindlessHeap::Initialize(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks *allocator,
+											  BindlessLimits limits)
+	{
+		mDevice = device;
+		mAllocator = allocator;
+
+		// Update-after-bind descriptors have their own, usually much higher, limits.
+		VkPhysicalDeviceVulkan12Properties properties12{};
+		properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+		VkPhysicalDeviceProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &properties12;
+		vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+		mImages.capacity = VMIN(limits.sampledImages, VMIN(properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+															 properties12.maxPerStageDescriptorUpdateAfterBindSampledImages));
+		mBuffers.capacity = VMIN(limits.storageBuffers, VMIN(properties12.maxDescriptorSetUpdateAfterBindStorageBuffers,
+															   properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers));
+		mSamplers.capacity = VMIN(limits.samplers, VMIN(properties12.maxDescriptorSetUpdateAfterBindSamplers,
+														  properties12.maxPerStageDescriptorUpdateAfterBindSamplers));
+		mStorageImages.capacity = VMIN(limits.storageImages, VMIN(properties12.maxDescriptorSetUpdateAfterBindStorageImages,
+																	properties12.maxPerStageDescriptorUpdateAfterBindStorageImages));
+
+		// Every binding is visible to every stage, so each stage sees all of them, and a fragment shader's color attachments
+		// count against the same total. Samplers don't; shrink the other arrays in proportion until they fit.
+		const u32 maxColorAttachments = properties.properties.limits.maxColorAttachments;
+		const u64 budget = properties12.maxPerStageUpdateAfterBindResources > maxColorAttachments
+							   ? properties12.maxPerStageUpdateAfterBindResources - maxColorAttachments : 0;
+		const u64 resources = (u64)mImages.capacity + mBuffers.capacity + mStorageImages.capacity;
+		if (resources > budget)
+		{
+			VWARN("Bindless arrays hold %llu resources per stage, more than the device's %llu; shrinking them.", resources, budget)
+			mImages.capacity = (u32)(mImages.capacity * budget / resources);
+			mBuffers.capacity = (u32)(mBuffers.capacity * budget / resources);
+			mStorageImages.capacity = (u32)(mStorageImages.capacity * budget / resources);
+		}
+
+		if ((limits.sampledImages && !mImages.capacity) || (limits.storageBuffers && !mBuffers.capacity) ||
+			(limits.samplers && !mSamplers.capacity) || (limits.storageImages && !mStorageImages.capacity))
+		{
+			VFATAL("The device's update-after-bind limits leave no room for some of the bindless arrays.")
+			return StatusCode::VulkanBindlessLimitsTooLow;
+		}
+
+		std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+		bindings[BindlessSampledImages] = {BindlessSampledImages, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, mImages.capacity, VK_SHADER_STAGE_ALL, nullptr};
+		bindings[BindlessStorageBuffers] = {BindlessStorageBuffers, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, mBuffers.capacity, VK_SHADER_STAGE_ALL, nullptr};
+		bindings[BindlessSamplers] = {BindlessSamplers, VK_DESCRIPTOR_TYPE_SAMPLER, mSamplers.capacity, VK_SHADER_STAGE_ALL, nullptr};
+		bindings[BindlessStorageImages] = {BindlessStorageImages, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, mStorageImages.capacity, VK_SHADER_STAGE_ALL, nullptr};
+
+		// Slots are written while the set is bound, and most of them are never written at all.
+		std::array<VkDescriptorBindingFlags, 4> bindingFlags{};
+		bindingFlags.fill(VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT);
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount = bindingFlags.size();
+		bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = &bindingFlagsInfo;
+		layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		layoutInfo.bindingCount = bindings.size();
+		layoutInfo.pBindings = bindings.data();
+		VK_CHECK(vkCreateDescriptorSetLayout(mDevice, &layoutInfo, mAllocator, &mSetLayout))
+
+		std::array<VkDescriptorPoolSize, 4> poolSizes = {{
+			{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, mImages.capacity},
+			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, mBuffers.capacity},
+			{VK_DESCRIPTOR_TYPE_SAMPLER, mSamplers.capacity},
+			{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, mStorageImages.capacity},
+		}};
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		poolInfo.maxSets = 1;
+		poolInfo.poolSizeCount = poolSizes.size();
+		poolInfo.pPoolSizes = poolSizes.data();
+		VK_CHECK(vkCreateDescriptorPool(mDevice, &poolInfo, mAllocator, &mPool))
+
+		VkDescriptorSetAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocateInfo.descriptorPool = mPool;
+		allocateInfo.descriptorSetCount = 1;
+		allocateInfo.pSetLayouts = &mSetLayout;
+		VK_CHECK(vkAllocateDescriptorSets(mDevice, &allocateInfo, &mSet))
+
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = PUSH_CONSTANT_STAGES;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = BINDLESS_PUSH_CONSTANT_SIZE;
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &mSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		VK_CHECK(vkCreatePipelineLayout(mDevice, &pipelineLayoutInfo, mAllocator, &mPipelineLayout))
+
+		VDEBUG("Bindless descriptor set: %u images, %u storage buffers, %u samplers, %u storage images.", mImages.capacity, mBuffers.capacity,
+			   mSamplers.capacity, mStorageImages.capacity)
+		return StatusCode::Successful;
+	}
+
+	void VulkanBindlessHeap::Shutdown()
+	{
+		if (!mDevice)
+			return;
+
+		vkDestroyPipelineLayout(mDevice, mPipelineLayout, mAllocator);
+		vkDestroyDescriptorPool(mDevice, mPool, mAllocator);	// Frees the set.
+		vkDestroyDescriptorSetLayout(mDevice, mSetLayout, mAllocator);
+
+		mPipelineLayout = VK_NULL_HANDLE;
+		mPool = VK_NULL_HANDLE;
+		mSet = VK_NULL_HANDLE;
+		mSetLayout = VK_NULL_HANDLE;
+		mImages = {};
+		mBuffers = {};
+		mSamplers = {};
+		mStorageImages = {};
+		mDevice = VK_NULL_HANDLE;
+	}
+
+	BindlessIndex VulkanBindlessHeap::RegisterImage(VkImageView view, VkImageLayout layout)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		BindlessIndex index = mImages.Allocate();
+		if (index == BINDLESS_INVALID_INDEX)
+		{
+			VERROR("All %u bindless image slots are in use.", mImages.capacity)
+			return index;
+		}
+
+		VkDescriptorImageInfo imageInfo{VK_NULL_HANDLE, view, layout};
+		Write(BindlessSampledImages, index, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, &imageInfo, nullptr);
+		return index;
+	}
+
+	BindlessIndex VulkanBindlessHeap::RegisterBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		BindlessIndex index = mBuffers.Allocate();
+		if (index == BINDLESS_INVALID_INDEX)
+		{
+			VERROR("All %u bindless storage buffer slots are in use.", mBuffers.capacity)
+			return index;
+		}
+
+		VkDescriptorBufferInfo bufferInfo{buffer, offset, range};
+		Write(BindlessStorageBuffers, index, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &bufferInfo);
+		return index;
+	}
+
+	BindlessIndex VulkanBindlessHeap::RegisterSampler(VkSampler sampler)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		BindlessIndex index = mSamplers.Allocate();
+		if (index == BINDLESS_INVALID_INDEX)
+		{
+			VERROR("All %u bindless sampler slots are in use.", mSamplers.capacity)
+			return index;
+		}
+
+		VkDescriptorImageInfo samplerInfo{sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED};
+		Write(BindlessSamplers, index, VK_DESCRIPTOR_TYPE_SAMPLER, &samplerInfo, nullptr);
+		return index;
+	}
+
+	BindlessIndex VulkanBindlessHeap::RegisterStorageImage(VkImageView view)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		BindlessIndex index = mStorageImages.Allocate();
+		if (index == BINDLESS_INVALID_INDEX)
+		{
+			VERROR("All %u bindless storage image slots are in use.", mStorageImages.capacity)
+			return index;
+		}
+
+		VkDescriptorImageInfo imageInfo{VK_NULL_HANDLE, view, VK_IMAGE_LAYOUT_GENERAL};
+		Write(BindlessStorageImages, index, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &imageInfo, nullptr);
+		return index;
+	}
+
+	// Released slots keep their stale descriptors; partially bound sets only require that nothing accesses them.
+	void VulkanBindlessHeap::ReleaseImage(BindlessIndex index)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mImages.Release(index);
+	}
+
+	void VulkanBindlessHeap::ReleaseBuffer(BindlessIndex index)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mBuffers.Release(index);
+	}
+
+	void VulkanBindlessHeap::ReleaseSampler(BindlessIndex index)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSamplers.Release(index);
+	}
+
+	void VulkanBindlessHeap::ReleaseStorageImage(BindlessIndex index)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStorageImages.Release(index);
+	}
+
+	void VulkanBindlessHeap::Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint) const
+	{
+		vkCmdBindDescriptorSets(commandBuffer, bindPoint, mPipelineLayout, 0, 1, &mSet, 0, nullptr);
+	}
+
+	void VulkanBindlessHeap::Write(BindlessBinding binding, BindlessIndex index, VkDescriptorType type, const VkDescriptorImageInfo *imageInfo,
+								   const VkDescriptorBufferInfo *bufferInfo)
+	{
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = mSet;
+		write.dstBinding = binding;
+		write.dstArrayElement = index;
+		write.descriptorCount = 1;
+		write.descriptorType = type;
+		write.pImageInfo = imageInfo;
+		write.pBufferInfo = bufferInfo;
+		vkUpdateDescriptorSets(mDevice, 1, &write, 0, nullptr);
+	}
+}
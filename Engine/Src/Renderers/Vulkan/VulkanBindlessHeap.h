@@ -0,0 +1,149 @@
+#pragma once
+#include "Defines.h"
+#include <mutex>
+
+namespace Vkr
+{
+    // Index of a resource in the global descriptor set.
+    using BindlessIndex = u32;
+
+    constexpr BindlessIndex BINDLESS_INVALID_INDEX = ~0u;
+
+    // Bytes of push constants every pipeline receives; the minimum every device guarantees.
+    constexpr u32 BINDLESS_PUSH_CONSTANT_SIZE = 128;
+
+    // Bindings of the global descriptor set. Shaders declare them as unsized arrays in set 0, see Assets/Shaders.
+    enum BindlessBinding : u32
+    {
+        BindlessSampledImages = 0,      // texture2D
+        BindlessStorageBuffers = 1,     // buffer blocks
+        BindlessSamplers = 2,           // sampler
+        BindlessStorageImages = 3       // image2D
+    };
+
+    struct BindlessLimits
+    {
+        u32 sampledImages;
+        u32 storageBuffers;
+        u32 samplers;
+        u32 storageImages;
+    };
+
+    // The one descriptor set every pipeline uses: large arrays of sampled images, storage buffers, samplers and storage
+    // images.
+    //
+    // Resources are registered once, when they are created, and shaders index the arrays with values passed through push
+    // constants (e.g. a material index into a storage buffer of materials, which names its textures by index). The set is
+    // bound once per command buffer, so the CPU cost of a draw does not grow with the number of materials.
+    //
+    // The set is created update-after-bind and partially bound: slots may be written while command buffers using the set
+    // are pending, as long as those command buffers don't access the slots, and unwritten slots are fine as long as they
+    // aren't accessed.
+    class VulkanBindlessHeap
+    {
+    public:
+        VulkanBindlessHeap() = default;
+        ~VulkanBindlessHeap() = default;
+
+        VulkanBindlessHeap(const VulkanBindlessHeap &) = delete;
+        void operator=(VulkanBindlessHeap const &) = delete;
+
+        /**
+         * Creates the set, its layout and the pipeline layout every pipeline shares.
+         * @param physicalDevice The device, whose update-after-bind limits clamp `limits`, per kind and in total per stage.
+         * @param device The logical device, created with descriptor indexing enabled.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param limits Number of slots of each kind.
+         */
+        StatusCode Initialize(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks *allocator, BindlessLimits limits);
+
+        // Destroys the set and the layouts. Nothing may be using them anymore.
+        void Shutdown();
+
+        /**
+         * Writes an image view into a free slot. Safe to call from any thread.
+         * @param layout Layout the image is in whenever shaders sample it.
+         * @return The slot, or BINDLESS_INVALID_INDEX if every slot is taken.
+         */
+        BindlessIndex RegisterImage(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        /**
+         * Writes a storage buffer range into a free slot. Safe to call from any thread.
+         * @return The slot, or BINDLESS_INVALID_INDEX if every slot is taken.
+         */
+        BindlessIndex RegisterBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+        /**
+         * Writes a sampler into a free slot. Safe to call from any thread.
+         * @return The slot, or BINDLESS_INVALID_INDEX if every slot is taken.
+         */
+        BindlessIndex RegisterSampler(VkSampler sampler);
+
+        /**
+         * Writes an image view for shader stores into a free slot. The image is in VK_IMAGE_LAYOUT_GENERAL while it is
+         * accessed. Safe to call from any thread.
+         * @return The slot, or BINDLESS_INVALID_INDEX if every slot is taken.
+         */
+        BindlessIndex RegisterStorageImage(VkImageView view);
+
+        // Return slots for reuse. Frames in flight may still index them, so retire them through the deletion queue.
+        void ReleaseImage(BindlessIndex index);
+        void ReleaseBuffer(BindlessIndex index);
+        void ReleaseSampler(BindlessIndex index);
+        void ReleaseStorageImage(BindlessIndex index);
+
+        /**
+         * Binds the set for every pipeline later bound to `bindPoint` in the command buffer.
+         * @param commandBuffer The command buffer being recorded.
+         * @param bindPoint Graphics or compute.
+         */
+        void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint) const;
+
+        /**
+         * Updates push constants for the draws or dispatches that follow.
+         * @param constants Plain struct of indices and small values, laid out as the shaders' push_constant block.
+         */
+        template <typename T>
+        inline void PushConstants(VkCommandBuffer commandBuffer, const T &constants) const
+        {
+            static_assert(sizeof(T) <= BINDLESS_PUSH_CONSTANT_SIZE, "Push constants exceed the guaranteed size.");
+            vkCmdPushConstants(commandBuffer, mPipelineLayout, PUSH_CONSTANT_STAGES, 0, sizeof(T), &constants);
+        }
+
+        // Pipeline layout every graphics and compute pipeline is created with.
+        [[nodiscard]] inline VkPipelineLayout GetPipelineLayout() const { return mPipelineLayout; }
+
+        [[nodiscard]] inline VkDescriptorSetLayout GetSetLayout() const { return mSetLayout; }
+
+    private:
+        static constexpr VkShaderStageFlags PUSH_CONSTANT_STAGES = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+
+        // Free slots of one binding. Never released slots are handed out in order, released ones are reused first.
+        struct SlotAllocator
+        {
+            u32 capacity{};
+            u32 next{};
+            std::vector<u32> freed;
+
+            BindlessIndex Allocate();
+            void Release(BindlessIndex index);
+        };
+
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        VkDescriptorSetLayout mSetLayout{};
+        VkDescriptorPool mPool{};
+        VkDescriptorSet mSet{};
+        VkPipelineLayout mPipelineLayout{};
+
+        std::mutex mMutex;                  // Guards the slot allocators and descriptor writes.
+        SlotAllocator mImages;
+        SlotAllocator mBuffers;
+        SlotAllocator mSamplers;
+        SlotAllocator mStorageImages;
+
+        // Writes one descriptor. `mMutex` must be held.
+        void Write(BindlessBinding binding, BindlessIndex index, VkDescriptorType type, const VkDescriptorImageInfo *imageInfo,
+                   const VkDescriptorBufferInfo *bufferInfo);
+    };
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "Defines.h"
+#include "VulkanMemoryAllocator.h"
+
+namespace Vkr
+{
+    struct VulkanBuffer
+    {
+        VkBuffer handle;
+        VulkanAllocation allocation;
+        VkDeviceSize size;
+    };
+}
@@ -0,0 +1,28 @@
+#include "VulkanDeletionQueue.h"
+
+namespace Vkr
+{
+    void VulkanDeletionQueue::Push(u64 frameNumber, std::function<void()> &&deleter)
+    {
+        mEntries.push_back({frameNumber, std::move(deleter)});
+    }
+
+    void VulkanDeletionQueue::Flush(u64 completedFrameNumber)
+    {
+        while (!mEntries.empty() && mEntries.front().frameNumber <= completedFrameNumber)
+        {
+            mEntries.front().deleter();
+            mEntries.pop_front();
+        }
+    }
+
+    void VulkanDeletionQueue::FlushAll()
+    {
+        for (auto &entry : mEntries)
+        {
+            entry.deleter();
+        }
+
+        mEntries.clear();
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "Defines.h"
+#include <deque>
+
+namespace Vkr
+{
+    // Holds on to retired Vulkan objects until the GPU can no longer be using them.
+    // Objects are tagged with the frame they were retired on and destroyed once that frame has completed,
+    // so retiring resources never requires waiting for the whole device to go idle.
+    class VulkanDeletionQueue
+    {
+    public:
+        /**
+         * Queues a deleter to run once the given frame has completed on the GPU.
+         * @param frameNumber The frame on which the resources were retired.
+         * @param deleter Function which destroys the retired resources.
+         */
+        void Push(u64 frameNumber, std::function<void()> &&deleter);
+
+        /**
+         * Runs the deleters of every entry retired on or before the given frame.
+         * @param completedFrameNumber The most recent frame known to have completed on the GPU.
+         */
+        void Flush(u64 completedFrameNumber);
+
+        // Runs every queued deleter. The device must be idle.
+        void FlushAll();
+
+        [[nodiscard]] inline bool IsEmpty() const { return mEntries.empty(); }
+
+    private:
+        struct Entry
+        {
+            u64 frameNumber;
+            std::function<void()> deleter;
+        };
+
+        // Entries in the order they were retired, and thus in increasing frame number.
+        std::deque<Entry> mEntries;
+    };
+}
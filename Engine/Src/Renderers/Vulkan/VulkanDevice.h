@@ -11,15 +11,18 @@ namespace Vkr
         i32 graphicsQueueIndex;
         i32 presentQueueIndex;
         i32 transferQueueIndex;
+        i32 computeQueueIndex;
 
         VkQueue graphicsQueue;
         VkQueue presentQueue;
         VkQueue transferQueue;
+        VkQueue computeQueue;
 
         VkPhysicalDeviceProperties properties;
         VkPhysicalDeviceFeatures features;
         VkPhysicalDeviceMemoryProperties memory;
 
         VkFormat depthFormat;
+        bool presentWait;               // Whether VK_KHR_present_id and VK_KHR_present_wait are enabled.
     };
 }
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+#include "Defines.h"
+
+namespace Vkr
+{
+    // Resources owned by one of the frames in flight. A frame's resources are reused once its fence signals.
+    struct VulkanFrame
+    {
+        VkCommandPool commandPool;        // Pool the frame's command buffer is allocated from; reset every frame.
+        VkCommandBuffer commandBuffer;    // Primary command buffer recorded for the frame.
+        VkSemaphore imageAvailable;       // Signaled when the acquired swapchain image can be rendered to.
+        VkFence inFlight;                 // Signaled when the GPU has finished executing the frame.
+    };
+}
@@ -0,0 +1,75 @@
+#include "VulkanFramePacer.h"
+
+namespace Vkr
+{
+	// Longest wait for a present to be shown; a hidden window may never show it.
+	constexpr u64 PRESENT_WAIT_TIMEOUT_NS = 100'000'000;
+	// Time a late started frame is still expected to finish before its vblank.
+	constexpr f64 LATE_START_MARGIN_SECONDS = 0.002;
+
+	void VulkanFramePacer::Initialize(VkDevice device, Platform *platform, u32 queuedPresents, bool lateStart)
+	{
+		mDevice = device;
+		mpPlatform = platform;
+		mQueuedPresents = VMAX(queuedPresents, 1u);
+		mLateStart = lateStart;
+
+		// An extension command, which the loader doesn't export.
+		if (device)
+			mWaitForPresent = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(device, "vkWaitForPresentKHR");
+	}
+
+	void VulkanFramePacer::Reset(VkSwapchainKHR swapchain)
+	{
+		mSwapchain = swapchain;
+		mPresentId = 0;
+		mShownId = 0;
+	}
+
+	bool VulkanFramePacer::Wait()
+	{
+		if (!mWaitForPresent || !mSwapchain)
+			return false;
+
+		if (mPresentId >= mQueuedPresents)
+		{
+			const u64 id = mPresentId + 1 - mQueuedPresents;
+			VkResult result = mWaitForPresent(mDevice, mSwapchain, id, PRESENT_WAIT_TIMEOUT_NS);
+			const f64 now = mpPlatform->GetAbsoluteTime();
+
+			// On a timeout, or an out of date swapchain about to be recreated, the frame starts right away.
+			if (result == VK_SUCCESS && id > mShownId)
+			{
+				// Presents are shown at vblanks, so consecutive ones are a refresh interval apart, unless frames take
+				// longer; the platform knows better where it can tell.
+				PresentationTiming timing{};
+				if (mpPlatform->GetPresentationTiming(&timing) && timing.refreshInterval > 0)
+					mRefreshInterval = timing.refreshInterval;
+				else if (mShownId != 0 && id == mShownId + 1)
+					mRefreshInterval = mRefreshInterval > 0 ? mRefreshInterval * 0.9 + (now - mShownTime) * 0.1 : now - mShownTime;
+
+				mShownId = id;
+				mShownTime = now;
+
+				// The wait returned at about the vblank showing the previous frame, so the next one is a refresh
+				// interval away, and this frame has to be done by then.
+				const f64 slack = mRefreshInterval - mFrameSeconds - LATE_START_MARGIN_SECONDS;
+				if (mLateStart && mFrameSeconds > 0 && slack >= 0.001)
+					mpPlatform->SleepForDuration((u64)(slack * 1000.0));
+			}
+		}
+
+		mFrameStartTime = mpPlatform->GetAbsoluteTime();
+		return true;
+	}
+
+	void VulkanFramePacer::EndFrame(f64 gpuFrameMs)
+	{
+		if (!mWaitForPresent)
+			return;
+
+		// Rises at once, so a slower frame doesn't make the next one miss its vblank, and decays slowly.
+		const f64 frameSeconds = mpPlatform->GetAbsoluteTime() - mFrameStartTime + gpuFrameMs / 1000.0;
+		mFrameSeconds = frameSeconds > mFrameSeconds ? frameSeconds : mFrameSeconds * 0.95 + frameSeconds * 0.05;
+	}
+}
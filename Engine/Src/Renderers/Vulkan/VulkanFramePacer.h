@@ -0,0 +1,70 @@
+#pragma once
+#include "Defines.h"
+#include "Platform/Platform.h"
+
+namespace Vkr
+{
+    // Paces frames with VK_KHR_present_id and VK_KHR_present_wait. Every present carries an increasing id, and a frame
+    // only starts once the presents before it have been shown, leaving at most a given number queued. That bounds the
+    // latency between reading input and showing its result, which frames in flight alone don't: with FIFO presentation
+    // they queue up behind the vblank.
+    //
+    // With a late start, a frame that would finish well before the next vblank starts later still, by how much earlier
+    // recent frames finished, so it reads its input as late as it can.
+    class VulkanFramePacer
+    {
+    public:
+        VulkanFramePacer() = default;
+        ~VulkanFramePacer() = default;
+
+        VulkanFramePacer(const VulkanFramePacer &) = delete;
+        void operator=(VulkanFramePacer const &) = delete;
+
+        /**
+         * Prepares the pacer for use.
+         * @param device The logical device, with present_id and present_wait enabled; null if they are not supported,
+         * which leaves the pacer disabled.
+         * @param platform Clock and sleep of the platform.
+         * @param queuedPresents Presents that may still be waiting to be shown when a frame starts; 1 waits for the
+         * previous frame to be shown.
+         * @param lateStart Whether to delay the start of frames that would finish early, see above.
+         */
+        void Initialize(VkDevice device, Platform *platform, u32 queuedPresents, bool lateStart);
+
+        // Starts counting presents anew for a new swapchain.
+        void Reset(VkSwapchainKHR swapchain);
+
+        /**
+         * Blocks until the next frame should start. Gives up waiting on a present after a timeout, e.g. while the
+         * window is hidden and nothing is shown.
+         * @return Whether frames are paced.
+         */
+        bool Wait();
+
+        // Id of the present of the current frame, to chain into its present info. Only valid while enabled.
+        inline u64 NextPresentId() { return ++mPresentId; }
+
+        /**
+         * Records how long the frame took, for the late start of the following frames. Call once it is submitted.
+         * @param gpuFrameMs Recent GPU time of a frame.
+         */
+        void EndFrame(f64 gpuFrameMs);
+
+        [[nodiscard]] inline bool IsEnabled() const { return mWaitForPresent != nullptr; }
+
+    private:
+        VkDevice mDevice{};
+        Platform *mpPlatform{};
+        PFN_vkWaitForPresentKHR mWaitForPresent{};
+        VkSwapchainKHR mSwapchain{};
+        u32 mQueuedPresents = 1;
+        bool mLateStart = false;
+
+        u64 mPresentId{};               // Id of the most recent present to the swapchain.
+        u64 mShownId{};                 // Id of the most recent present known to have been shown.
+        f64 mShownTime{};               // Time that present was found to be shown.
+        f64 mRefreshInterval{};         // Seconds between vblanks, as reported by the platform or measured.
+        f64 mFrameStartTime{};          // Time the current frame started, after waiting.
+        f64 mFrameSeconds{};            // Recent time from the start of a frame until the GPU completes it.
+    };
+}
@@ -0,0 +1,353 @@
+#include "VulkanGpuCuller.h"
+#include <cmath>
+
+namespace Vkr
+{
+	// Threads per workgroup of cull.comp, and per side of a workgroup of hiz.comp.
+	constexpr u32 CULL_GROUP_SIZE = 64;
+	constexpr u32 REDUCE_GROUP_SIZE = 8;
+
+	StatusCode VulkanGpuCuller::Initialize(VkDevice device, const VkAllocationCallbacks *allocator, VulkanMemoryAllocator *memoryAllocator,
+										   VulkanBindlessHeap *bindlessHeap, VulkanShaderRegistry *shaderRegistry, VkPipelineCache pipelineCache,
+										   u32 framesInFlight)
+	{
+		mDevice = device;
+		mAllocator = allocator;
+		mpMemoryAllocator = memoryAllocator;
+		mpBindlessHeap = bindlessHeap;
+		mPipelineCache = pipelineCache;
+
+		StatusCode statusCode = LoadPipeline(shaderRegistry, "Shaders/cull.comp", &mCullPipeline);
+		RETURN_ON_FAIL(statusCode)
+		statusCode = LoadPipeline(shaderRegistry, "Shaders/hiz.comp", &mReducePipeline);
+		RETURN_ON_FAIL(statusCode)
+
+		// Written by the CPU every frame, read once by the GPU; not worth an upload.
+		mCullData.resize(framesInFlight);
+		mCullDataIndices.resize(framesInFlight, BINDLESS_INVALID_INDEX);
+		for (u32 i = 0; i < framesInFlight; ++i)
+		{
+			VulkanBuffer &buffer = mCullData[i];
+			VkBufferCreateInfo bufferCreateInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+			bufferCreateInfo.size = sizeof(CullData);
+			bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+			bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			VK_CHECK(vkCreateBuffer(mDevice, &bufferCreateInfo, mAllocator, &buffer.handle))
+			buffer.size = sizeof(CullData);
+
+			statusCode = mpMemoryAllocator->AllocateBufferMemory(buffer.handle, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+																 &buffer.allocation);
+			ENSURE_SUCCESS(statusCode, "Failed to allocate the culling data.")
+
+			mCullDataIndices[i] = mpBindlessHeap->RegisterBuffer(buffer.handle);
+		}
+
+		return StatusCode::Successful;
+	}
+
+	void VulkanGpuCuller::Shutdown()
+	{
+		if (!mDevice)
+			return;
+
+		DestroyPyramid(&mPyramid);
+
+		for (u32 i = 0; i < mCullData.size(); ++i)
+		{
+			mpBindlessHeap->ReleaseBuffer(mCullDataIndices[i]);
+			if (mCullData[i].handle)
+				vkDestroyBuffer(mDevice, mCullData[i].handle, mAllocator);
+
+			mpMemoryAllocator->Free(&mCullData[i].allocation);
+		}
+
+		mCullData.clear();
+		mCullDataIndices.clear();
+
+		vkDestroyPipeline(mDevice, mCullPipeline.handle.exchange(VK_NULL_HANDLE), mAllocator);
+		vkDestroyPipeline(mDevice, mReducePipeline.handle.exchange(VK_NULL_HANDLE), mAllocator);
+		for (auto pipeline : mRetiredPipelines)
+		{
+			vkDestroyPipeline(mDevice, pipeline, mAllocator);
+		}
+
+		mRetiredPipelines.clear();
+		mDevice = VK_NULL_HANDLE;
+	}
+
+	StatusCode VulkanGpuCuller::LoadPipeline(VulkanShaderRegistry *shaderRegistry, const char *path, ComputePipeline *outPipeline)
+	{
+		VulkanShader shader;
+		StatusCode statusCode = shaderRegistry->Load(path, &shader);
+		ENSURE_SUCCESS(statusCode, "Failed to load %s.", path)
+
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		VK_CHECK(CreatePipeline(shader.module, &pipeline))
+		outPipeline->handle.store(pipeline, std::memory_order_release);
+		outPipeline->shaderHash = shader.hash;
+
+		return StatusCode::Successful;
+	}
+
+	VkResult VulkanGpuCuller::CreatePipeline(VkShaderModule module, VkPipeline *outPipeline)
+	{
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = module;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.layout = mpBindlessHeap->GetPipelineLayout();
+		return vkCreateComputePipelines(mDevice, mPipelineCache, 1, &pipelineInfo, mAllocator, outPipeline);
+	}
+
+	void VulkanGpuCuller::ReplaceShader(u64 oldHash, const VulkanShader &shader)
+	{
+		for (ComputePipeline *pipeline : {&mCullPipeline, &mReducePipeline})
+		{
+			u32 generation;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (pipeline->shaderHash != oldHash)
+					continue;
+
+				pipeline->shaderHash = shader.hash;
+				generation = ++pipeline->generation;
+			}
+
+			VkPipeline rebuilt = VK_NULL_HANDLE;
+			VkResult result = CreatePipeline(shader.module, &rebuilt);
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (generation != pipeline->generation)
+			{
+				// A later rebuild superseded this one before it finished; nothing can be using the result.
+				if (rebuilt)
+					vkDestroyPipeline(mDevice, rebuilt, mAllocator);
+			}
+			else if (result == VK_SUCCESS)
+			{
+				// Frames in flight may still use the pipeline being replaced.
+				mRetiredPipelines.push_back(pipeline->handle.exchange(rebuilt, std::memory_order_acq_rel));
+			}
+			else
+			{
+				// Culling keeps running with the previous pipeline.
+				VERROR("Failed to rebuild a culling pipeline (VkResult %d).", result)
+			}
+		}
+	}
+
+	void VulkanGpuCuller::TakeRetiredPipelines(std::vector<VkPipeline> *outPipelines)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		outPipelines->insert(outPipelines->end(), mRetiredPipelines.begin(), mRetiredPipelines.end());
+		mRetiredPipelines.clear();
+	}
+
+	StatusCode VulkanGpuCuller::Resize(u32 width, u32 height, VulkanDeletionQueue *deletionQueue, u64 frameNumber)
+	{
+		// Frames in flight may still build or read the previous pyramid.
+		if (mPyramid.image)
+		{
+			auto retired = std::make_shared<Pyramid>(std::move(mPyramid));
+			deletionQueue->Push(frameNumber, [this, retired]() { DestroyPyramid(retired.get()); });
+		}
+
+		mPyramid = {};
+		mPyramidValid = false;
+		StatusCode statusCode = CreatePyramid(VMAX(width / 2, 1u), VMAX(height / 2, 1u), &mPyramid);
+		RETURN_ON_FAIL(statusCode)
+
+		mPyramid.depthWidth = width;
+		mPyramid.depthHeight = height;
+		return StatusCode::Successful;
+	}
+
+	void VulkanGpuCuller::SetDepth(VkImageView depthView, VulkanDeletionQueue *deletionQueue, u64 frameNumber)
+	{
+		if (depthView == mPyramid.depthView)
+			return;
+
+		// Frames in flight may still sample the previous depth attachment through its descriptor.
+		if (mPyramid.depthIndex != BINDLESS_INVALID_INDEX)
+		{
+			BindlessIndex retired = mPyramid.depthIndex;
+			deletionQueue->Push(frameNumber, [this, retired]() { mpBindlessHeap->ReleaseImage(retired); });
+		}
+
+		mPyramid.depthView = depthView;
+		mPyramid.depthIndex = mpBindlessHeap->RegisterImage(depthView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+	}
+
+	StatusCode VulkanGpuCuller::CreatePyramid(u32 width, u32 height, Pyramid *outPyramid)
+	{
+		outPyramid->width = width;
+		outPyramid->height = height;
+		outPyramid->levels = (u32)std::floor(std::log2((f32)VMAX(width, height))) + 1;
+
+		VkImageCreateInfo imageCreateInfo{};
+		imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageCreateInfo.format = VK_FORMAT_R32_SFLOAT;
+		imageCreateInfo.extent = {width, height, 1};
+		imageCreateInfo.mipLevels = outPyramid->levels;
+		imageCreateInfo.arrayLayers = 1;
+		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageCreateInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VK_CHECK(vkCreateImage(mDevice, &imageCreateInfo, mAllocator, &outPyramid->image))
+
+		StatusCode statusCode = mpMemoryAllocator->AllocateImageMemory(outPyramid->image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &outPyramid->allocation);
+		if (statusCode != StatusCode::Successful)
+		{
+			// Nothing may refer to an image without memory, so leave no pyramid behind at all.
+			vkDestroyImage(mDevice, outPyramid->image, mAllocator);
+			*outPyramid = {};
+			VERROR("Failed to allocate the depth pyramid.")
+			return statusCode;
+		}
+
+		VkImageViewCreateInfo viewCreateInfo{};
+		viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewCreateInfo.image = outPyramid->image;
+		viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewCreateInfo.format = VK_FORMAT_R32_SFLOAT;
+		viewCreateInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, outPyramid->levels, 0, 1};
+		VK_CHECK(vkCreateImageView(mDevice, &viewCreateInfo, mAllocator, &outPyramid->view))
+		outPyramid->index = mpBindlessHeap->RegisterImage(outPyramid->view, VK_IMAGE_LAYOUT_GENERAL);
+
+		outPyramid->levelViews.resize(outPyramid->levels);
+		outPyramid->sampledLevels.resize(outPyramid->levels);
+		outPyramid->storageLevels.resize(outPyramid->levels);
+		for (u32 level = 0; level < outPyramid->levels; ++level)
+		{
+			viewCreateInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+			VK_CHECK(vkCreateImageView(mDevice, &viewCreateInfo, mAllocator, &outPyramid->levelViews[level]))
+			outPyramid->sampledLevels[level] = mpBindlessHeap->RegisterImage(outPyramid->levelViews[level], VK_IMAGE_LAYOUT_GENERAL);
+			outPyramid->storageLevels[level] = mpBindlessHeap->RegisterStorageImage(outPyramid->levelViews[level]);
+		}
+
+		return StatusCode::Successful;
+	}
+
+	void VulkanGpuCuller::DestroyPyramid(Pyramid *pyramid)
+	{
+		mpBindlessHeap->ReleaseImage(pyramid->depthIndex);
+		mpBindlessHeap->ReleaseImage(pyramid->index);
+		for (u32 level = 0; level < pyramid->levelViews.size(); ++level)
+		{
+			mpBindlessHeap->ReleaseImage(pyramid->sampledLevels[level]);
+			mpBindlessHeap->ReleaseStorageImage(pyramid->storageLevels[level]);
+			vkDestroyImageView(mDevice, pyramid->levelViews[level], mAllocator);
+		}
+
+		if (pyramid->view)
+			vkDestroyImageView(mDevice, pyramid->view, mAllocator);
+		if (pyramid->image)
+			vkDestroyImage(mDevice, pyramid->image, mAllocator);
+
+		mpMemoryAllocator->Free(&pyramid->allocation);
+		*pyramid = {};
+	}
+
+	void VulkanGpuCuller::RecordCulling(VkCommandBuffer commandBuffer, u32 frameIndex, const VulkanGpuScene &scene)
+	{
+		const SceneCullTargets targets = scene.GetCullTargets();
+		const f32 *m = scene.GetViewProjection();
+
+		// The frame's previous use of its culling data has completed, since its fence was waited on.
+		CullData &data = *static_cast<CullData *>(mCullData[frameIndex].allocation.mapped);
+		std::memcpy(data.viewProjection, m, sizeof(data.viewProjection));
+
+		// Planes from sums of the rows of the column-major matrix, for Vulkan's 0..w clip space depth:
+		// left, right, bottom, top, near, far.
+		for (u32 plane = 0; plane < 6; ++plane)
+		{
+			const u32 row = plane < 4 ? plane / 2 : 2;
+			const f32 sign = plane % 2 == 0 ? 1.0f : -1.0f;
+			f32 *p = data.frustumPlanes[plane];
+			for (u32 column = 0; column < 4; ++column)
+			{
+				const f32 w = m[column * 4 + 3];
+				const f32 r = m[column * 4 + row];
+				p[column] = plane == 4 ? r : w + sign * r;
+			}
+
+			const f32 length = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+			if (length > 0.0f)
+			{
+				for (u32 i = 0; i < 4; ++i)
+				{
+					p[i] /= length;
+				}
+			}
+		}
+
+		data.objectCount = targets.objectCount;
+		data.pyramidWidth = mPyramid.width;
+		data.pyramidHeight = mPyramid.height;
+		data.pyramidLevels = mPyramid.levels;
+		data.occlusion = mPyramidValid ? 1 : 0;
+
+		vkCmdFillBuffer(commandBuffer, targets.counts, 0, VK_WHOLE_SIZE, 0);
+
+		VkMemoryBarrier clearBarrier{};
+		clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+		CullConstants constants{mCullDataIndices[frameIndex], targets.instanceBuffer, targets.meshBuffer, targets.batchBuffer,
+								targets.commandBuffer, targets.countBuffer, mPyramid.index};
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mCullPipeline.handle.load(std::memory_order_acquire));
+		mpBindlessHeap->Bind(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+		mpBindlessHeap->PushConstants(commandBuffer, constants);
+		vkCmdDispatch(commandBuffer, (targets.objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+	}
+
+	void VulkanGpuCuller::RecordPyramid(VkCommandBuffer commandBuffer)
+	{
+		if (!mPyramid.image || mPyramid.depthIndex == BINDLESS_INVALID_INDEX)
+			return;
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mReducePipeline.handle.load(std::memory_order_acquire));
+		mpBindlessHeap->Bind(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+
+		// Each level reads the one below it, so the levels are built one after another.
+		VkMemoryBarrier levelBarrier{};
+		levelBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		u32 sourceWidth = mPyramid.depthWidth;
+		u32 sourceHeight = mPyramid.depthHeight;
+		for (u32 level = 0; level < mPyramid.levels; ++level)
+		{
+			const u32 width = VMAX(mPyramid.width >> level, 1u);
+			const u32 height = VMAX(mPyramid.height >> level, 1u);
+
+			ReduceConstants constants{};
+			constants.source = level == 0 ? mPyramid.depthIndex : mPyramid.sampledLevels[level - 1];
+			constants.destination = mPyramid.storageLevels[level];
+			constants.sourceSize[0] = sourceWidth;
+			constants.sourceSize[1] = sourceHeight;
+			constants.destinationSize[0] = width;
+			constants.destinationSize[1] = height;
+			mpBindlessHeap->PushConstants(commandBuffer, constants);
+
+			vkCmdDispatch(commandBuffer, (width + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE, (height + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE, 1);
+			if (level + 1 < mPyramid.levels)
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &levelBarrier,
+									 0, nullptr, 0, nullptr);
+
+			sourceWidth = width;
+			sourceHeight = height;
+		}
+
+		mPyramidValid = true;
+	}
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include "Defines.h"
+#include "VulkanBuffer.h"
+#include "VulkanBindlessHeap.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanGpuScene.h"
+#include "VulkanShaderRegistry.h"
+#include <atomic>
+#include <mutex>
+
+namespace Vkr
+{
+    // Culls the scene on the GPU every frame: a compute pass tests each object's bounding sphere against the view frustum
+    // and against a hierarchical depth (Hi-Z) pyramid, and writes the visible objects' draws, packed per batch, into the
+    // scene's culled buffers. The CPU cost does not depend on the number of objects.
+    //
+    // The pyramid is reduced from the previous frame's depth buffer after its main pass, each level holding the farthest
+    // depth of 2x2 texels of the level below. Objects hidden last frame but uncovered this frame are drawn one frame late.
+    //
+    // Both passes are recorded into the frame's graphics command buffer: the draws of the same frame consume the culling
+    // results, and the pyramid needs the depth the frame just rendered, so neither could overlap anything on another queue.
+    class VulkanGpuCuller
+    {
+    public:
+        VulkanGpuCuller() = default;
+        ~VulkanGpuCuller() = default;
+
+        VulkanGpuCuller(const VulkanGpuCuller &) = delete;
+        void operator=(VulkanGpuCuller const &) = delete;
+
+        /**
+         * Creates the compute pipelines and the per frame culling data.
+         * @param device The logical device.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param memoryAllocator Allocator the pyramid and culling data are allocated from.
+         * @param bindlessHeap Heap the pyramid and culling data are registered in; its layout is the pipelines' layout.
+         * @param shaderRegistry Loads the compute shaders.
+         * @param pipelineCache Cache the pipelines are created with.
+         * @param framesInFlight Number of frames that may be recorded before the first of them has completed.
+         */
+        StatusCode Initialize(VkDevice device, const VkAllocationCallbacks *allocator, VulkanMemoryAllocator *memoryAllocator,
+                              VulkanBindlessHeap *bindlessHeap, VulkanShaderRegistry *shaderRegistry, VkPipelineCache pipelineCache,
+                              u32 framesInFlight);
+
+        // Destroys everything. The device must be idle.
+        void Shutdown();
+
+        /**
+         * Recreates the pyramid for a new depth buffer size. Occlusion culling is off until the pyramid has been built once.
+         * @param width Width of the depth attachment.
+         * @param height Height of the depth attachment.
+         * @param deletionQueue Queue the previous pyramid is retired through.
+         * @param frameNumber The frame being recorded.
+         * @return Failure if the pyramid could not be allocated, in which case there is none.
+         */
+        StatusCode Resize(u32 width, u32 height, VulkanDeletionQueue *deletionQueue, u64 frameNumber);
+
+        /**
+         * Sets the depth attachment the pyramid is built from. It is a transient image of the render graph, so its view
+         * only changes when the graph recreates it; call before every `RecordPyramid`.
+         * @param depthView View of the depth aspect of the depth attachment, which has sampled usage.
+         * @param deletionQueue Queue the previous depth view's descriptor is retired through.
+         * @param frameNumber The frame being recorded.
+         */
+        void SetDepth(VkImageView depthView, VulkanDeletionQueue *deletionQueue, u64 frameNumber);
+
+        /**
+         * Fills the scene's culled buffers with this frame's visible objects, as a render graph pass reading the pyramid in
+         * VK_IMAGE_LAYOUT_GENERAL and writing the culled buffers with transfers and compute shaders.
+         * @param commandBuffer The frame's primary command buffer, outside of any rendering instance.
+         * @param frameIndex Index of the frame in flight, selecting its culling data.
+         * @param scene A ready scene.
+         */
+        void RecordCulling(VkCommandBuffer commandBuffer, u32 frameIndex, const VulkanGpuScene &scene);
+
+        /**
+         * Builds the pyramid from the depth the main pass rendered, for the next frame's culling, as a render graph pass
+         * sampling the depth attachment in VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL and writing the pyramid in
+         * VK_IMAGE_LAYOUT_GENERAL.
+         * @param commandBuffer The frame's primary command buffer, outside of any rendering instance.
+         */
+        void RecordPyramid(VkCommandBuffer commandBuffer);
+
+        /**
+         * Rebuilds the compute pipelines created from a reloaded shader. Safe to call from any thread; frames recorded
+         * afterwards use the rebuilt pipeline, while the previous one is retired through `TakeRetiredPipelines`.
+         * @param oldHash Hash of the shader before the reload.
+         * @param shader The reloaded shader.
+         */
+        void ReplaceShader(u64 oldHash, const VulkanShader &shader);
+
+        // Moves the pipelines replaced by rebuilds, which frames in flight may still use, to the given list.
+        void TakeRetiredPipelines(std::vector<VkPipeline> *outPipelines);
+
+        // The pyramid image, null until the first Resize.
+        [[nodiscard]] inline VkImage GetPyramid() const { return mPyramid.image; }
+
+    private:
+        // std430 layout of the CullData block of cull.comp, one per frame in flight.
+        struct CullData
+        {
+            f32 viewProjection[16];
+            f32 frustumPlanes[6][4];        // xyz normal pointing inwards, w distance.
+            u32 objectCount;
+            u32 pyramidWidth;
+            u32 pyramidHeight;
+            u32 pyramidLevels;
+            u32 occlusion;                  // Whether the pyramid holds the previous frame's depth.
+        };
+
+        // Push constants of cull.comp.
+        struct CullConstants
+        {
+            BindlessIndex cullData;
+            BindlessIndex instanceBuffer;
+            BindlessIndex meshBuffer;
+            BindlessIndex batchBuffer;
+            BindlessIndex commandBuffer;
+            BindlessIndex countBuffer;
+            BindlessIndex pyramid;
+        };
+
+        // Push constants of hiz.comp.
+        struct ReduceConstants
+        {
+            BindlessIndex source;           // Sampled image of the level below, or of the depth attachment.
+            BindlessIndex destination;      // Storage image of the level being built.
+            u32 sourceSize[2];
+            u32 destinationSize[2];
+        };
+
+        // The pyramid, accessed in VK_IMAGE_LAYOUT_GENERAL, and the depth attachment it is built from.
+        struct Pyramid
+        {
+            VkImage image{};
+            VulkanAllocation allocation{};
+            VkImageView view{};                         // Every level, sampled by culling.
+            std::vector<VkImageView> levelViews;        // One level each, sampled by the next level's reduction and stored to.
+            BindlessIndex index = BINDLESS_INVALID_INDEX;
+            std::vector<BindlessIndex> sampledLevels;
+            std::vector<BindlessIndex> storageLevels;
+            u32 width{};                                // Size of level 0, half the depth attachment's.
+            u32 height{};
+            u32 levels{};
+
+            u32 depthWidth{};
+            u32 depthHeight{};
+            VkImageView depthView{};
+            BindlessIndex depthIndex = BINDLESS_INVALID_INDEX;
+        };
+
+        // A compute pipeline, rebuilt when its shader is reloaded.
+        struct ComputePipeline
+        {
+            std::atomic<VkPipeline> handle{};       // Swapped when a rebuild completes.
+            u64 shaderHash{};                       // Hash of the shader the latest rebuild uses.
+            u32 generation{};                       // Bumped by every rebuild; only the latest rebuild is kept.
+        };
+
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        VkPipelineCache mPipelineCache{};
+        VulkanMemoryAllocator *mpMemoryAllocator{};
+        VulkanBindlessHeap *mpBindlessHeap{};
+
+        ComputePipeline mCullPipeline;
+        ComputePipeline mReducePipeline;
+        std::mutex mMutex;                              // Guards the shader hashes, generations and retired pipelines.
+        std::vector<VkPipeline> mRetiredPipelines;      // Replaced by rebuilds, possibly still used by frames in flight.
+        std::vector<VulkanBuffer> mCullData;            // Host visible, one per frame in flight.
+        std::vector<BindlessIndex> mCullDataIndices;
+        Pyramid mPyramid;
+        bool mPyramidValid = false;                     // Whether the pyramid holds a previous frame's depth.
+
+        StatusCode LoadPipeline(VulkanShaderRegistry *shaderRegistry, const char *path, ComputePipeline *outPipeline);
+        VkResult CreatePipeline(VkShaderModule module, VkPipeline *outPipeline);
+        StatusCode CreatePyramid(u32 width, u32 height, Pyramid *outPyramid);
+        void DestroyPyramid(Pyramid *pyramid);
+    };
+}
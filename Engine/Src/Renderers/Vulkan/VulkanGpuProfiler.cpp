@@ -0,0 +1,181 @@
+#include "VulkanGpuProfiler.h"
+
+namespace Vkr
+{
+	constexpr u32 INVALID_ZONE = ~0u;
+
+	void VulkanGpuProfiler::Initialize(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks *allocator,
+									   const VkPhysicalDeviceProperties &properties, u32 queueFamilyIndex, u32 framesInFlight, u32 maxZones)
+	{
+		mDevice = device;
+		mAllocator = allocator;
+		mMaxZones = maxZones;
+
+		u32 queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+		u32 validBits = queueFamilyIndex < queueFamilyCount ? queueFamilies[queueFamilyIndex].timestampValidBits : 0;
+		if (validBits == 0 || properties.limits.timestampPeriod <= 0.0f)
+		{
+			VWARN("The graphics queue doesn't support timestamps, GPU profiling is disabled.")
+			return;
+		}
+
+		mEnabled = true;
+		mTimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+		mTimestampPeriodMs = properties.limits.timestampPeriod / 1e6;	// The period is in nanoseconds.
+		mResults.resize(FRAME_QUERIES + 2 * mMaxZones);
+
+		mFrames.resize(framesInFlight);
+		for (auto &frame : mFrames)
+		{
+			VkQueryPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			poolInfo.queryCount = mResults.size();
+			VK_CHECK(vkCreateQueryPool(mDevice, &poolInfo, mAllocator, &frame.pool))
+			frame.zoneNames.reserve(mMaxZones);
+		}
+	}
+
+	void VulkanGpuProfiler::Shutdown()
+	{
+		for (auto &frame : mFrames)
+		{
+			vkDestroyQueryPool(mDevice, frame.pool, mAllocator);
+		}
+
+		mFrames.clear();
+		mpCurrent = nullptr;
+		mEnabled = false;
+	}
+
+	void VulkanGpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, u32 frameIndex)
+	{
+		if (!mEnabled)
+			return;
+
+		mpCurrent = &mFrames[frameIndex];
+		if (mpCurrent->recorded)
+			ReadResults(*mpCurrent);
+
+		mpCurrent->zoneNames.clear();
+		mpCurrent->recorded = true;
+		vkCmdResetQueryPool(commandBuffer, mpCurrent->pool, 0, mResults.size());
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mpCurrent->pool, 0);
+	}
+
+	void VulkanGpuProfiler::EndFrame(VkCommandBuffer commandBuffer, f64 cpuFrameMs, f64 cpuWaitMs)
+	{
+		if (!mpCurrent)
+			return;
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mpCurrent->pool, 1);
+		mpCurrent->cpuFrameMs = cpuFrameMs;
+		mpCurrent->cpuWaitMs = cpuWaitMs;
+		mpCurrent = nullptr;
+	}
+
+	u32 VulkanGpuProfiler::BeginZone(VkCommandBuffer commandBuffer, const char *name)
+	{
+		if (!mpCurrent || mpCurrent->zoneNames.size() == mMaxZones)
+			return INVALID_ZONE;
+
+		u32 zone = mpCurrent->zoneNames.size();
+		mpCurrent->zoneNames.push_back(name);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mpCurrent->pool, FRAME_QUERIES + 2 * zone);
+		return zone;
+	}
+
+	void VulkanGpuProfiler::EndZone(VkCommandBuffer commandBuffer, u32 zone)
+	{
+		if (!mpCurrent || zone == INVALID_ZONE)
+			return;
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mpCurrent->pool, FRAME_QUERIES + 2 * zone + 1);
+	}
+
+	void VulkanGpuProfiler::ReadResults(Frame &frame)
+	{
+		frame.recorded = false;
+		u32 queryCount = FRAME_QUERIES + 2 * frame.zoneNames.size();
+
+		// The frame's fence has signaled, so the results are available and this doesn't wait.
+		VkResult result = vkGetQueryPoolResults(mDevice, frame.pool, 0, queryCount, queryCount * sizeof(u64), mResults.data(),
+												sizeof(u64), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
+			return;
+
+		mLatest.cpuFrameMs = frame.cpuFrameMs;
+		mLatest.cpuWaitMs = frame.cpuWaitMs;
+		mLatest.gpuFrameMs = TicksToMs(mResults[0], mResults[1]);
+		mLatest.zones.clear();
+
+		for (u32 zone = 0; zone < frame.zoneNames.size(); ++zone)
+		{
+			u32 query = FRAME_QUERIES + 2 * zone;
+			mLatest.zones.push_back({frame.zoneNames[zone], TicksToMs(mResults[query], mResults[query + 1])});
+		}
+
+		// Accumulate for the statistics; zones are matched by name, since not every frame records the same ones.
+		mSum.cpuFrameMs += mLatest.cpuFrameMs;
+		mSum.cpuWaitMs += mLatest.cpuWaitMs;
+		mSum.gpuFrameMs += mLatest.gpuFrameMs;
+		++mSummedFrames;
+
+		for (const auto &timing : mLatest.zones)
+		{
+			auto it = std::find_if(mSum.zones.begin(), mSum.zones.end(),
+								   [&timing](const GpuZoneTiming &sum) { return strcmp(sum.name, timing.name) == 0; });
+			if (it == mSum.zones.end())
+				mSum.zones.push_back(timing);
+			else
+			{
+				it->milliseconds += timing.milliseconds;
+				++it->frames;
+			}
+		}
+	}
+
+	f64 VulkanGpuProfiler::TicksToMs(u64 begin, u64 end) const
+	{
+		return (f64)((end - begin) & mTimestampMask) * mTimestampPeriodMs;
+	}
+
+	void VulkanGpuProfiler::Update(f64 time, f64 intervalSeconds)
+	{
+		if (time - mLastLogTime < intervalSeconds)
+			return;
+
+		mLastLogTime = time;
+		LogStats();
+	}
+
+	void VulkanGpuProfiler::LogStats()
+	{
+		if (mSummedFrames == 0)
+			return;
+
+		const f64 frames = mSummedFrames;
+		const f64 cpuFrameMs = mSum.cpuFrameMs / frames;
+		const f64 cpuWaitMs = mSum.cpuWaitMs / frames;
+		const f64 gpuFrameMs = mSum.gpuFrameMs / frames;
+
+		// Whichever side is busy for longer limits the frame rate; the CPU waiting on the GPU means the GPU does.
+		const bool gpuBound = gpuFrameMs >= cpuFrameMs - cpuWaitMs;
+
+		VINFO("Frame timings, average of %u frames: %.2f ms (CPU busy %.2f ms, waiting on GPU %.2f ms), GPU %.2f ms. %s-bound.",
+			  mSummedFrames, cpuFrameMs, cpuFrameMs - cpuWaitMs, cpuWaitMs, gpuFrameMs, gpuBound ? "GPU" : "CPU")
+
+		for (const auto &zone : mSum.zones)
+		{
+			// Averaged over the frames that recorded the zone, e.g. culling only runs in some.
+			VINFO("\tGPU %s: %.3f ms over %u frames", zone.name, zone.milliseconds / zone.frames, zone.frames)
+		}
+
+		mSum = {};
+		mSummedFrames = 0;
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include "Defines.h"
+
+namespace Vkr
+{
+    struct GpuZoneTiming
+    {
+        const char *name;
+        f64 milliseconds;
+        u32 frames = 1;                     // Frames the time is summed over; only above 1 in the profiler's statistics.
+    };
+
+    // Timings of one frame, as measured on the CPU and on the GPU.
+    struct FrameTimings
+    {
+        f64 cpuFrameMs{};                   // Time between the starts of consecutive frames.
+        f64 cpuWaitMs{};                    // Time the CPU spent blocked on the GPU finishing an earlier frame.
+        f64 gpuFrameMs{};                   // Time between the start and the end of the frame's command buffer on the GPU.
+        std::vector<GpuZoneTiming> zones;   // GPU time of every zone, in the order they were begun.
+    };
+
+    // Measures GPU time with timestamp queries, per frame and per zone (e.g. a pass).
+    //
+    // Every frame in flight has its own query pool. Its results are read when the slot is reused, by which time its fence
+    // has signaled, so reading them never stalls. Timings are thus a few frames old. When the graphics queue doesn't
+    // support timestamps the profiler does nothing.
+    class VulkanGpuProfiler
+    {
+    public:
+        VulkanGpuProfiler() = default;
+        ~VulkanGpuProfiler() = default;
+
+        VulkanGpuProfiler(const VulkanGpuProfiler &) = delete;
+        void operator=(VulkanGpuProfiler const &) = delete;
+
+        /**
+         * Creates a query pool per frame in flight.
+         * @param physicalDevice The device, whose queue family reports timestamp support.
+         * @param device The logical device.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param properties Properties of the physical device; its timestamp period converts ticks to time.
+         * @param queueFamilyIndex Family of the queue the frames are submitted to.
+         * @param framesInFlight Number of frames in flight.
+         * @param maxZones Most zones recorded in a frame; further zones are ignored.
+         */
+        void Initialize(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks *allocator,
+                        const VkPhysicalDeviceProperties &properties, u32 queueFamilyIndex, u32 framesInFlight, u32 maxZones = 32);
+
+        // Destroys the query pools. The device must be idle.
+        void Shutdown();
+
+        /**
+         * Reads the results of the frame last recorded in this slot, then starts measuring the new one.
+         * Call at the start of the frame's command buffer, after its fence has been waited on.
+         * @param frameIndex Index of the frame in flight being recorded.
+         */
+        void BeginFrame(VkCommandBuffer commandBuffer, u32 frameIndex);
+
+        /**
+         * Stops measuring the frame. Call at the end of the frame's command buffer.
+         * @param cpuFrameMs CPU time since the previous frame started.
+         * @param cpuWaitMs CPU time of this frame spent waiting on the GPU.
+         */
+        void EndFrame(VkCommandBuffer commandBuffer, f64 cpuFrameMs, f64 cpuWaitMs);
+
+        /**
+         * Starts a zone. Zones may nest, but must be recorded in a primary command buffer, outside rendering instances
+         * whose contents are secondary command buffers.
+         * @param name Shown in the statistics; must outlive the profiler, e.g. a string literal.
+         * @return The zone to pass to `EndZone`.
+         */
+        u32 BeginZone(VkCommandBuffer commandBuffer, const char *name);
+
+        void EndZone(VkCommandBuffer commandBuffer, u32 zone);
+
+        // Timings of the most recent frame whose results were read.
+        [[nodiscard]] inline const FrameTimings &GetLatest() const { return mLatest; }
+
+        /**
+         * Logs the average timings once per interval.
+         * @param time The current absolute time in seconds.
+         */
+        void Update(f64 time, f64 intervalSeconds = 5.0);
+
+        // Logs the average timings since they were last logged.
+        void LogStats();
+
+    private:
+        // Queries 0 and 1 time the frame, then two per zone.
+        static constexpr u32 FRAME_QUERIES = 2;
+
+        struct Frame
+        {
+            VkQueryPool pool{};
+            std::vector<const char *> zoneNames;    // Zones begun in the frame, in order.
+            f64 cpuFrameMs{};
+            f64 cpuWaitMs{};
+            bool recorded = false;                  // Whether the queries were written and not read yet.
+        };
+
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        bool mEnabled = false;
+        f64 mTimestampPeriodMs{};                   // Milliseconds per tick.
+        u64 mTimestampMask{};                       // Bits of a timestamp that are valid.
+        u32 mMaxZones{};
+        std::vector<Frame> mFrames;
+        Frame *mpCurrent{};
+        std::vector<u64> mResults;
+
+        FrameTimings mLatest;
+        FrameTimings mSum;                          // Totals of the frames since the statistics were last logged.
+        u32 mSummedFrames{};
+        f64 mLastLogTime{};
+
+        void ReadResults(Frame &frame);
+        f64 TicksToMs(u64 begin, u64 end) const;
+    };
+
+    // Times the GPU work recorded while it is in scope.
+    class VulkanGpuZone
+    {
+    public:
+        VulkanGpuZone(VulkanGpuProfiler *profiler, VkCommandBuffer commandBuffer, const char *name)
+            : mpProfiler(profiler), mCommandBuffer(commandBuffer), mZone(profiler->BeginZone(commandBuffer, name)) {}
+
+        ~VulkanGpuZone() { mpProfiler->EndZone(mCommandBuffer, mZone); }
+
+        VulkanGpuZone(const VulkanGpuZone &) = delete;
+        void operator=(VulkanGpuZone const &) = delete;
+
+    private:
+        VulkanGpuProfiler *mpProfiler;
+        VkCommandBuffer mCommandBuffer;
+        u32 mZone;
+    };
+}
@@ -0,0 +1,282 @@
+#include "VulkanGpuScene.h"
+#include <cfloat>
+#include <cmath>
+
+namespace Vkr
+{
+	void VulkanGpuScene::Initialize(VkDevice device, const VkAllocationCallbacks *allocator, VulkanMemoryAllocator *memoryAllocator,
+									VulkanUploadManager *uploadManager, VulkanBindlessHeap *bindlessHeap)
+	{
+		mDevice = device;
+		mAllocator = allocator;
+		mpMemoryAllocator = memoryAllocator;
+		mpUploadManager = uploadManager;
+		mpBindlessHeap = bindlessHeap;
+
+		// Identity until a camera sets it.
+		for (u32 i = 0; i < 16; ++i)
+		{
+			mConstants.viewProjection[i] = i % 5 == 0 ? 1.0f : 0.0f;
+		}
+
+		mConstants.vertexBuffer = BINDLESS_INVALID_INDEX;
+		mConstants.instanceBuffer = BINDLESS_INVALID_INDEX;
+		mConstants.meshBuffer = BINDLESS_INVALID_INDEX;
+		mConstants.materialBuffer = BINDLESS_INVALID_INDEX;
+	}
+
+	void VulkanGpuScene::Shutdown()
+	{
+		DestroyBuffers(&mBuffers);
+		Clear();
+	}
+
+	MeshId VulkanGpuScene::AddMesh(const SceneVertex *vertices, u32 vertexCount, const u32 *indices, u32 indexCount)
+	{
+		GpuMesh mesh{};
+		mesh.indexCount = indexCount;
+		mesh.firstIndex = mIndices.size();
+		mesh.vertexOffset = (i32)mVertices.size();
+
+		// Bounding sphere around the center of the bounding box, for culling.
+		f32 min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		f32 max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+		for (u32 i = 0; i < vertexCount; ++i)
+		{
+			for (u32 axis = 0; axis < 3; ++axis)
+			{
+				min[axis] = VMIN(min[axis], vertices[i].position[axis]);
+				max[axis] = VMAX(max[axis], vertices[i].position[axis]);
+			}
+		}
+
+		f32 radiusSquared = 0.0f;
+		for (u32 axis = 0; axis < 3; ++axis)
+		{
+			mesh.boundsCenter[axis] = (min[axis] + max[axis]) * 0.5f;
+		}
+		for (u32 i = 0; i < vertexCount; ++i)
+		{
+			f32 dx = vertices[i].position[0] - mesh.boundsCenter[0];
+			f32 dy = vertices[i].position[1] - mesh.boundsCenter[1];
+			f32 dz = vertices[i].position[2] - mesh.boundsCenter[2];
+			radiusSquared = VMAX(radiusSquared, dx * dx + dy * dy + dz * dz);
+		}
+		mesh.boundsRadius = std::sqrt(radiusSquared);
+
+		mVertices.insert(mVertices.end(), vertices, vertices + vertexCount);
+		mIndices.insert(mIndices.end(), indices, indices + indexCount);
+		mMeshes.push_back(mesh);
+		return mMeshes.size() - 1;
+	}
+
+	void VulkanGpuScene::AddObject(const SceneObject &object)
+	{
+		mObjects.push_back(object);
+	}
+
+	void VulkanGpuScene::Clear()
+	{
+		mVertices.clear();
+		mIndices.clear();
+		mMeshes.clear();
+		mObjects.clear();
+	}
+
+	void VulkanGpuScene::Update(VulkanDeletionQueue *deletionQueue, u64 frameNumber)
+	{
+		if (!mBuildPending)
+			return;
+
+		mBuildPending = false;
+
+		Buffers buffers;
+		StatusCode statusCode = BuildBuffers(&buffers);
+		if (statusCode != StatusCode::Successful)
+		{
+			VERROR("Failed to build the scene, keeping the previous build.")
+			DestroyBuffers(&buffers);
+			return;
+		}
+
+		// Frames in flight may still draw the previous build.
+		auto retired = std::make_shared<Buffers>(std::move(mBuffers));
+		deletionQueue->Push(frameNumber, [this, retired]() { DestroyBuffers(retired.get()); });
+
+		mBuffers = std::move(buffers);
+		mConstants.vertexBuffer = mBuffers.vertexIndex;
+		mConstants.meshBuffer = mBuffers.meshIndex;
+		mConstants.instanceBuffer = mBuffers.instanceIndex;
+
+		mStats.meshes = mMeshes.size();
+		mStats.objects = mObjects.size();
+		mStats.batches = mBuffers.batches.size();
+		VDEBUG("Scene built: %u meshes, %u objects, %u indirect draws.", mStats.meshes, mStats.objects, mStats.batches)
+	}
+
+	StatusCode VulkanGpuScene::BuildBuffers(Buffers *outBuffers)
+	{
+		if (mObjects.empty())
+			return StatusCode::Successful;
+
+		// Group the objects by pipeline; each group becomes one indirect draw.
+		std::vector<u32> order(mObjects.size());
+		for (u32 i = 0; i < order.size(); ++i)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [this](u32 a, u32 b) { return mObjects[a].pipeline.index < mObjects[b].pipeline.index; });
+
+		std::vector<GpuInstance> instances(mObjects.size());
+		std::vector<VkDrawIndexedIndirectCommand> commands(mObjects.size());
+		std::vector<u32> counts;
+		std::vector<u32> batchTable;
+
+		for (u32 i = 0; i < order.size(); ++i)
+		{
+			const SceneObject &object = mObjects[order[i]];
+			const GpuMesh &mesh = mMeshes[object.mesh];
+
+			GpuInstance &instance = instances[i];
+			std::memcpy(instance.transform, object.transform, sizeof(instance.transform));
+			instance.mesh = object.mesh;
+			instance.material = object.material;
+
+			// The instance index is the object's index, which is how the shaders find its data.
+			commands[i] = {mesh.indexCount, 1, mesh.firstIndex, mesh.vertexOffset, i};
+
+			if (outBuffers->batches.empty() || outBuffers->batches.back().pipeline.index != object.pipeline.index)
+			{
+				outBuffers->batches.push_back({object.pipeline, i, 0});
+				counts.push_back(0);
+				batchTable.push_back(i);
+			}
+
+			instance.batch = outBuffers->batches.size() - 1;
+
+			outBuffers->batches.back().commandCount++;
+			counts.back()++;
+		}
+
+		const VkBufferUsageFlags storage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		const VkBufferUsageFlags indirect = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+		// Every buffer is created before anything is uploaded, so a failure leaves no upload to a destroyed buffer.
+		// The culled buffers are written on the GPU, so they have no contents.
+		struct Contents
+		{
+			VulkanBuffer *buffer;
+			VkBufferUsageFlags usage;
+			const void *data;
+			VkDeviceSize size;
+		};
+
+		const std::array<Contents, 9> contents = {{
+			{&outBuffers->vertices, storage, mVertices.data(), mVertices.size() * sizeof(SceneVertex)},
+			{&outBuffers->indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, mIndices.data(), mIndices.size() * sizeof(u32)},
+			{&outBuffers->meshes, storage, mMeshes.data(), mMeshes.size() * sizeof(GpuMesh)},
+			{&outBuffers->instances, storage, instances.data(), instances.size() * sizeof(GpuInstance)},
+			{&outBuffers->commands, indirect, commands.data(), commands.size() * sizeof(VkDrawIndexedIndirectCommand)},
+			{&outBuffers->counts, indirect, counts.data(), counts.size() * sizeof(u32)},
+			{&outBuffers->batchTable, storage, batchTable.data(), batchTable.size() * sizeof(u32)},
+			{&outBuffers->culledCommands, indirect, nullptr, commands.size() * sizeof(VkDrawIndexedIndirectCommand)},
+			{&outBuffers->culledCounts, indirect, nullptr, counts.size() * sizeof(u32)},
+		}};
+
+		for (const auto &content : contents)
+		{
+			StatusCode statusCode = CreateBuffer(content.size, content.usage, content.buffer);
+			RETURN_ON_FAIL(statusCode)
+		}
+
+		for (const auto &content : contents)
+		{
+			if (content.data)
+				outBuffers->upload = mpUploadManager->UploadBuffer(content.buffer->handle, 0, content.data, content.size);
+		}
+
+		outBuffers->vertexIndex = mpBindlessHeap->RegisterBuffer(outBuffers->vertices.handle);
+		outBuffers->meshIndex = mpBindlessHeap->RegisterBuffer(outBuffers->meshes.handle);
+		outBuffers->instanceIndex = mpBindlessHeap->RegisterBuffer(outBuffers->instances.handle);
+		outBuffers->batchTableIndex = mpBindlessHeap->RegisterBuffer(outBuffers->batchTable.handle);
+		outBuffers->culledCommandIndex = mpBindlessHeap->RegisterBuffer(outBuffers->culledCommands.handle);
+		outBuffers->culledCountIndex = mpBindlessHeap->RegisterBuffer(outBuffers->culledCounts.handle);
+		return StatusCode::Successful;
+	}
+
+	StatusCode VulkanGpuScene::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VulkanBuffer *outBuffer)
+	{
+		VkBufferCreateInfo bufferCreateInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+		bufferCreateInfo.size = size;
+		bufferCreateInfo.usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		VK_CHECK(vkCreateBuffer(mDevice, &bufferCreateInfo, mAllocator, &outBuffer->handle))
+		outBuffer->size = size;
+
+		StatusCode statusCode = mpMemoryAllocator->AllocateBufferMemory(outBuffer->handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &outBuffer->allocation);
+		ENSURE_SUCCESS(statusCode, "Failed to allocate a %llu byte scene buffer.", (unsigned long long)size)
+
+		return StatusCode::Successful;
+	}
+
+	void VulkanGpuScene::DestroyBuffers(Buffers *buffers)
+	{
+		mpBindlessHeap->ReleaseBuffer(buffers->vertexIndex);
+		mpBindlessHeap->ReleaseBuffer(buffers->meshIndex);
+		mpBindlessHeap->ReleaseBuffer(buffers->instanceIndex);
+		mpBindlessHeap->ReleaseBuffer(buffers->batchTableIndex);
+		mpBindlessHeap->ReleaseBuffer(buffers->culledCommandIndex);
+		mpBindlessHeap->ReleaseBuffer(buffers->culledCountIndex);
+
+		for (VulkanBuffer *buffer : {&buffers->vertices, &buffers->indices, &buffers->meshes, &buffers->instances, &buffers->commands, &buffers->counts,
+									 &buffers->batchTable, &buffers->culledCommands, &buffers->culledCounts})
+		{
+			if (buffer->handle)
+				vkDestroyBuffer(mDevice, buffer->handle, mAllocator);
+
+			mpMemoryAllocator->Free(&buffer->allocation);
+		}
+
+		*buffers = {};
+	}
+
+	void VulkanGpuScene::SetViewProjection(const f32 viewProjection[16])
+	{
+		std::memcpy(mConstants.viewProjection, viewProjection, sizeof(mConstants.viewProjection));
+	}
+
+	SceneCullTargets VulkanGpuScene::GetCullTargets() const
+	{
+		return {mStats.objects, mBuffers.instanceIndex, mBuffers.meshIndex, mBuffers.batchTableIndex, mBuffers.culledCommandIndex,
+				mBuffers.culledCountIndex, mBuffers.culledCommands.handle, mBuffers.culledCounts.handle};
+	}
+
+	bool VulkanGpuScene::IsReady() const
+	{
+		return !mBuffers.batches.empty() && mpUploadManager->IsComplete(mBuffers.upload);
+	}
+
+	void VulkanGpuScene::Record(VkCommandBuffer commandBuffer, VulkanPipelineManager *pipelineManager) const
+	{
+		if (!IsReady())
+			return;
+
+		vkCmdBindIndexBuffer(commandBuffer, mBuffers.indices.handle, 0, VK_INDEX_TYPE_UINT32);
+		mpBindlessHeap->PushConstants(commandBuffer, mConstants);
+
+		const VulkanBuffer &commands = mCulled ? mBuffers.culledCommands : mBuffers.commands;
+		const VulkanBuffer &counts = mCulled ? mBuffers.culledCounts : mBuffers.counts;
+
+		for (u32 i = 0; i < mBuffers.batches.size(); ++i)
+		{
+			const Batch &batch = mBuffers.batches[i];
+			VkPipeline pipeline = pipelineManager->Get(batch.pipeline);
+			if (pipeline == VK_NULL_HANDLE)
+				continue;
+
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+			vkCmdDrawIndexedIndirectCount(commandBuffer, commands.handle, batch.firstCommand * sizeof(VkDrawIndexedIndirectCommand),
+										  counts.handle, i * sizeof(u32), batch.commandCount, sizeof(VkDrawIndexedIndirectCommand));
+		}
+	}
+}
@@ -0,0 +1,210 @@
+#pragma once
+#include "Defines.h"
+#include "VulkanBuffer.h"
+#include "VulkanBindlessHeap.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanPipelineManager.h"
+#include "VulkanUploadManager.h"
+
+namespace Vkr
+{
+    // Vertex layout of scene meshes, read by the shaders from a storage buffer.
+    struct SceneVertex
+    {
+        f32 position[3];
+        f32 normal[3];
+        f32 uv[2];
+    };
+
+    using MeshId = u32;
+
+    struct SceneObject
+    {
+        f32 transform[16];          // Object to world, column-major.
+        MeshId mesh;
+        u32 material;               // Index into the material buffer.
+        PipelineHandle pipeline;    // Pipeline the object is drawn with; objects sharing one are drawn with one call.
+    };
+
+    // Push constants of scene pipelines, laid out as the SceneConstants block of the shaders.
+    struct SceneDrawConstants
+    {
+        f32 viewProjection[16];
+        BindlessIndex vertexBuffer;
+        BindlessIndex instanceBuffer;
+        BindlessIndex meshBuffer;
+        BindlessIndex materialBuffer;
+    };
+
+    // Buffers a culling pass reads the scene from and writes the draws to, by bindless index.
+    struct SceneCullTargets
+    {
+        u32 objectCount;
+        BindlessIndex instanceBuffer;       // Per object transform, mesh and batch.
+        BindlessIndex meshBuffer;           // Per mesh draw arguments and bounding sphere.
+        BindlessIndex batchBuffer;          // Per batch index of its first command.
+        BindlessIndex commandBuffer;        // Receives the visible objects' commands, packed at the start of each batch.
+        BindlessIndex countBuffer;          // Receives the number of visible objects per batch; must be zeroed first.
+        VkBuffer commands;                  // The command buffer, for synchronizing with the draws reading it.
+        VkBuffer counts;                    // The count buffer, for clearing it.
+    };
+
+    struct SceneStats
+    {
+        u32 meshes{};
+        u32 objects{};
+        u32 batches{};              // Indirect draws recorded per frame, one per pipeline.
+    };
+
+    // Opaque geometry drawn GPU-driven: per-object data lives in GPU buffers, written once when the scene is built, and
+    // every object is drawn through indirect commands, one vkCmdDrawIndexedIndirectCount per pipeline. Recording a frame
+    // costs the same however many objects there are.
+    //
+    // Meshes share one vertex and one index buffer. Objects are sorted by pipeline; each pipeline's objects are a contiguous
+    // range of the indirect buffer, and its draw count is read from the count buffer, so anything that writes the
+    // commands and counts on the GPU can take over from the CPU. With culling enabled the draws come from a second pair
+    // of buffers, which a culling pass fills with the visible objects every frame (see VulkanGpuCuller).
+    class VulkanGpuScene
+    {
+    public:
+        VulkanGpuScene() = default;
+        ~VulkanGpuScene() = default;
+
+        VulkanGpuScene(const VulkanGpuScene &) = delete;
+        void operator=(VulkanGpuScene const &) = delete;
+
+        /**
+         * Prepares the scene for use.
+         * @param device The logical device, with drawIndirectCount and drawIndirectFirstInstance enabled.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param memoryAllocator Allocator the scene buffers are allocated from.
+         * @param uploadManager Uploads the scene buffers.
+         * @param bindlessHeap Heap the storage buffers are registered in.
+         */
+        void Initialize(VkDevice device, const VkAllocationCallbacks *allocator, VulkanMemoryAllocator *memoryAllocator,
+                        VulkanUploadManager *uploadManager, VulkanBindlessHeap *bindlessHeap);
+
+        // Destroys the scene buffers. The device must be idle.
+        void Shutdown();
+
+        /**
+         * Adds a mesh, available to objects once the scene is built.
+         * @param vertices Vertices of the mesh.
+         * @param indices Triangle list indices, relative to the mesh's first vertex.
+         */
+        MeshId AddMesh(const SceneVertex *vertices, u32 vertexCount, const u32 *indices, u32 indexCount);
+
+        // Adds an object, drawn once the scene is built.
+        void AddObject(const SceneObject &object);
+
+        // Removes every mesh and object. Drawn until the scene is built again.
+        void Clear();
+
+        // Uploads the meshes and objects at the next `Update`. Until the upload has completed the previous build is drawn.
+        inline void Build() { mBuildPending = true; }
+
+        /**
+         * Starts a pending build. Call once per frame, before the upload manager's update.
+         * @param deletionQueue Queue the previous build's buffers are retired through.
+         * @param frameNumber The frame being recorded.
+         */
+        void Update(VulkanDeletionQueue *deletionQueue, u64 frameNumber);
+
+        // Matrix transforming world space to clip space, column-major.
+        void SetViewProjection(const f32 viewProjection[16]);
+
+        // Storage buffer of materials the objects' material indices refer to.
+        inline void SetMaterialBuffer(BindlessIndex buffer) { mConstants.materialBuffer = buffer; }
+
+        // Whether the draws come from the culled buffers, which a culling pass must then fill every frame.
+        inline void SetCulled(bool culled) { mCulled = culled; }
+
+        [[nodiscard]] inline const f32 *GetViewProjection() const { return mConstants.viewProjection; }
+
+        // Buffers of the current build a culling pass works on. Only valid while the scene is ready.
+        [[nodiscard]] SceneCullTargets GetCullTargets() const;
+
+        /**
+         * Records the indirect draws of every pipeline. Objects whose pipeline is still compiling are skipped.
+         * @param commandBuffer Command buffer inside the main rendering instance, with the bindless set bound.
+         */
+        void Record(VkCommandBuffer commandBuffer, VulkanPipelineManager *pipelineManager) const;
+
+        // Whether a build has been uploaded and can be drawn.
+        [[nodiscard]] bool IsReady() const;
+
+        [[nodiscard]] inline SceneStats GetStats() const { return mStats; }
+
+    private:
+        // std430 layouts shared with the shaders.
+        struct GpuMesh
+        {
+            u32 indexCount;
+            u32 firstIndex;
+            i32 vertexOffset;
+            u32 pad;
+            f32 boundsCenter[3];
+            f32 boundsRadius;
+        };
+
+        struct GpuInstance
+        {
+            f32 transform[16];
+            u32 mesh;
+            u32 material;
+            u32 batch;                  // Batch the object is drawn in, for culling.
+            u32 pad;
+        };
+
+        // The objects drawn with one pipeline: a range of the indirect buffer, and their count in the count buffer.
+        struct Batch
+        {
+            PipelineHandle pipeline;
+            u32 firstCommand;
+            u32 commandCount;
+        };
+
+        // One uploaded build. Replaced as a whole by the next build.
+        struct Buffers
+        {
+            VulkanBuffer vertices{};
+            VulkanBuffer indices{};
+            VulkanBuffer meshes{};
+            VulkanBuffer instances{};
+            VulkanBuffer commands{};
+            VulkanBuffer counts{};
+            VulkanBuffer batchTable{};          // First command of each batch, for culling.
+            VulkanBuffer culledCommands{};      // Commands and counts of the visible objects, written by culling.
+            VulkanBuffer culledCounts{};
+            BindlessIndex vertexIndex = BINDLESS_INVALID_INDEX;
+            BindlessIndex meshIndex = BINDLESS_INVALID_INDEX;
+            BindlessIndex instanceIndex = BINDLESS_INVALID_INDEX;
+            BindlessIndex batchTableIndex = BINDLESS_INVALID_INDEX;
+            BindlessIndex culledCommandIndex = BINDLESS_INVALID_INDEX;
+            BindlessIndex culledCountIndex = BINDLESS_INVALID_INDEX;
+            std::vector<Batch> batches;
+            UploadHandle upload{};      // Last upload of the build; the ones before it complete first.
+        };
+
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        VulkanMemoryAllocator *mpMemoryAllocator{};
+        VulkanUploadManager *mpUploadManager{};
+        VulkanBindlessHeap *mpBindlessHeap{};
+
+        std::vector<SceneVertex> mVertices;
+        std::vector<u32> mIndices;
+        std::vector<GpuMesh> mMeshes;
+        std::vector<SceneObject> mObjects;
+        bool mBuildPending = false;
+        bool mCulled = false;
+
+        Buffers mBuffers;
+        SceneDrawConstants mConstants{};
+        SceneStats mStats{};
+
+        StatusCode BuildBuffers(Buffers *outBuffers);
+        StatusCode CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VulkanBuffer *outBuffer);
+        void DestroyBuffers(Buffers *buffers);
+    };
+}
@@ -0,0 +1,253 @@
+#include "VulkanHostAllocator.h"
+
+namespace Vkr
+{
+    constexpr size_t SMALLEST_SIZE_CLASS = 32;
+    constexpr size_t SLAB_SIZE = 64 * 1024;
+    constexpr u32 LARGE_ALLOCATION = ~0u;           // Size class of allocations served by the system allocator.
+
+    // Stored right in front of every pointer handed to the driver.
+    struct AllocationHeader
+    {
+        void *base;         // Start of the chunk the allocation lives in.
+        u64 size;           // Size the driver asked for.
+        u32 sizeClass;      // Pool the chunk belongs to, or `LARGE_ALLOCATION`.
+        u32 scope;          // Scope the allocation is accounted to.
+    };
+
+    static const char *ScopeName(u32 scope)
+    {
+        switch (scope)
+        {
+            case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND: return "Command";
+            case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT: return "Object";
+            case VK_SYSTEM_ALLOCATION_SCOPE_CACHE: return "Cache";
+            case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE: return "Device";
+            case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE: return "Instance";
+            default: return "Unknown";
+        }
+    }
+
+    VulkanHostAllocator::VulkanHostAllocator()
+    {
+        mCallbacks.pUserData = this;
+        mCallbacks.pfnAllocation = OnAllocation;
+        mCallbacks.pfnReallocation = OnReallocation;
+        mCallbacks.pfnFree = OnFree;
+        mCallbacks.pfnInternalAllocation = OnInternalAllocation;
+        mCallbacks.pfnInternalFree = OnInternalFree;
+    }
+
+    VulkanHostAllocator::~VulkanHostAllocator()
+    {
+        // Every Vulkan object is gone by now, so nothing still points into the slabs.
+        for (auto &pool : mPools)
+        {
+            for (void *slab : pool.slabs)
+            {
+                std::free(slab);
+            }
+        }
+    }
+
+    void *VulkanHostAllocator::Allocate(size_t size, size_t alignment, VkSystemAllocationScope scope)
+    {
+        if (size == 0)
+            return nullptr;
+
+        // Room for the header, and for moving the pointer up to the requested alignment after it.
+        alignment = VMAX(alignment, alignof(AllocationHeader));
+        size_t totalSize = size + sizeof(AllocationHeader) + alignment - 1;
+
+        if (mByteLimit != 0 && mTotalBytes.load(std::memory_order_relaxed) + size > mByteLimit)
+        {
+            VWARN("Vulkan host allocation of %zu bytes refused; the %llu byte limit is reached.", size, mByteLimit)
+            return nullptr;
+        }
+
+        u32 sizeClass = 0;
+        while (sizeClass < SIZE_CLASS_COUNT && (SMALLEST_SIZE_CLASS << sizeClass) < totalSize)
+            ++sizeClass;
+
+        void *base;
+        if (sizeClass < SIZE_CLASS_COUNT)
+        {
+            base = AllocateChunk(sizeClass);
+        }
+        else
+        {
+            sizeClass = LARGE_ALLOCATION;
+            base = std::malloc(totalSize);
+        }
+
+        if (!base)
+            return nullptr;
+
+        uintptr_t address = reinterpret_cast<uintptr_t>(base) + sizeof(AllocationHeader);
+        address = (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+        auto *header = reinterpret_cast<AllocationHeader *>(address) - 1;
+        header->base = base;
+        header->size = size;
+        header->sizeClass = sizeClass;
+        header->scope = scope < SCOPE_COUNT ? scope : VK_SYSTEM_ALLOCATION_SCOPE_OBJECT;
+
+        ScopeCounters &counters = mScopes[header->scope];
+        u64 current = counters.currentBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        counters.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+        counters.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+        mTotalBytes.fetch_add(size, std::memory_order_relaxed);
+
+        u64 peak = counters.peakBytes.load(std::memory_order_relaxed);
+        while (current > peak && !counters.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed));
+
+        return reinterpret_cast<void *>(address);
+    }
+
+    void *VulkanHostAllocator::Reallocate(void *original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+    {
+        if (!original)
+            return Allocate(size, alignment, scope);
+
+        if (size == 0)
+        {
+            Free(original);
+            return nullptr;
+        }
+
+        auto *header = static_cast<AllocationHeader *>(original) - 1;
+
+        // Shrinking, or growing within the chunk, is free as long as the alignment still holds.
+        if (header->sizeClass != LARGE_ALLOCATION && reinterpret_cast<uintptr_t>(original) % alignment == 0)
+        {
+            size_t available = (SMALLEST_SIZE_CLASS << header->sizeClass) -
+                               (static_cast<u8 *>(original) - static_cast<u8 *>(header->base));
+            if (size <= available)
+            {
+                ScopeCounters &counters = mScopes[header->scope];
+                const u64 current = counters.currentBytes.fetch_add(size - header->size, std::memory_order_relaxed) + size - header->size;
+                counters.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+                mTotalBytes.fetch_add(size - header->size, std::memory_order_relaxed);
+                header->size = size;
+
+                u64 peak = counters.peakBytes.load(std::memory_order_relaxed);
+                while (current > peak && !counters.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed));
+
+                return original;
+            }
+        }
+
+        void *memory = Allocate(size, alignment, scope);
+        if (!memory)
+            return nullptr;     // The original allocation stays valid, as the spec requires.
+
+        std::memcpy(memory, original, VMIN(size, header->size));
+        Free(original);
+        return memory;
+    }
+
+    void VulkanHostAllocator::Free(void *memory)
+    {
+        if (!memory)
+            return;
+
+        auto *header = static_cast<AllocationHeader *>(memory) - 1;
+
+        ScopeCounters &counters = mScopes[header->scope];
+        counters.currentBytes.fetch_sub(header->size, std::memory_order_relaxed);
+        counters.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+        mTotalBytes.fetch_sub(header->size, std::memory_order_relaxed);
+
+        if (header->sizeClass == LARGE_ALLOCATION)
+            std::free(header->base);
+        else
+            FreeChunk(header->sizeClass, header->base);
+    }
+
+    void *VulkanHostAllocator::AllocateChunk(u32 sizeClass)
+    {
+        SizeClassPool &pool = mPools[sizeClass];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        if (!pool.freeList)
+        {
+            // Out of chunks; carve a new slab into chunks and put all of them on the free list.
+            size_t chunkSize = SMALLEST_SIZE_CLASS << sizeClass;
+            auto *slab = static_cast<u8 *>(std::malloc(SLAB_SIZE));
+            if (!slab)
+                return nullptr;
+
+            pool.slabs.push_back(slab);
+            for (size_t offset = 0; offset + chunkSize <= SLAB_SIZE; offset += chunkSize)
+            {
+                *reinterpret_cast<void **>(slab + offset) = pool.freeList;
+                pool.freeList = slab + offset;
+            }
+        }
+
+        void *chunk = pool.freeList;
+        pool.freeList = *static_cast<void **>(chunk);
+        return chunk;
+    }
+
+    void VulkanHostAllocator::FreeChunk(u32 sizeClass, void *chunk)
+    {
+        SizeClassPool &pool = mPools[sizeClass];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        *static_cast<void **>(chunk) = pool.freeList;
+        pool.freeList = chunk;
+    }
+
+    VulkanHostScopeStats VulkanHostAllocator::GetStats(VkSystemAllocationScope scope) const
+    {
+        const ScopeCounters &counters = mScopes[scope];
+
+        VulkanHostScopeStats stats;
+        stats.currentBytes = counters.currentBytes.load(std::memory_order_relaxed);
+        stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+        stats.liveAllocations = counters.liveAllocations.load(std::memory_order_relaxed);
+        stats.totalAllocations = counters.totalAllocations.load(std::memory_order_relaxed);
+        stats.internalBytes = counters.internalBytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void VulkanHostAllocator::LogStats() const
+    {
+        VDEBUG("Vulkan host memory: %.2f KiB in use.", mTotalBytes.load(std::memory_order_relaxed) / 1024.0)
+        for (u32 scope = 0; scope < SCOPE_COUNT; ++scope)
+        {
+            VulkanHostScopeStats stats = GetStats(static_cast<VkSystemAllocationScope>(scope));
+            VDEBUG("\t%s: %.2f KiB in %llu allocations, %.2f KiB peak, %llu allocations total, %.2f KiB internal.",
+                   ScopeName(scope), stats.currentBytes / 1024.0, stats.liveAllocations, stats.peakBytes / 1024.0,
+                   stats.totalAllocations, stats.internalBytes / 1024.0)
+        }
+    }
+
+    void *VulkanHostAllocator::OnAllocation(void *userData, size_t size, size_t alignment, VkSystemAllocationScope scope)
+    {
+        return static_cast<VulkanHostAllocator *>(userData)->Allocate(size, alignment, scope);
+    }
+
+    void *VulkanHostAllocator::OnReallocation(void *userData, void *original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+    {
+        return static_cast<VulkanHostAllocator *>(userData)->Reallocate(original, size, alignment, scope);
+    }
+
+    void VulkanHostAllocator::OnFree(void *userData, void *memory)
+    {
+        static_cast<VulkanHostAllocator *>(userData)->Free(memory);
+    }
+
+    void VulkanHostAllocator::OnInternalAllocation(void *userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope scope)
+    {
+        auto *allocator = static_cast<VulkanHostAllocator *>(userData);
+        allocator->mScopes[scope < SCOPE_COUNT ? scope : VK_SYSTEM_ALLOCATION_SCOPE_OBJECT].internalBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void VulkanHostAllocator::OnInternalFree(void *userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope scope)
+    {
+        auto *allocator = static_cast<VulkanHostAllocator *>(userData);
+        allocator->mScopes[scope < SCOPE_COUNT ? scope : VK_SYSTEM_ALLOCATION_SCOPE_OBJECT].internalBytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "Defines.h"
+#include <atomic>
+#include <mutex>
+
+namespace Vkr
+{
+    // Host memory usage of one `VkSystemAllocationScope`.
+    struct VulkanHostScopeStats
+    {
+        u64 currentBytes{};         // Bytes currently allocated.
+        u64 peakBytes{};            // Highest `currentBytes` seen.
+        u64 liveAllocations{};      // Allocations currently alive.
+        u64 totalAllocations{};     // Allocations made so far, including reallocations.
+        u64 internalBytes{};        // Bytes the driver reports allocating by itself (e.g. executable memory).
+    };
+
+    // Engine implementation of `VkAllocationCallbacks`. Small allocations are served from size-class pools, so the
+    // driver's many short lived allocations (pipeline and swapchain creation, mostly) don't each hit malloc, and every
+    // allocation is accounted for per allocation scope.
+    class VulkanHostAllocator
+    {
+    public:
+        VulkanHostAllocator();
+        ~VulkanHostAllocator();
+
+        VulkanHostAllocator(const VulkanHostAllocator &) = delete;
+        void operator=(VulkanHostAllocator const &) = delete;
+
+        // Callbacks to pass to every vkCreate*/vkDestroy* call. Valid for the lifetime of the allocator.
+        [[nodiscard]] inline VkAllocationCallbacks *GetCallbacks() { return &mCallbacks; }
+
+        /**
+         * Caps the total bytes the driver may allocate through these callbacks. Allocations past the cap fail,
+         * which the driver reports as VK_ERROR_OUT_OF_HOST_MEMORY.
+         * @param limit The cap in bytes, 0 for none.
+         */
+        inline void SetByteLimit(u64 limit) { mByteLimit = limit; }
+
+        [[nodiscard]] VulkanHostScopeStats GetStats(VkSystemAllocationScope scope) const;
+
+        // Logs the usage of every allocation scope.
+        void LogStats() const;
+
+    private:
+        static constexpr u32 SCOPE_COUNT = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+        static constexpr u32 SIZE_CLASS_COUNT = 9;      // 32 bytes to 8 KiB, doubling.
+
+        struct ScopeCounters
+        {
+            std::atomic<u64> currentBytes{};
+            std::atomic<u64> peakBytes{};
+            std::atomic<u64> liveAllocations{};
+            std::atomic<u64> totalAllocations{};
+            std::atomic<u64> internalBytes{};
+        };
+
+        // Fixed size chunks carved out of larger slabs. Freed chunks go onto an intrusive free list.
+        struct SizeClassPool
+        {
+            std::mutex mutex;
+            void *freeList{};
+            std::vector<void *> slabs;
+        };
+
+        VkAllocationCallbacks mCallbacks{};
+        std::array<ScopeCounters, SCOPE_COUNT> mScopes;
+        std::array<SizeClassPool, SIZE_CLASS_COUNT> mPools;
+        std::atomic<u64> mTotalBytes{};
+        u64 mByteLimit{};
+
+        void *Allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+        void *Reallocate(void *original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+        void Free(void *memory);
+
+        void *AllocateChunk(u32 sizeClass);
+        void FreeChunk(u32 sizeClass, void *chunk);
+
+        static void *VKAPI_PTR OnAllocation(void *userData, size_t size, size_t alignment, VkSystemAllocationScope scope);
+        static void *VKAPI_PTR OnReallocation(void *userData, void *original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+        static void VKAPI_PTR OnFree(void *userData, void *memory);
+        static void VKAPI_PTR OnInternalAllocation(void *userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+        static void VKAPI_PTR OnInternalFree(void *userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+    };
+}
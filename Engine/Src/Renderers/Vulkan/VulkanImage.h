@@ -1,14 +1,17 @@
 #pragma once
 #include "Defines.h"
+#include "VulkanMemoryAllocator.h"
 
 namespace Vkr
 {
     struct VulkanImage
     {
         VkImage handle;
-        VkDeviceMemory memory;
+        VulkanAllocation allocation;
         VkImageView view;
         u32 width;
         u32 height;
+        u32 mipLevels;
+        u32 arrayLayers;
     };
 }
\ No newline at end of file
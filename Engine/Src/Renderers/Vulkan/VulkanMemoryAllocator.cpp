@@ -0,0 +1,393 @@
+#include "VulkanMemoryAllocator.h"
+
+namespace Vkr
+{
+    // Block size for heaps larger than `SMALL_HEAP_SIZE`.
+    constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 256ull * 1024 * 1024;
+    // Heaps up to this size (e.g. the 256 MiB host visible device local heap) use an eighth of the heap per block.
+    constexpr VkDeviceSize SMALL_HEAP_SIZE = 1024ull * 1024 * 1024;
+
+    struct VulkanMemoryBlock
+    {
+        struct Range
+        {
+            VkDeviceSize offset;
+            VkDeviceSize size;
+        };
+
+        VkDeviceMemory memory{};
+        VkDeviceSize size{};
+        void *mapped{};                   // Persistently mapped pointer, if the memory is host visible.
+        u32 memoryType{};
+        u32 allocationCount{};
+        std::vector<Range> freeRanges;    // Free ranges ordered by offset. Adjacent ranges are always merged.
+    };
+
+    static inline VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Defined here, where `VulkanMemoryBlock` is complete.
+    VulkanMemoryAllocator::VulkanMemoryAllocator() = default;
+    VulkanMemoryAllocator::~VulkanMemoryAllocator() = default;
+
+    void VulkanMemoryAllocator::Initialize(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks *allocator)
+    {
+        mDevice = device;
+        mAllocator = allocator;
+
+        // Memory properties never change, so they are queried once rather than per allocation.
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &mMemoryProperties);
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        mBufferImageGranularity = VMAX(properties.limits.bufferImageGranularity, 1);
+        mNonCoherentAtomSize = VMAX(properties.limits.nonCoherentAtomSize, 1);
+        mMaxAllocationCount = properties.limits.maxMemoryAllocationCount;
+    }
+
+    void VulkanMemoryAllocator::Shutdown()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        for (auto &blocks : mBlocks)
+        {
+            for (auto &block : blocks)
+            {
+                if (block->allocationCount != 0)
+                    VWARN("Destroying a memory block with %u live allocations.", block->allocationCount)
+
+                vkFreeMemory(mDevice, block->memory, mAllocator);
+            }
+
+            blocks.clear();
+        }
+
+        mHeapStats = {};
+        mDeviceAllocationCount = 0;
+    }
+
+    StatusCode VulkanMemoryAllocator::AllocateImageMemory(VkImage image, VkMemoryPropertyFlags propertyFlags, VulkanAllocation *outAllocation)
+    {
+        VkImageMemoryRequirementsInfo2 requirementsInfo{VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2};
+        requirementsInfo.image = image;
+
+        VkMemoryDedicatedRequirements dedicatedRequirements{VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS};
+        VkMemoryRequirements2 requirements{VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
+        requirements.pNext = &dedicatedRequirements;
+        vkGetImageMemoryRequirements2(mDevice, &requirementsInfo, &requirements);
+
+        bool dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+        StatusCode statusCode = Allocate(requirements.memoryRequirements, propertyFlags, dedicated, image, VK_NULL_HANDLE, outAllocation);
+        RETURN_ON_FAIL(statusCode)
+
+        VK_CHECK(vkBindImageMemory(mDevice, image, outAllocation->memory, outAllocation->offset))
+        return StatusCode::Successful;
+    }
+
+    StatusCode VulkanMemoryAllocator::AllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags propertyFlags, VulkanAllocation *outAllocation)
+    {
+        VkBufferMemoryRequirementsInfo2 requirementsInfo{VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2};
+        requirementsInfo.buffer = buffer;
+
+        VkMemoryDedicatedRequirements dedicatedRequirements{VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS};
+        VkMemoryRequirements2 requirements{VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
+        requirements.pNext = &dedicatedRequirements;
+        vkGetBufferMemoryRequirements2(mDevice, &requirementsInfo, &requirements);
+
+        bool dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+        StatusCode statusCode = Allocate(requirements.memoryRequirements, propertyFlags, dedicated, VK_NULL_HANDLE, buffer, outAllocation);
+        RETURN_ON_FAIL(statusCode)
+
+        VK_CHECK(vkBindBufferMemory(mDevice, buffer, outAllocation->memory, outAllocation->offset))
+        return StatusCode::Successful;
+    }
+
+    StatusCode VulkanMemoryAllocator::AllocateMemory(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags propertyFlags,
+                                                     VulkanAllocation *outAllocation)
+    {
+        return Allocate(requirements, propertyFlags, false, VK_NULL_HANDLE, VK_NULL_HANDLE, outAllocation);
+    }
+
+    StatusCode VulkanMemoryAllocator::Allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags propertyFlags, bool dedicated,
+                                               VkImage dedicatedImage, VkBuffer dedicatedBuffer, VulkanAllocation *outAllocation)
+    {
+        i32 memoryType = FindMemoryType(requirements.memoryTypeBits, propertyFlags);
+        if (memoryType == -1)
+        {
+            VERROR("Required memory type not found.")
+            return StatusCode::VulkanNoSuitableMemoryType;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // Resources taking up a large part of a block (render targets, mostly) would only fragment it. Lazily allocated
+        // memory is committed per memory object, so sharing a block would commit it for all of them.
+        VkDeviceSize blockSize = GetBlockSize(memoryType);
+        const bool lazy = mMemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+        if (dedicated || lazy || requirements.size > blockSize / 2)
+            return AllocateDedicated(requirements, memoryType, dedicatedImage, dedicatedBuffer, outAllocation);
+
+        // Neighbouring linear and optimal resources must be `bufferImageGranularity` apart, and flushes of non
+        // coherent memory operate on whole atoms. Aligning every range to both keeps them from ever sharing one.
+        VkDeviceSize alignment = VMAX(requirements.alignment, mBufferImageGranularity);
+        if (!(mMemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+            alignment = VMAX(alignment, mNonCoherentAtomSize);
+
+        VkDeviceSize size = AlignUp(requirements.size, alignment);
+
+        // Best fit across every block of the memory type.
+        VulkanMemoryBlock *bestBlock = nullptr;
+        size_t bestRange = 0;
+        VkDeviceSize bestWaste = ~0ull;
+
+        for (auto &block : mBlocks[memoryType])
+        {
+            for (size_t i = 0; i < block->freeRanges.size(); ++i)
+            {
+                const auto &range = block->freeRanges[i];
+                VkDeviceSize padding = AlignUp(range.offset, alignment) - range.offset;
+                if (padding + size > range.size)
+                    continue;
+
+                VkDeviceSize waste = range.size - size;
+                if (waste < bestWaste)
+                {
+                    bestBlock = block.get();
+                    bestRange = i;
+                    bestWaste = waste;
+                }
+            }
+        }
+
+        if (!bestBlock)
+        {
+            auto block = std::make_unique<VulkanMemoryBlock>();
+            block->size = blockSize;
+            block->memoryType = memoryType;
+
+            // A heap too full for another block may still have room for the resource alone.
+            StatusCode statusCode = AllocateDeviceMemory(memoryType, blockSize, nullptr, &block->memory, &block->mapped);
+            if (statusCode != StatusCode::Successful)
+                return AllocateDedicated(requirements, memoryType, dedicatedImage, dedicatedBuffer, outAllocation);
+
+            block->freeRanges.push_back({0, blockSize});
+            mHeapStats[mMemoryProperties.memoryTypes[memoryType].heapIndex].blockCount++;
+
+            bestBlock = block.get();
+            bestRange = 0;
+            mBlocks[memoryType].push_back(std::move(block));
+        }
+
+        // Carve the allocation out of the range. Alignment padding in front of it stays a free range of its own.
+        auto &freeRanges = bestBlock->freeRanges;
+        VulkanMemoryBlock::Range range = freeRanges[bestRange];
+        VkDeviceSize offset = AlignUp(range.offset, alignment);
+        VkDeviceSize padding = offset - range.offset;
+        VkDeviceSize remaining = range.size - padding - size;
+
+        if (padding != 0 && remaining != 0)
+        {
+            freeRanges[bestRange] = {range.offset, padding};
+            freeRanges.insert(freeRanges.begin() + (i64)bestRange + 1, {offset + size, remaining});
+        }
+        else if (padding != 0)
+        {
+            freeRanges[bestRange] = {range.offset, padding};
+        }
+        else if (remaining != 0)
+        {
+            freeRanges[bestRange] = {offset + size, remaining};
+        }
+        else
+        {
+            freeRanges.erase(freeRanges.begin() + (i64)bestRange);
+        }
+
+        bestBlock->allocationCount++;
+
+        VulkanHeapStats &stats = mHeapStats[mMemoryProperties.memoryTypes[memoryType].heapIndex];
+        stats.usedBytes += size;
+        stats.allocationCount++;
+
+        outAllocation->memory = bestBlock->memory;
+        outAllocation->offset = offset;
+        outAllocation->size = size;
+        outAllocation->mapped = bestBlock->mapped ? static_cast<u8 *>(bestBlock->mapped) + offset : nullptr;
+        outAllocation->memoryType = memoryType;
+        outAllocation->block = bestBlock;
+
+        return StatusCode::Successful;
+    }
+
+    StatusCode VulkanMemoryAllocator::AllocateDedicated(const VkMemoryRequirements &requirements, u32 memoryType, VkImage image,
+                                                        VkBuffer buffer, VulkanAllocation *outAllocation)
+    {
+        // Tells the driver what the memory is for, which lets it place e.g. render targets optimally.
+        VkMemoryDedicatedAllocateInfo dedicatedInfo{VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO};
+        dedicatedInfo.image = image;
+        dedicatedInfo.buffer = buffer;
+
+        StatusCode statusCode = AllocateDeviceMemory(memoryType, requirements.size, &dedicatedInfo, &outAllocation->memory, &outAllocation->mapped);
+        RETURN_ON_FAIL(statusCode)
+
+        VulkanHeapStats &stats = mHeapStats[mMemoryProperties.memoryTypes[memoryType].heapIndex];
+        stats.usedBytes += requirements.size;
+        stats.allocationCount++;
+
+        outAllocation->offset = 0;
+        outAllocation->size = requirements.size;
+        outAllocation->memoryType = memoryType;
+        outAllocation->block = nullptr;
+
+        return StatusCode::Successful;
+    }
+
+    StatusCode VulkanMemoryAllocator::AllocateDeviceMemory(u32 memoryType, VkDeviceSize size, const void *pNext, VkDeviceMemory *outMemory, void **outMapped)
+    {
+        if (mDeviceAllocationCount >= mMaxAllocationCount)
+        {
+            VERROR("Device memory allocation limit of %u reached.", mMaxAllocationCount)
+            return StatusCode::VulkanOutOfDeviceMemory;
+        }
+
+        VkMemoryAllocateInfo allocateInfo{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        allocateInfo.pNext = pNext;
+        allocateInfo.allocationSize = size;
+        allocateInfo.memoryTypeIndex = memoryType;
+
+        VkResult result = vkAllocateMemory(mDevice, &allocateInfo, mAllocator, outMemory);
+        if (result != VK_SUCCESS)
+        {
+            VERROR("Failed to allocate %llu bytes of device memory from memory type %u.", (unsigned long long)size, memoryType)
+            return StatusCode::VulkanOutOfDeviceMemory;
+        }
+
+        // Host visible memory stays mapped for its whole lifetime; mapping is not free and ranges are mapped often.
+        *outMapped = nullptr;
+        if (mMemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            result = vkMapMemory(mDevice, *outMemory, 0, VK_WHOLE_SIZE, 0, outMapped);
+            if (result != VK_SUCCESS)
+            {
+                VERROR("Failed to map %llu bytes of memory type %u (VkResult %d).", (unsigned long long)size, memoryType, result)
+                vkFreeMemory(mDevice, *outMemory, mAllocator);
+                *outMemory = VK_NULL_HANDLE;
+                *outMapped = nullptr;
+                return StatusCode::VulkanMemoryMapFailed;
+            }
+        }
+
+        mDeviceAllocationCount++;
+        mHeapStats[mMemoryProperties.memoryTypes[memoryType].heapIndex].reservedBytes += size;
+
+        return StatusCode::Successful;
+    }
+
+    void VulkanMemoryAllocator::Free(VulkanAllocation *allocation)
+    {
+        if (!allocation->memory)
+            return;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        VulkanAllocation freed = *allocation;
+        *allocation = {};
+
+        u32 memoryType = freed.memoryType;
+        VulkanHeapStats &stats = mHeapStats[mMemoryProperties.memoryTypes[memoryType].heapIndex];
+        stats.usedBytes -= freed.size;
+        stats.allocationCount--;
+
+        VulkanMemoryBlock *block = freed.block;
+        if (!block)
+        {
+            // Dedicated allocation; release the memory straight away. Unmapping is implicit.
+            vkFreeMemory(mDevice, freed.memory, mAllocator);
+            stats.reservedBytes -= freed.size;
+            mDeviceAllocationCount--;
+            return;
+        }
+
+        // Return the range, merging it with the free ranges on either side.
+        auto &freeRanges = block->freeRanges;
+        VulkanMemoryBlock::Range range = {freed.offset, freed.size};
+        auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), range.offset,
+                                     [](const VulkanMemoryBlock::Range &r, VkDeviceSize offset) { return r.offset < offset; });
+
+        if (next != freeRanges.end() && range.offset + range.size == next->offset)
+        {
+            range.size += next->size;
+            next = freeRanges.erase(next);
+        }
+
+        if (next != freeRanges.begin() && (next - 1)->offset + (next - 1)->size == range.offset)
+            (next - 1)->size += range.size;
+        else
+            freeRanges.insert(next, range);
+
+        block->allocationCount--;
+
+        // Keep a single empty block per memory type around, so a resource being recreated doesn't cost an allocation.
+        if (block->allocationCount == 0)
+        {
+            auto &blocks = mBlocks[memoryType];
+            bool otherEmptyBlock = std::any_of(blocks.begin(), blocks.end(), [block](const auto &b)
+            {
+                return b.get() != block && b->allocationCount == 0;
+            });
+
+            if (otherEmptyBlock)
+            {
+                vkFreeMemory(mDevice, block->memory, mAllocator);
+                stats.reservedBytes -= block->size;
+                stats.blockCount--;
+                mDeviceAllocationCount--;
+
+                blocks.erase(std::find_if(blocks.begin(), blocks.end(), [block](const auto &b) { return b.get() == block; }));
+            }
+        }
+    }
+
+    i32 VulkanMemoryAllocator::FindMemoryType(u32 typeFilter, VkMemoryPropertyFlags propertyFlags) const
+    {
+        for (u32 i = 0; i < mMemoryProperties.memoryTypeCount; ++i)
+        {
+            // Check each memory type to see if its bit is set to 1.
+            if (typeFilter & (1 << i) && (mMemoryProperties.memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags)
+            {
+                return (i32)i;
+            }
+        }
+
+        VWARN("Unable to find suitable memory type!")
+        return -1;
+    }
+
+    VulkanHeapStats VulkanMemoryAllocator::GetHeapStats(u32 heapIndex) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mHeapStats[heapIndex];
+    }
+
+    void VulkanMemoryAllocator::LogStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        VDEBUG("Device memory: %u of %u allocations in use.", mDeviceAllocationCount, mMaxAllocationCount)
+        for (u32 i = 0; i < mMemoryProperties.memoryHeapCount; ++i)
+        {
+            const VulkanHeapStats &stats = mHeapStats[i];
+            VDEBUG("\tHeap %u: %.2f of %.2f MiB used by %u allocations, %u blocks, %.2f MiB heap.", i,
+                   stats.usedBytes / (1024.0 * 1024.0), stats.reservedBytes / (1024.0 * 1024.0),
+                   stats.allocationCount, stats.blockCount, mMemoryProperties.memoryHeaps[i].size / (1024.0 * 1024.0))
+        }
+    }
+
+    VkDeviceSize VulkanMemoryAllocator::GetBlockSize(u32 memoryType) const
+    {
+        VkDeviceSize heapSize = mMemoryProperties.memoryHeaps[mMemoryProperties.memoryTypes[memoryType].heapIndex].size;
+        return heapSize <= SMALL_HEAP_SIZE ? AlignUp(heapSize / 8, 32) : DEFAULT_BLOCK_SIZE;
+    }
+}
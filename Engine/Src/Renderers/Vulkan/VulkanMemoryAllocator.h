@@ -0,0 +1,113 @@
+#pragma once
+#include "Defines.h"
+#include "StatusCode.h"
+#include <mutex>
+
+namespace Vkr
+{
+    struct VulkanMemoryBlock;
+
+    // A range of device memory handed out by the `VulkanMemoryAllocator`.
+    struct VulkanAllocation
+    {
+        VkDeviceMemory memory{};            // Memory object the range lives in; shared with other allocations unless dedicated.
+        VkDeviceSize offset{};              // Offset of the range within `memory`.
+        VkDeviceSize size{};                // Size of the range.
+        void *mapped{};                     // Host pointer to the start of the range, if the memory is host visible.
+        u32 memoryType{};                   // Memory type index the range was allocated from.
+        VulkanMemoryBlock *block{};         // Block the range was sub-allocated from, null for dedicated allocations.
+    };
+
+    // Usage of a single memory heap.
+    struct VulkanHeapStats
+    {
+        VkDeviceSize reservedBytes{};       // Bytes of device memory allocated from the heap.
+        VkDeviceSize usedBytes{};           // Bytes of the reserved memory handed out to resources.
+        u32 blockCount{};                   // Number of shared blocks allocated from the heap.
+        u32 allocationCount{};              // Number of resources bound to memory of the heap.
+    };
+
+    // Sub-allocates device memory out of large blocks, one set of blocks per memory type, so resources no longer each
+    // cost a vkAllocateMemory call and the allocation count stays far below `maxMemoryAllocationCount`.
+    // Free ranges within a block are kept in offset order and coalesced on free; allocation picks the best fit.
+    // Large resources, and those the driver asks for, get a dedicated allocation instead.
+    class VulkanMemoryAllocator
+    {
+    public:
+        VulkanMemoryAllocator();
+        ~VulkanMemoryAllocator();
+
+        VulkanMemoryAllocator(const VulkanMemoryAllocator &) = delete;
+        void operator=(VulkanMemoryAllocator const &) = delete;
+
+        /**
+         * Prepares the allocator for use on a device.
+         * @param physicalDevice The device memory is allocated on.
+         * @param device The logical device memory is allocated through.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         */
+        void Initialize(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks *allocator);
+
+        // Releases every block. All allocations must have been freed.
+        void Shutdown();
+
+        /**
+         * Allocates memory for an image and binds it.
+         * @param image The image to back with memory.
+         * @param propertyFlags Properties the memory is required to have.
+         * @param outAllocation The allocation the image was bound to.
+         */
+        StatusCode AllocateImageMemory(VkImage image, VkMemoryPropertyFlags propertyFlags, VulkanAllocation *outAllocation);
+
+        /**
+         * Allocates memory for a buffer and binds it.
+         * @param buffer The buffer to back with memory.
+         * @param propertyFlags Properties the memory is required to have.
+         * @param outAllocation The allocation the buffer was bound to.
+         */
+        StatusCode AllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags propertyFlags, VulkanAllocation *outAllocation);
+
+        /**
+         * Allocates memory without binding anything, for resources that alias it.
+         * @param requirements Combined requirements of every resource bound to the memory.
+         * @param propertyFlags Properties the memory is required to have.
+         * @param outAllocation The allocation; resources are bound at its offset.
+         */
+        StatusCode AllocateMemory(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags propertyFlags, VulkanAllocation *outAllocation);
+
+        // Returns an allocation to its block, or releases it if it is dedicated. Resets the allocation.
+        void Free(VulkanAllocation *allocation);
+
+        /**
+         * Finds a memory type allowed by `typeFilter` with all of `propertyFlags`.
+         * @return The memory type index, or -1 if there isn't one.
+         */
+        [[nodiscard]] i32 FindMemoryType(u32 typeFilter, VkMemoryPropertyFlags propertyFlags) const;
+
+        [[nodiscard]] VulkanHeapStats GetHeapStats(u32 heapIndex) const;
+
+        // Logs the usage of every heap.
+        void LogStats() const;
+
+    private:
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        VkPhysicalDeviceMemoryProperties mMemoryProperties{};
+        VkDeviceSize mBufferImageGranularity = 1;
+        VkDeviceSize mNonCoherentAtomSize = 1;
+        u32 mMaxAllocationCount{};
+
+        std::array<std::vector<std::unique_ptr<VulkanMemoryBlock>>, VK_MAX_MEMORY_TYPES> mBlocks;
+        std::array<VulkanHeapStats, VK_MAX_MEMORY_HEAPS> mHeapStats{};
+        u32 mDeviceAllocationCount{};   // Number of live vkAllocateMemory allocations, blocks and dedicated.
+
+        mutable std::mutex mMutex;
+
+        StatusCode Allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags propertyFlags, bool dedicated,
+                            VkImage dedicatedImage, VkBuffer dedicatedBuffer, VulkanAllocation *outAllocation);
+        StatusCode AllocateDedicated(const VkMemoryRequirements &requirements, u32 memoryType, VkImage image,
+                                     VkBuffer buffer, VulkanAllocation *outAllocation);
+        StatusCode AllocateDeviceMemory(u32 memoryType, VkDeviceSize size, const void *pNext, VkDeviceMemory *outMemory, void **outMapped);
+        [[nodiscard]] VkDeviceSize GetBlockSize(u32 memoryType) const;
+    };
+}
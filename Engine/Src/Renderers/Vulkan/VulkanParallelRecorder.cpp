@@ -0,0 +1,168 @@
+#include "VulkanParallelRecorder.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace Vkr
+{
+	void VulkanParallelRecorder::Initialize(VkDevice device, const VkAllocationCallbacks *allocator, u32 queueFamilyIndex, u32 framesInFlight,
+											ThreadPool *threadPool, u32 minItemsPerSlice)
+	{
+		mDevice = device;
+		mAllocator = allocator;
+		mpThreadPool = threadPool;
+		mThreadCount = threadPool->GetWorkerCount() + 1;
+		mMinItemsPerSlice = VMAX(minItemsPerSlice, 1u);
+		mFrameIndex = 0;
+
+		mCommands.resize(framesInFlight * mThreadCount);
+		for (auto &commands : mCommands)
+		{
+			VkCommandPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.queueFamilyIndex = queueFamilyIndex;
+			poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			VK_CHECK(vkCreateCommandPool(mDevice, &poolInfo, mAllocator, &commands.pool))
+		}
+
+		VDEBUG("Recording on %u threads, %u command pools.", mThreadCount, (u32)mCommands.size())
+	}
+
+	void VulkanParallelRecorder::Shutdown()
+	{
+		for (auto &commands : mCommands)
+		{
+			vkDestroyCommandPool(mDevice, commands.pool, mAllocator);
+		}
+
+		mCommands.clear();
+		mStats = {};
+	}
+
+	void VulkanParallelRecorder::BeginFrame(u32 frameIndex)
+	{
+		mFrameIndex = frameIndex;
+		++mStats.frames;
+
+		for (u32 thread = 0; thread < mThreadCount; ++thread)
+		{
+			ThreadCommands &commands = mCommands[mFrameIndex * mThreadCount + thread];
+			if (commands.used == 0)
+				continue;
+
+			VK_CHECK(vkResetCommandPool(mDevice, commands.pool, 0))
+			commands.used = 0;
+		}
+	}
+
+	void VulkanParallelRecorder::Record(VkCommandBuffer primary, const VkCommandBufferInheritanceRenderingInfo &renderingInfo, u32 itemCount,
+										const RecordFunction &record)
+	{
+		if (itemCount == 0)
+			return;
+
+		auto start = std::chrono::steady_clock::now();
+
+		// Shared with the helper jobs. A helper may only start after every slice is taken, and then touches nothing but
+		// `next`; the rest is only used while `Record` waits for the slices.
+		struct Job
+		{
+			std::atomic<u32> next{};
+			u32 done{};
+			u32 sliceCount{};
+			u32 itemCount{};
+			const VkCommandBufferInheritanceRenderingInfo *renderingInfo{};
+			const RecordFunction *record{};
+			std::vector<VkCommandBuffer> slices;
+			std::mutex mutex;
+			std::condition_variable finished;
+		};
+
+		auto job = std::make_shared<Job>();
+		job->sliceCount = VMIN((itemCount + mMinItemsPerSlice - 1) / mMinItemsPerSlice, mThreadCount);
+		job->itemCount = itemCount;
+		job->renderingInfo = &renderingInfo;
+		job->record = &record;
+		job->slices.resize(job->sliceCount);
+
+		auto recordSlices = [this, job]()
+		{
+			for (u32 slice = job->next++; slice < job->sliceCount; slice = job->next++)
+			{
+				VkCommandBuffer commandBuffer = AcquireSecondary();
+
+				VkCommandBufferInheritanceInfo inheritanceInfo{};
+				inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+				inheritanceInfo.pNext = job->renderingInfo;
+
+				VkCommandBufferBeginInfo beginInfo{};
+				beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+				beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+				beginInfo.pInheritanceInfo = &inheritanceInfo;
+				VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo))
+
+				// Even split; slices differ by at most one item.
+				u32 first = (u32)((u64)slice * job->itemCount / job->sliceCount);
+				u32 end = (u32)((u64)(slice + 1) * job->itemCount / job->sliceCount);
+				(*job->record)(commandBuffer, first, end - first);
+
+				VK_CHECK(vkEndCommandBuffer(commandBuffer))
+				job->slices[slice] = commandBuffer;
+
+				std::lock_guard<std::mutex> lock(job->mutex);
+				if (++job->done == job->sliceCount)
+					job->finished.notify_one();
+			}
+		};
+
+		for (u32 i = 1; i < job->sliceCount; ++i)
+		{
+			mpThreadPool->Submit(recordSlices);
+		}
+
+		recordSlices();
+
+		std::unique_lock<std::mutex> lock(job->mutex);
+		job->finished.wait(lock, [&job]() { return job->done == job->sliceCount; });
+
+		vkCmdExecuteCommands(primary, job->sliceCount, job->slices.data());
+
+		mStats.items += itemCount;
+		mStats.slices += job->sliceCount;
+		mStats.recordMs += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void VulkanParallelRecorder::LogStats() const
+	{
+		if (mStats.frames == 0 || mStats.items == 0)
+			return;
+
+		VINFO("Recording: %llu items in %llu frames on %u threads, %.3f ms per frame, %.1f ns per item, %.1f slices per frame.",
+			  mStats.items, mStats.frames, mThreadCount, mStats.recordMs / mStats.frames, mStats.recordMs * 1e6 / mStats.items,
+			  (f64)mStats.slices / mStats.frames)
+	}
+
+	VkCommandBuffer VulkanParallelRecorder::AcquireSecondary()
+	{
+		// The calling thread records on the last pool.
+		i32 workerIndex = ThreadPool::GetCurrentWorkerIndex();
+		u32 thread = workerIndex < 0 ? mThreadCount - 1 : (u32)workerIndex;
+		ThreadCommands &commands = mCommands[mFrameIndex * mThreadCount + thread];
+
+		if (commands.used == commands.buffers.size())
+		{
+			VkCommandBufferAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.commandPool = commands.pool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			allocateInfo.commandBufferCount = 1;
+
+			VkCommandBuffer commandBuffer;
+			VK_CHECK(vkAllocateCommandBuffers(mDevice, &allocateInfo, &commandBuffer))
+			commands.buffers.push_back(commandBuffer);
+		}
+
+		return commands.buffers[commands.used++];
+	}
+}
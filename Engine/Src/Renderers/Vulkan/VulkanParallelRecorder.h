@@ -0,0 +1,95 @@
+#pragma once
+#include "Defines.h"
+#include "Core/Threading/ThreadPool.h"
+
+namespace Vkr
+{
+    struct RecorderStats
+    {
+        u64 frames{};               // Frames begun.
+        u64 items{};                // Items recorded.
+        u64 slices{};               // Secondary command buffers recorded.
+        f64 recordMs{};             // Time the recording thread spent in `Record`, including waiting for the slices.
+    };
+
+    // Records work into secondary command buffers on the thread pool.
+    //
+    // Every thread (the pool's workers, plus the thread calling `Record`) has its own command pool per frame in flight, so
+    // recording never contends on a pool, and a frame's pools are reset as a whole once the frame has completed. The items
+    // to record are split into contiguous slices, each recorded into its own secondary command buffer by whichever thread
+    // picks it up, and the primary command buffer executes the slices in item order, so the result does not depend on
+    // scheduling.
+    class VulkanParallelRecorder
+    {
+    public:
+        // Records items [first, first + count) into a secondary command buffer. Runs on any thread.
+        using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, u32 first, u32 count)>;
+
+        VulkanParallelRecorder() = default;
+        ~VulkanParallelRecorder() = default;
+
+        VulkanParallelRecorder(const VulkanParallelRecorder &) = delete;
+        void operator=(VulkanParallelRecorder const &) = delete;
+
+        /**
+         * Creates the command pools.
+         * @param device The logical device.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param queueFamilyIndex Family of the queue the primary command buffers are submitted to.
+         * @param framesInFlight Number of frames in flight; each has its own set of pools.
+         * @param threadPool Pool recording runs on.
+         * @param minItemsPerSlice Fewest items worth a secondary command buffer of their own.
+         */
+        void Initialize(VkDevice device, const VkAllocationCallbacks *allocator, u32 queueFamilyIndex, u32 framesInFlight,
+                        ThreadPool *threadPool, u32 minItemsPerSlice);
+
+        // Destroys the command pools, freeing their command buffers. The device must be idle.
+        void Shutdown();
+
+        /**
+         * Resets the pools of a frame in flight. Its previous submission must have completed.
+         * @param frameIndex Index of the frame in flight being recorded.
+         */
+        void BeginFrame(u32 frameIndex);
+
+        /**
+         * Records items in parallel and executes them from the primary command buffer, in order. Blocks until all slices
+         * are recorded. The caller records slices too, so this makes progress even while every worker is busy.
+         * @param primary Primary command buffer, inside a rendering instance begun with
+         * VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT.
+         * @param renderingInfo Attachment formats of that rendering instance, inherited by the secondary command buffers.
+         * @param itemCount Number of items, e.g. draws.
+         * @param record Records a slice of items. Secondary command buffers inherit no state: bind pipelines and
+         * descriptor sets, and set dynamic state, in every slice.
+         */
+        void Record(VkCommandBuffer primary, const VkCommandBufferInheritanceRenderingInfo &renderingInfo, u32 itemCount,
+                    const RecordFunction &record);
+
+        [[nodiscard]] inline u32 GetThreadCount() const { return mThreadCount; }
+        [[nodiscard]] inline RecorderStats GetStats() const { return mStats; }
+
+        // Logs the recording cost per frame and per item.
+        void LogStats() const;
+
+    private:
+        // Owned by one thread for one frame in flight.
+        struct ThreadCommands
+        {
+            VkCommandPool pool{};
+            std::vector<VkCommandBuffer> buffers;   // Allocated on demand, kept for reuse when the pool is reset.
+            u32 used{};                             // Buffers handed out since the pool was reset.
+        };
+
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        ThreadPool *mpThreadPool{};
+        u32 mThreadCount{};                         // Workers, plus the recording thread.
+        u32 mMinItemsPerSlice{};
+        u32 mFrameIndex{};
+        std::vector<ThreadCommands> mCommands;      // Frames in flight * threads, by frame then thread.
+        RecorderStats mStats{};                     // Only touched by the recording thread.
+
+        // Hands out a secondary command buffer from the calling thread's pool.
+        VkCommandBuffer AcquireSecondary();
+    };
+}
@@ -0,0 +1,213 @@
+#include "VulkanPipelineCache.h"
+#include <filesystem>
+
+namespace Vkr
+{
+    constexpr u32 PIPELINE_CACHE_MAGIC = 0x43504B56;    // "VKPC"
+    constexpr u32 PIPELINE_CACHE_VERSION = 1;
+
+    void VulkanPipelineCache::Initialize(VkDevice device, const VkPhysicalDeviceProperties &properties, const VkAllocationCallbacks *allocator, std::string path,
+                                         f64 time)
+    {
+        mDevice = device;
+        mAllocator = allocator;
+        mProperties = properties;
+        mPath = std::move(path);
+
+        // Otherwise the first Update would save right away, while startup is still compiling pipelines.
+        mLastSaveTime = time;
+
+        std::vector<u8> data;
+        mWarm = ReadFile(&data);
+
+        VkPipelineCacheCreateInfo createInfo{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+        createInfo.initialDataSize = data.size();
+        createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+        VkResult result = vkCreatePipelineCache(mDevice, &createInfo, mAllocator, &mCache);
+        if (result != VK_SUCCESS && mWarm)
+        {
+            // The driver rejected the data after all; carry on with an empty cache.
+            VWARN("Pipeline cache data rejected by the driver; starting with an empty cache.")
+            createInfo.initialDataSize = 0;
+            createInfo.pInitialData = nullptr;
+            mWarm = false;
+            result = vkCreatePipelineCache(mDevice, &createInfo, mAllocator, &mCache);
+        }
+
+        VK_CHECK(result)
+        VDEBUG("Pipeline cache created %s.", mWarm ? "from disk" : "empty")
+    }
+
+    void VulkanPipelineCache::Shutdown()
+    {
+        if (!mCache)
+            return;
+
+        Save();
+        vkDestroyPipelineCache(mDevice, mCache, mAllocator);
+        mCache = nullptr;
+    }
+
+    VkPipelineCache VulkanPipelineCache::CreateWorkerCache()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // Seeded with everything the main cache holds, so a warm start stays warm on the workers.
+        size_t dataSize = 0;
+        VK_CHECK(vkGetPipelineCacheData(mDevice, mCache, &dataSize, nullptr))
+
+        std::vector<u8> data(dataSize);
+        VK_CHECK(vkGetPipelineCacheData(mDevice, mCache, &dataSize, data.data()))
+
+        VkPipelineCacheCreateInfo createInfo{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+        createInfo.initialDataSize = dataSize;
+        createInfo.pInitialData = data.data();
+
+        VkPipelineCache workerCache;
+        VK_CHECK(vkCreatePipelineCache(mDevice, &createInfo, mAllocator, &workerCache))
+        return workerCache;
+    }
+
+    void VulkanPipelineCache::Merge(VkPipelineCache workerCache)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        VK_CHECK(vkMergePipelineCaches(mDevice, mCache, 1, &workerCache))
+        mDirty = true;
+    }
+
+    void VulkanPipelineCache::DestroyWorkerCache(VkPipelineCache workerCache)
+    {
+        vkDestroyPipelineCache(mDevice, workerCache, mAllocator);
+    }
+
+    void VulkanPipelineCache::Save()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mDirty || mPath.empty())
+            return;
+
+        size_t dataSize = 0;
+        VK_CHECK(vkGetPipelineCacheData(mDevice, mCache, &dataSize, nullptr))
+
+        std::vector<u8> data(dataSize);
+        VK_CHECK(vkGetPipelineCacheData(mDevice, mCache, &dataSize, data.data()))
+
+        FileHeader header{};
+        header.magic = PIPELINE_CACHE_MAGIC;
+        header.version = PIPELINE_CACHE_VERSION;
+        header.vendorID = mProperties.vendorID;
+        header.deviceID = mProperties.deviceID;
+        header.driverVersion = mProperties.driverVersion;
+        std::memcpy(header.pipelineCacheUUID, mProperties.pipelineCacheUUID, VK_UUID_SIZE);
+        header.dataSize = dataSize;
+        header.dataHash = HashBytes(data.data(), dataSize);
+
+        // Write next to the real file and rename over it, so a crash mid-write never leaves a truncated cache behind.
+        std::string tempPath = mPath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                VWARN("Failed to open '%s' to save the pipeline cache.", tempPath.c_str())
+                return;
+            }
+
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char *>(data.data()), (std::streamsize)dataSize);
+            if (!file.good())
+            {
+                VWARN("Failed to write the pipeline cache to '%s'.", tempPath.c_str())
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, mPath, error);
+        if (error)
+        {
+            VWARN("Failed to replace '%s': %s", mPath.c_str(), error.message().c_str())
+            return;
+        }
+
+        mDirty = false;
+        VDEBUG("Saved %zu bytes of pipeline cache to '%s'.", dataSize, mPath.c_str())
+    }
+
+    void VulkanPipelineCache::Update(f64 time, f64 intervalSeconds)
+    {
+        if (!mDirty || time - mLastSaveTime < intervalSeconds)
+            return;
+
+        mLastSaveTime = time;
+        Save();
+    }
+
+    bool VulkanPipelineCache::ReadFile(std::vector<u8> *outData) const
+    {
+        std::ifstream file(mPath, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+            return false;
+
+        auto fileSize = (size_t)file.tellg();
+        file.seekg(0);
+
+        FileHeader header{};
+        if (fileSize < sizeof(header) || !file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        {
+            VWARN("Pipeline cache '%s' is truncated; ignoring it.", mPath.c_str())
+            return false;
+        }
+
+        if (header.magic != PIPELINE_CACHE_MAGIC || header.version != PIPELINE_CACHE_VERSION)
+        {
+            VWARN("Pipeline cache '%s' has an unknown format; ignoring it.", mPath.c_str())
+            return false;
+        }
+
+        // Caches are only valid for the exact device and driver that produced them.
+        if (header.vendorID != mProperties.vendorID || header.deviceID != mProperties.deviceID ||
+            header.driverVersion != mProperties.driverVersion ||
+            std::memcmp(header.pipelineCacheUUID, mProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            VINFO("Pipeline cache '%s' was written by another device or driver; ignoring it.", mPath.c_str())
+            return false;
+        }
+
+        if (header.dataSize != fileSize - sizeof(header))
+        {
+            VWARN("Pipeline cache '%s' is truncated; ignoring it.", mPath.c_str())
+            return false;
+        }
+
+        outData->resize(header.dataSize);
+        file.read(reinterpret_cast<char *>(outData->data()), (std::streamsize)header.dataSize);
+
+        if (!file || HashBytes(outData->data(), outData->size()) != header.dataHash)
+        {
+            VWARN("Pipeline cache '%s' is corrupt; ignoring it.", mPath.c_str())
+            outData->clear();
+            return false;
+        }
+
+        // The Vulkan header inside the blob is checked too, in case the driver doesn't validate it.
+        VkPipelineCacheHeaderVersionOne vulkanHeader{};
+        if (outData->size() < sizeof(vulkanHeader))
+        {
+            outData->clear();
+            return false;
+        }
+
+        std::memcpy(&vulkanHeader, outData->data(), sizeof(vulkanHeader));
+        if (vulkanHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+            vulkanHeader.vendorID != mProperties.vendorID || vulkanHeader.deviceID != mProperties.deviceID ||
+            std::memcmp(vulkanHeader.pipelineCacheUUID, mProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            VWARN("Pipeline cache '%s' has a mismatched Vulkan header; ignoring it.", mPath.c_str())
+            outData->clear();
+            return false;
+        }
+
+        return true;
+    }
+}
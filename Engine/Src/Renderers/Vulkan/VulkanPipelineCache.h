@@ -0,0 +1,89 @@
+#pragma once
+#include "Defines.h"
+#include <mutex>
+
+namespace Vkr
+{
+    // A VkPipelineCache persisted to disk between runs, so warm starts skip shader compilation.
+    // The file is only used on the device and driver that wrote it; anything else starts with an empty cache.
+    class VulkanPipelineCache
+    {
+    public:
+        VulkanPipelineCache() = default;
+        ~VulkanPipelineCache() = default;
+
+        VulkanPipelineCache(const VulkanPipelineCache &) = delete;
+        void operator=(VulkanPipelineCache const &) = delete;
+
+        /**
+         * Creates the cache, seeded with the contents of the file at `path` if it was written by the same device and driver.
+         * @param device The logical device pipelines are created on.
+         * @param properties Properties of the physical device, identifying device and driver.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param path File the cache is loaded from and saved to.
+         * @param time Current time, in seconds, from which periodic saves are spaced.
+         */
+        void Initialize(VkDevice device, const VkPhysicalDeviceProperties &properties, const VkAllocationCallbacks *allocator, std::string path,
+                        f64 time);
+
+        // Saves the cache if it changed, then destroys it.
+        void Shutdown();
+
+        // The cache to pass to vkCreate*Pipelines on the thread that owns the renderer.
+        [[nodiscard]] inline VkPipelineCache GetHandle() const { return mCache; }
+
+        // Whether the cache was seeded from disk.
+        [[nodiscard]] inline bool IsWarm() const { return mWarm; }
+
+        /**
+         * Creates a copy of the cache for a worker thread to create pipelines with. Vulkan caches are internally synchronized,
+         * but drivers serialize access to them; a cache per thread avoids the contention.
+         * @return The worker's cache; `Merge` it back and destroy it with `DestroyWorkerCache` when the worker is done.
+         */
+        VkPipelineCache CreateWorkerCache();
+
+        // Merges a worker's cache into the main cache. Nothing may be compiling with the worker cache meanwhile.
+        void Merge(VkPipelineCache workerCache);
+
+        void DestroyWorkerCache(VkPipelineCache workerCache);
+
+        // Notes that pipelines were created, so the cache is saved on the next `Save`.
+        inline void MarkDirty() { mDirty = true; }
+
+        // Writes the cache to disk if it changed since it was loaded or last saved. The file is replaced atomically.
+        void Save();
+
+        /**
+         * Saves the cache at most once per `intervalSeconds`, for runs that never shut down cleanly.
+         * @param time The current absolute time in seconds.
+         */
+        void Update(f64 time, f64 intervalSeconds = 60.0);
+
+    private:
+        // Written ahead of the Vulkan cache data. The Vulkan header already carries vendor, device and cache UUID, but not
+        // the driver version, and a driver update with a stale UUID would otherwise get to parse a blob it didn't write.
+        struct FileHeader
+        {
+            u32 magic;
+            u32 version;
+            u32 vendorID;
+            u32 deviceID;
+            u32 driverVersion;
+            u8 pipelineCacheUUID[VK_UUID_SIZE];
+            u64 dataSize;
+            u64 dataHash;
+        };
+
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        VkPhysicalDeviceProperties mProperties{};
+        VkPipelineCache mCache{};
+        std::string mPath;
+        std::mutex mMutex;             // Guards merges into the main cache.
+        bool mWarm = false;
+        bool mDirty = false;
+        f64 mLastSaveTime{};
+
+        bool ReadFile(std::vector<u8> *outData) const;
+    };
+}
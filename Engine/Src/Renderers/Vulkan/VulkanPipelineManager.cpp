@@ -0,0 +1,448 @@
+#include "VulkanPipelineManager.h"
+#include <algorithm>
+#include <chrono>
+
+namespace Vkr
+{
+    template <typename T>
+    static inline u64 HashValue(const T &value, u64 hash)
+    {
+        return HashBytes(&value, sizeof(T), hash);
+    }
+
+    void VulkanPipelineManager::Initialize(VkDevice device, const VkAllocationCallbacks *allocator, VulkanPipelineCache *pipelineCache, ThreadPool *threadPool)
+    {
+        mDevice = device;
+        mAllocator = allocator;
+        mpPipelineCache = pipelineCache;
+        mpThreadPool = threadPool;
+
+        // Pipeline caches serialize the threads using them, so every worker gets its own.
+        mWorkerCaches.resize(mpThreadPool->GetWorkerCount());
+        for (auto &cache : mWorkerCaches)
+        {
+            cache = mpPipelineCache->CreateWorkerCache();
+        }
+    }
+
+    void VulkanPipelineManager::Shutdown()
+    {
+        mpThreadPool->WaitIdle();
+        LogStats();
+
+        for (auto cache : mWorkerCaches)
+        {
+            mpPipelineCache->Merge(cache);
+            mpPipelineCache->DestroyWorkerCache(cache);
+        }
+
+        for (auto &entry : mEntries)
+        {
+            if (VkPipeline pipeline = entry->pipeline.load())
+                vkDestroyPipeline(mDevice, pipeline, mAllocator);
+        }
+
+        for (auto pipeline : mRetiredPipelines)
+        {
+            vkDestroyPipeline(mDevice, pipeline, mAllocator);
+        }
+
+        mWorkerCaches.clear();
+        mRetiredPipelines.clear();
+        mEntries.clear();
+        mEntryByHash.clear();
+        mFallback = {};
+    }
+
+    PipelineHandle VulkanPipelineManager::RequestGraphicsPipeline(const GraphicsPipelineInfo &info)
+    {
+        u64 hash = HashInfo(info);
+
+        Entry *entry;
+        PipelineHandle handle;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.requests++;
+
+            auto [first, last] = mEntryByHash.equal_range(hash);
+            for (auto it = first; it != last; ++it)
+            {
+                if (EqualInfo(mEntries[it->second]->info, info))
+                {
+                    mStats.deduplicated++;
+                    return {it->second};
+                }
+            }
+
+            handle.index = (u32)mEntries.size();
+            mEntries.push_back(std::make_unique<Entry>());
+            mEntryByHash.emplace(hash, handle.index);
+            entry = mEntries.back().get();
+            entry->info = info;
+            entry->hash = hash;
+            mStats.pending++;
+        }
+
+        // Entries are never removed before shutdown, which waits for the pool, so the pointer outlives the job.
+        mpThreadPool->Submit([this, info, entry]() { Compile(info, entry, 0); });
+        return handle;
+    }
+
+    VkPipeline VulkanPipelineManager::Get(PipelineHandle handle)
+    {
+        Entry *entry = GetEntry(handle);
+        if (entry && entry->state.load(std::memory_order_acquire) == State::Ready)
+            return entry->pipeline.load(std::memory_order_acquire);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.notReady++;
+        }
+
+        Entry *fallback = GetEntry(mFallback);
+        if (fallback && fallback->state.load(std::memory_order_acquire) == State::Ready)
+            return fallback->pipeline.load(std::memory_order_acquire);
+
+        return VK_NULL_HANDLE;
+    }
+
+    VkPipeline VulkanPipelineManager::Wait(PipelineHandle handle)
+    {
+        Entry *entry = GetEntry(handle);
+        if (!entry)
+            return VK_NULL_HANDLE;
+
+        if (entry->state.load(std::memory_order_acquire) == State::Pending)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCompiled.wait(lock, [entry]() { return entry->state.load(std::memory_order_acquire) != State::Pending; });
+
+            mStats.stalls++;
+            mStats.stallMs += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        return entry->pipeline.load(std::memory_order_acquire);
+    }
+
+    bool VulkanPipelineManager::IsReady(PipelineHandle handle)
+    {
+        Entry *entry = GetEntry(handle);
+        return entry && entry->state.load(std::memory_order_acquire) == State::Ready;
+    }
+
+    void VulkanPipelineManager::ReplaceShader(u64 oldHash, const VulkanShader &shader)
+    {
+        std::vector<std::tuple<GraphicsPipelineInfo, Entry *, u32>> rebuilds;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (u32 i = 0; i < mEntries.size(); ++i)
+            {
+                Entry *entry = mEntries[i].get();
+
+                bool uses = false;
+                for (auto &stage : entry->info.stages)
+                {
+                    if (stage.hash == oldHash)
+                    {
+                        stage.module = shader.module;
+                        stage.hash = shader.hash;
+                        uses = true;
+                    }
+                }
+
+                if (!uses)
+                    continue;
+
+                // Requests for the new state now find this entry; requests for the old state compile it afresh.
+                auto [first, last] = mEntryByHash.equal_range(entry->hash);
+                for (auto it = first; it != last; ++it)
+                {
+                    if (it->second == i)
+                    {
+                        mEntryByHash.erase(it);
+                        break;
+                    }
+                }
+
+                entry->hash = HashInfo(entry->info);
+                mEntryByHash.emplace(entry->hash, i);
+
+                mStats.pending++;
+                rebuilds.emplace_back(entry->info, entry, ++entry->generation);
+            }
+        }
+
+        for (auto &[info, entry, generation] : rebuilds)
+        {
+            mpThreadPool->Submit([this, info, entry, generation]() { Compile(info, entry, generation); });
+        }
+    }
+
+    void VulkanPipelineManager::TakeRetiredPipelines(std::vector<VkPipeline> *outPipelines)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        outPipelines->insert(outPipelines->end(), mRetiredPipelines.begin(), mRetiredPipelines.end());
+        mRetiredPipelines.clear();
+    }
+
+    void VulkanPipelineManager::Update()
+    {
+        // Merging reads the worker caches, so only do it while no worker can be writing to them.
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mWorkerCachesDirty || mStats.pending != 0)
+            return;
+
+        for (auto cache : mWorkerCaches)
+        {
+            mpPipelineCache->Merge(cache);
+        }
+
+        mWorkerCachesDirty = false;
+    }
+
+    PipelineStats VulkanPipelineManager::GetStats()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+    void VulkanPipelineManager::LogStats()
+    {
+        PipelineStats stats = GetStats();
+        VDEBUG("Pipelines: %llu requested, %llu deduplicated, %llu compiled, %llu rebuilt, %llu failed, %llu pending.",
+               stats.requests, stats.deduplicated, stats.compiled, stats.rebuilt, stats.failed, stats.pending)
+        VDEBUG("\tCompile time %.2f ms total, %.2f ms max. %llu lookups not ready, %llu stalls for %.2f ms.",
+               stats.compileMs, stats.maxCompileMs, stats.notReady, stats.stalls, stats.stallMs)
+    }
+
+    void VulkanPipelineManager::Compile(const GraphicsPipelineInfo &info, Entry *entry, u32 generation)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<VkPipelineShaderStageCreateInfo> stages(info.stages.size());
+        for (size_t i = 0; i < info.stages.size(); ++i)
+        {
+            stages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stages[i].stage = info.stages[i].stage;                 // Shader stage name.
+            stages[i].module = info.stages[i].module;               // Shader module to be used by stage.
+            stages[i].pName = info.stages[i].entryPoint.c_str();    // Entry point into shader.
+        }
+
+        // --- VERTEX INPUT ---
+        VkPipelineVertexInputStateCreateInfo vertexInputState{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+        vertexInputState.vertexBindingDescriptionCount = (u32)info.vertexBindings.size();
+        vertexInputState.pVertexBindingDescriptions = info.vertexBindings.data();
+        vertexInputState.vertexAttributeDescriptionCount = (u32)info.vertexAttributes.size();
+        vertexInputState.pVertexAttributeDescriptions = info.vertexAttributes.data();
+
+        // --- INPUT ASSEMBLY ---
+        VkPipelineInputAssemblyStateCreateInfo inputAssemblyState{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+        inputAssemblyState.topology = info.topology;
+        inputAssemblyState.primitiveRestartEnable = VK_FALSE;
+
+        // --- VIEWPORT AND SCISSOR --- Dynamic, only the counts are baked in.
+        VkPipelineViewportStateCreateInfo viewportState{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+        viewportState.viewportCount = 1;
+        viewportState.scissorCount = 1;
+
+        std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicState{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+        dynamicState.dynamicStateCount = (u32)dynamicStates.size();
+        dynamicState.pDynamicStates = dynamicStates.data();
+
+        // --- RASTERIZER ---
+        VkPipelineRasterizationStateCreateInfo rasterizationState{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+        rasterizationState.depthClampEnable = VK_FALSE;
+        rasterizationState.rasterizerDiscardEnable = VK_FALSE;
+        rasterizationState.polygonMode = info.polygonMode;
+        rasterizationState.lineWidth = 1.0f;
+        rasterizationState.cullMode = info.cullMode;
+        rasterizationState.frontFace = info.frontFace;
+        rasterizationState.depthBiasEnable = VK_FALSE;
+
+        // --- MULTISAMPLING ---
+        VkPipelineMultisampleStateCreateInfo multisampleState{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+        multisampleState.sampleShadingEnable = VK_FALSE;
+        multisampleState.rasterizationSamples = info.samples;
+
+        // --- DEPTH STENCIL TESTING ---
+        VkPipelineDepthStencilStateCreateInfo depthStencilState{VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
+        depthStencilState.depthTestEnable = info.depthTest;
+        depthStencilState.depthWriteEnable = info.depthWrite;
+        depthStencilState.depthCompareOp = info.depthCompareOp;
+
+        // --- BLENDING ---
+        VkPipelineColorBlendAttachmentState colorState{};
+        colorState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        colorState.blendEnable = info.blendEnable;
+        colorState.srcColorBlendFactor = info.srcColorBlendFactor;
+        colorState.dstColorBlendFactor = info.dstColorBlendFactor;
+        colorState.colorBlendOp = info.colorBlendOp;
+        colorState.srcAlphaBlendFactor = info.srcAlphaBlendFactor;
+        colorState.dstAlphaBlendFactor = info.dstAlphaBlendFactor;
+        colorState.alphaBlendOp = info.alphaBlendOp;
+
+        std::vector<VkPipelineColorBlendAttachmentState> colorStates(info.colorFormats.size(), colorState);
+        VkPipelineColorBlendStateCreateInfo colorBlendState{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+        colorBlendState.logicOpEnable = VK_FALSE;
+        colorBlendState.attachmentCount = (u32)colorStates.size();
+        colorBlendState.pAttachments = colorStates.data();
+
+        // --- DYNAMIC RENDERING --- Attachment formats take the place of a render pass.
+        VkPipelineRenderingCreateInfo renderingInfo{VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO};
+        renderingInfo.colorAttachmentCount = (u32)info.colorFormats.size();
+        renderingInfo.pColorAttachmentFormats = info.colorFormats.data();
+        renderingInfo.depthAttachmentFormat = info.depthFormat;
+        renderingInfo.stencilAttachmentFormat = info.stencilFormat;
+
+        // --- GRAPHICS PIPELINE CREATION ---
+        VkGraphicsPipelineCreateInfo pipelineCreateInfo{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+        pipelineCreateInfo.pNext = &renderingInfo;
+        pipelineCreateInfo.stageCount = (u32)stages.size();
+        pipelineCreateInfo.pStages = stages.data();
+        pipelineCreateInfo.pVertexInputState = &vertexInputState;
+        pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+        pipelineCreateInfo.pViewportState = &viewportState;
+        pipelineCreateInfo.pDynamicState = &dynamicState;
+        pipelineCreateInfo.pRasterizationState = &rasterizationState;
+        pipelineCreateInfo.pMultisampleState = &multisampleState;
+        pipelineCreateInfo.pDepthStencilState = &depthStencilState;
+        pipelineCreateInfo.pColorBlendState = &colorBlendState;
+        pipelineCreateInfo.layout = info.layout;
+        pipelineCreateInfo.renderPass = VK_NULL_HANDLE;
+        pipelineCreateInfo.subpass = 0;
+        pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+        pipelineCreateInfo.basePipelineIndex = -1;
+
+        i32 workerIndex = ThreadPool::GetCurrentWorkerIndex();
+        VkPipelineCache cache = workerIndex >= 0 ? mWorkerCaches[workerIndex] : mpPipelineCache->GetHandle();
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult result = vkCreateGraphicsPipelines(mDevice, cache, 1, &pipelineCreateInfo, mAllocator, &pipeline);
+
+        f64 compileMs = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.pending--;
+            mStats.compileMs += compileMs;
+            mStats.maxCompileMs = VMAX(mStats.maxCompileMs, compileMs);
+            mWorkerCachesDirty = true;
+
+            if (generation != entry->generation)
+            {
+                // A later rebuild superseded this one before it finished; nothing can be using the result.
+                if (pipeline)
+                    vkDestroyPipeline(mDevice, pipeline, mAllocator);
+            }
+            else if (result == VK_SUCCESS)
+            {
+                if (generation == 0)
+                    mStats.compiled++;
+                else
+                    mStats.rebuilt++;
+
+                // Frames in flight may still use the pipeline being replaced.
+                if (VkPipeline previous = entry->pipeline.exchange(pipeline, std::memory_order_acq_rel))
+                    mRetiredPipelines.push_back(previous);
+
+                entry->state.store(State::Ready, std::memory_order_release);
+            }
+            else
+            {
+                VERROR("Failed to compile graphics pipeline (VkResult %d).", result)
+                mStats.failed++;
+
+                // A failed rebuild keeps the previous pipeline, so a typo in a shader doesn't take the material down.
+                if (entry->state.load(std::memory_order_relaxed) != State::Ready)
+                    entry->state.store(State::Failed, std::memory_order_release);
+            }
+        }
+
+        mCompiled.notify_all();
+    }
+
+    VulkanPipelineManager::Entry *VulkanPipelineManager::GetEntry(PipelineHandle handle)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return handle.index < mEntries.size() ? mEntries[handle.index].get() : nullptr;
+    }
+
+    u64 VulkanPipelineManager::HashInfo(const GraphicsPipelineInfo &info)
+    {
+        u64 hash = HashValue(info.stages.size(), 0xCBF29CE484222325ull);
+        for (const auto &stage : info.stages)
+        {
+            hash = HashValue(stage.stage, hash);
+            hash = HashValue(stage.hash, hash);
+            hash = HashBytes(stage.entryPoint.data(), stage.entryPoint.size(), hash);
+        }
+
+        // Field by field rather than whole structs, so padding never makes equal states hash differently.
+        hash = HashValue(info.vertexBindings.size(), hash);
+        for (const auto &binding : info.vertexBindings)
+        {
+            hash = HashValue(binding.binding, hash);
+            hash = HashValue(binding.stride, hash);
+            hash = HashValue(binding.inputRate, hash);
+        }
+
+        hash = HashValue(info.vertexAttributes.size(), hash);
+        for (const auto &attribute : info.vertexAttributes)
+        {
+            hash = HashValue(attribute.location, hash);
+            hash = HashValue(attribute.binding, hash);
+            hash = HashValue(attribute.format, hash);
+            hash = HashValue(attribute.offset, hash);
+        }
+
+        hash = HashValue(info.topology, hash);
+        hash = HashValue(info.polygonMode, hash);
+        hash = HashValue(info.cullMode, hash);
+        hash = HashValue(info.frontFace, hash);
+        hash = HashValue(info.samples, hash);
+        hash = HashValue(info.depthTest, hash);
+        hash = HashValue(info.depthWrite, hash);
+        hash = HashValue(info.depthCompareOp, hash);
+        hash = HashValue(info.blendEnable, hash);
+        hash = HashValue(info.srcColorBlendFactor, hash);
+        hash = HashValue(info.dstColorBlendFactor, hash);
+        hash = HashValue(info.colorBlendOp, hash);
+        hash = HashValue(info.srcAlphaBlendFactor, hash);
+        hash = HashValue(info.dstAlphaBlendFactor, hash);
+        hash = HashValue(info.alphaBlendOp, hash);
+        hash = HashValue(info.layout, hash);
+        hash = HashValue(info.colorFormats.size(), hash);
+        for (auto format : info.colorFormats)
+        {
+            hash = HashValue(format, hash);
+        }
+
+        hash = HashValue(info.depthFormat, hash);
+        hash = HashValue(info.stencilFormat, hash);
+
+        return hash;
+    }
+
+    bool VulkanPipelineManager::EqualInfo(const GraphicsPipelineInfo &a, const GraphicsPipelineInfo &b)
+    {
+        // The same fields as HashInfo; modules are identified by their content hash.
+        auto sameStage = [](const ShaderStageInfo &x, const ShaderStageInfo &y)
+        { return x.stage == y.stage && x.hash == y.hash && x.entryPoint == y.entryPoint; };
+        auto sameBinding = [](const VkVertexInputBindingDescription &x, const VkVertexInputBindingDescription &y)
+        { return x.binding == y.binding && x.stride == y.stride && x.inputRate == y.inputRate; };
+        auto sameAttribute = [](const VkVertexInputAttributeDescription &x, const VkVertexInputAttributeDescription &y)
+        { return x.location == y.location && x.binding == y.binding && x.format == y.format && x.offset == y.offset; };
+
+        return std::equal(a.stages.begin(), a.stages.end(), b.stages.begin(), b.stages.end(), sameStage) &&
+               std::equal(a.vertexBindings.begin(), a.vertexBindings.end(), b.vertexBindings.begin(), b.vertexBindings.end(), sameBinding) &&
+               std::equal(a.vertexAttributes.begin(), a.vertexAttributes.end(), b.vertexAttributes.begin(), b.vertexAttributes.end(), sameAttribute) &&
+               a.topology == b.topology && a.polygonMode == b.polygonMode && a.cullMode == b.cullMode && a.frontFace == b.frontFace &&
+               a.samples == b.samples && a.depthTest == b.depthTest && a.depthWrite == b.depthWrite && a.depthCompareOp == b.depthCompareOp &&
+               a.blendEnable == b.blendEnable && a.srcColorBlendFactor == b.srcColorBlendFactor && a.dstColorBlendFactor == b.dstColorBlendFactor &&
+               a.colorBlendOp == b.colorBlendOp && a.srcAlphaBlendFactor == b.srcAlphaBlendFactor && a.dstAlphaBlendFactor == b.dstAlphaBlendFactor &&
+               a.alphaBlendOp == b.alphaBlendOp && a.layout == b.layout && a.colorFormats == b.colorFormats &&
+               a.depthFormat == b.depthFormat && a.stencilFormat == b.stencilFormat;
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include "Defines.h"
+#include "GraphicsPipelineInfo.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanShaderRegistry.h"
+#include "Core/Threading/ThreadPool.h"
+#include <atomic>
+#include <mutex>
+
+namespace Vkr
+{
+    // Refers to a pipeline requested from the `VulkanPipelineManager`. Stays valid until the manager shuts down.
+    struct PipelineHandle
+    {
+        u32 index = ~0u;
+
+        [[nodiscard]] inline bool IsValid() const { return index != ~0u; }
+    };
+
+    struct PipelineStats
+    {
+        u64 requests{};             // Calls to `RequestGraphicsPipeline`.
+        u64 deduplicated{};         // Requests answered with an existing pipeline.
+        u64 compiled{};             // Pipelines compiled so far.
+        u64 failed{};               // Pipelines that failed to compile.
+        u64 pending{};              // Pipelines still compiling.
+        u64 rebuilt{};              // Pipelines recompiled after one of their shaders was reloaded.
+        u64 notReady{};             // Lookups of a pipeline that was still compiling; each is a draw skipped or using the fallback.
+        u64 stalls{};               // Times the caller blocked on a compile.
+        f64 stallMs{};              // Total time spent blocked on compiles.
+        f64 compileMs{};            // Total compile time across workers.
+        f64 maxCompileMs{};         // Longest single compile.
+    };
+
+    // Compiles pipelines on a thread pool, so a material's first use never blocks the frame.
+    // Requests are keyed by a hash of the full pipeline state, and compared in full on a hit; identical requests share one pipeline.
+    class VulkanPipelineManager
+    {
+    public:
+        VulkanPipelineManager() = default;
+        ~VulkanPipelineManager() = default;
+
+        VulkanPipelineManager(const VulkanPipelineManager &) = delete;
+        void operator=(VulkanPipelineManager const &) = delete;
+
+        /**
+         * Prepares the manager for use.
+         * @param device The logical device pipelines are created on.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param pipelineCache Cache compiles go through. Each worker uses its own cache, merged back into this one.
+         * @param threadPool Pool compiles run on.
+         */
+        void Initialize(VkDevice device, const VkAllocationCallbacks *allocator, VulkanPipelineCache *pipelineCache, ThreadPool *threadPool);
+
+        // Waits for outstanding compiles, then destroys every pipeline.
+        void Shutdown();
+
+        /**
+         * Requests a graphics pipeline. Compilation starts in the background unless an identical pipeline was requested before.
+         * @return Handle to look the pipeline up with once it is ready.
+         */
+        PipelineHandle RequestGraphicsPipeline(const GraphicsPipelineInfo &info);
+
+        /**
+         * Looks up a pipeline without blocking.
+         * @return The pipeline, the fallback pipeline if it is still compiling (or failed), or VK_NULL_HANDLE without a fallback.
+         */
+        VkPipeline Get(PipelineHandle handle);
+
+        // Looks up a pipeline, blocking until it is compiled. The time blocked is reported as a stall.
+        VkPipeline Wait(PipelineHandle handle);
+
+        [[nodiscard]] bool IsReady(PipelineHandle handle);
+
+        // Pipeline returned by `Get` while the requested one is compiling, e.g. a flat shaded material.
+        inline void SetFallback(PipelineHandle handle) { mFallback = handle; }
+
+        /**
+         * Rebuilds, in the background, every pipeline using a shader that was reloaded. Until a rebuild completes,
+         * lookups keep returning the previous pipeline.
+         * @param oldHash Hash of the shader that was replaced.
+         * @param shader The reloaded shader.
+         */
+        void ReplaceShader(u64 oldHash, const VulkanShader &shader);
+
+        /**
+         * Hands over the pipelines replaced by rebuilds. The caller destroys them once no frame in flight uses them.
+         * @param outPipelines Receives the pipelines.
+         */
+        void TakeRetiredPipelines(std::vector<VkPipeline> *outPipelines);
+
+        // Merges the worker pipeline caches into the main cache when nothing is compiling. Call once per frame.
+        void Update();
+
+        [[nodiscard]] PipelineStats GetStats();
+
+        // Logs the compile statistics.
+        void LogStats();
+
+    private:
+        enum class State : u8
+        {
+            Pending,
+            Ready,
+            Failed
+        };
+
+        struct Entry
+        {
+            std::atomic<State> state{State::Pending};
+            std::atomic<VkPipeline> pipeline{};     // Swapped when a rebuild completes.
+            GraphicsPipelineInfo info;              // Kept for rebuilds.
+            u64 hash{};
+            u32 generation{};                       // Bumped by every rebuild; only the latest rebuild is kept.
+        };
+
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        VulkanPipelineCache *mpPipelineCache{};
+        ThreadPool *mpThreadPool{};
+
+        std::mutex mMutex;                                      // Guards the tables and stats below.
+        std::condition_variable mCompiled;
+        std::vector<std::unique_ptr<Entry>> mEntries;
+        std::unordered_multimap<u64, u32> mEntryByHash;         // Several entries only if their hashes collide.
+        std::vector<VkPipelineCache> mWorkerCaches;             // One per worker, indexed by worker index.
+        std::vector<VkPipeline> mRetiredPipelines;              // Replaced by rebuilds, possibly still used by frames in flight.
+        bool mWorkerCachesDirty = false;
+        PipelineHandle mFallback{};
+        PipelineStats mStats{};
+
+        void Compile(const GraphicsPipelineInfo &info, Entry *entry, u32 generation);
+        Entry *GetEntry(PipelineHandle handle);
+
+        static u64 HashInfo(const GraphicsPipelineInfo &info);
+        static bool EqualInfo(const GraphicsPipelineInfo &a, const GraphicsPipelineInfo &b);
+    };
+}
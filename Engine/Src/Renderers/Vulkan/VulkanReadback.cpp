@@ -0,0 +1,198 @@
+#include "VulkanReadback.h"
+#include <cstdio>
+
+namespace Vkr
+{
+	void VulkanReadbackRing::Initialize(VkDevice device, const VkAllocationCallbacks *allocator, VulkanMemoryAllocator *memoryAllocator,
+										Platform *platform, u32 slotCount)
+	{
+		mDevice = device;
+		mAllocator = allocator;
+		mpMemoryAllocator = memoryAllocator;
+		mpPlatform = platform;
+		mSlots.resize(slotCount);
+	}
+
+	void VulkanReadbackRing::Shutdown()
+	{
+		Poll();
+		DestroyBuffers();
+		mSlots.clear();
+	}
+
+	StatusCode VulkanReadbackRing::Resize(u32 width, u32 height, VkFormat format)
+	{
+		// The device is idle, so every pending fence has signaled.
+		Poll();
+		DestroyBuffers();
+
+		mWidth = width;
+		mHeight = height;
+		mFormat = format;
+
+		for (auto &slot : mSlots)
+		{
+			VkBufferCreateInfo bufferCreateInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+			bufferCreateInfo.size = (VkDeviceSize)width * height * 4;
+			bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			VK_CHECK(vkCreateBuffer(mDevice, &bufferCreateInfo, mAllocator, &slot.buffer.handle))
+			slot.buffer.size = bufferCreateInfo.size;
+
+			// Cached memory makes the host's reads fast; coherent memory needs no invalidation before them.
+			StatusCode statusCode = mpMemoryAllocator->AllocateBufferMemory(slot.buffer.handle, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+																			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+																			&slot.buffer.allocation);
+			if (statusCode != StatusCode::Successful)
+				statusCode = mpMemoryAllocator->AllocateBufferMemory(slot.buffer.handle, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+																	 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &slot.buffer.allocation);
+			ENSURE_SUCCESS(statusCode, "Failed to allocate a %llu byte readback buffer.", (unsigned long long)slot.buffer.size)
+		}
+
+		return StatusCode::Successful;
+	}
+
+	void VulkanReadbackRing::RecordCopy(VkCommandBuffer commandBuffer, u32 slot, VkImage image)
+	{
+		VkBufferImageCopy region{};
+		region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+		region.imageExtent = {mWidth, mHeight, 1};
+		vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mSlots[slot].buffer.handle, 1, &region);
+
+		// The fence only orders the host after the copy; the copy's writes also have to be made visible to it.
+		VkBufferMemoryBarrier2 barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2};
+		barrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+		barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		barrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+		barrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = mSlots[slot].buffer.handle;
+		barrier.size = VK_WHOLE_SIZE;
+
+		VkDependencyInfo dependencyInfo{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+		dependencyInfo.bufferMemoryBarrierCount = 1;
+		dependencyInfo.pBufferMemoryBarriers = &barrier;
+		vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+
+	void VulkanReadbackRing::Submit(u32 slot, u64 frameNumber, VkFence fence)
+	{
+		Slot &submitted = mSlots[slot];
+		submitted.fence = fence;
+		submitted.frameNumber = frameNumber;
+		submitted.submitTime = mpPlatform->GetAbsoluteTime();
+		submitted.pending = true;
+
+		if (mFirstSubmitTime == 0)
+			mFirstSubmitTime = submitted.submitTime;
+	}
+
+	void VulkanReadbackRing::Poll()
+	{
+		// Frames complete in submission order, so stop at the first one that hasn't.
+		while (true)
+		{
+			Slot *oldest = nullptr;
+			for (auto &slot : mSlots)
+			{
+				if (slot.pending && (!oldest || slot.frameNumber < oldest->frameNumber))
+					oldest = &slot;
+			}
+
+			if (!oldest || vkGetFenceStatus(mDevice, oldest->fence) != VK_SUCCESS)
+				return;
+
+			Read(*oldest, mpPlatform->GetAbsoluteTime());
+		}
+	}
+
+	void VulkanReadbackRing::Read(Slot &slot, f64 now)
+	{
+		slot.pending = false;
+
+		ReadbackFrame frame{};
+		frame.frameNumber = slot.frameNumber;
+		frame.width = mWidth;
+		frame.height = mHeight;
+		frame.format = mFormat;
+		frame.pixels = (const u8 *)slot.buffer.allocation.mapped;
+		frame.latencyMs = (now - slot.submitTime) * 1000.0;
+
+		++mFrames;
+		mLastReadTime = now;
+		mLatencySumMs += frame.latencyMs;
+		mMaxLatencyMs = VMAX(mMaxLatencyMs, frame.latencyMs);
+
+		if (mCallback)
+			mCallback(frame);
+
+		if (!mCaptureDirectory.empty())
+			WriteCapture(frame);
+	}
+
+	void VulkanReadbackRing::WriteCapture(const ReadbackFrame &frame) const
+	{
+		const std::string path = mCaptureDirectory + "/Frame_" + std::to_string(frame.frameNumber) + ".ppm";
+		FILE *file = fopen(path.c_str(), "wb");
+		if (!file)
+		{
+			VWARN("Failed to write captured frame '%s'.", path.c_str())
+			return;
+		}
+
+		// Binary PPM holds RGB only; swizzle BGRA images, and drop alpha.
+		const bool bgra = frame.format == VK_FORMAT_B8G8R8A8_UNORM || frame.format == VK_FORMAT_B8G8R8A8_SRGB;
+		std::vector<u8> row(frame.width * 3);
+
+		fprintf(file, "P6\n%u %u\n255\n", frame.width, frame.height);
+		for (u32 y = 0; y < frame.height; ++y)
+		{
+			const u8 *pixel = frame.pixels + (size_t)y * frame.width * 4;
+			for (u32 x = 0; x < frame.width; ++x, pixel += 4)
+			{
+				row[x * 3 + 0] = bgra ? pixel[2] : pixel[0];
+				row[x * 3 + 1] = pixel[1];
+				row[x * 3 + 2] = bgra ? pixel[0] : pixel[2];
+			}
+
+			fwrite(row.data(), 1, row.size(), file);
+		}
+
+		fclose(file);
+	}
+
+	ReadbackStats VulkanReadbackRing::GetStats() const
+	{
+		ReadbackStats stats{};
+		stats.frames = mFrames;
+		stats.seconds = mFrames ? mLastReadTime - mFirstSubmitTime : 0.0;
+		stats.averageLatencyMs = mFrames ? mLatencySumMs / mFrames : 0.0;
+		stats.maxLatencyMs = mMaxLatencyMs;
+		return stats;
+	}
+
+	void VulkanReadbackRing::LogStats() const
+	{
+		const ReadbackStats stats = GetStats();
+		if (stats.frames == 0 || stats.seconds <= 0)
+			return;
+
+		VINFO("Offscreen: %llu frames in %.2f s, %.1f frames per second. Readback latency %.2f ms average, %.2f ms max.",
+			  stats.frames, stats.seconds, stats.frames / stats.seconds, stats.averageLatencyMs, stats.maxLatencyMs)
+	}
+
+	void VulkanReadbackRing::DestroyBuffers()
+	{
+		for (auto &slot : mSlots)
+		{
+			if (slot.buffer.handle)
+			{
+				vkDestroyBuffer(mDevice, slot.buffer.handle, mAllocator);
+				mpMemoryAllocator->Free(&slot.buffer.allocation);
+			}
+
+			slot = {};
+		}
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "Defines.h"
+#include "VulkanBuffer.h"
+#include "VulkanMemoryAllocator.h"
+#include "Platform/Platform.h"
+
+namespace Vkr
+{
+    // A frame copied back to host memory.
+    struct ReadbackFrame
+    {
+        u64 frameNumber;
+        u32 width;
+        u32 height;
+        VkFormat format;                    // Of the rendered image; 4 bytes per pixel.
+        const u8 *pixels;                   // Tightly packed rows, top to bottom. Only valid during the callback.
+        f64 latencyMs;                      // From the frame's submission until its pixels were found on the host.
+    };
+
+    using ReadbackCallback = std::function<void(const ReadbackFrame &frame)>;
+
+    struct ReadbackStats
+    {
+        u64 frames{};                       // Frames read back.
+        f64 seconds{};                      // From the first frame's submission until the last one was read back.
+        f64 averageLatencyMs{};
+        f64 maxLatencyMs{};
+    };
+
+    // Copies rendered frames back to host memory through a ring of host visible buffers, one per frame in flight.
+    //
+    // The copy is recorded at the end of the frame and the buffer is read once the frame's fence has signaled, which is
+    // polled at the start of every frame, so reading back never stalls the GPU nor, beyond the frames in flight, the CPU.
+    // Frames are handed to a callback and optionally written to a directory as PPM images, for image tests.
+    class VulkanReadbackRing
+    {
+    public:
+        VulkanReadbackRing() = default;
+        ~VulkanReadbackRing() = default;
+
+        VulkanReadbackRing(const VulkanReadbackRing &) = delete;
+        void operator=(VulkanReadbackRing const &) = delete;
+
+        /**
+         * Prepares the ring for use. Buffers are created by `Resize`.
+         * @param device The logical device.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param memoryAllocator Allocator the buffers' memory comes from.
+         * @param platform Clock of the platform, for latencies.
+         * @param slotCount Number of buffers, one per frame in flight.
+         */
+        void Initialize(VkDevice device, const VkAllocationCallbacks *allocator, VulkanMemoryAllocator *memoryAllocator,
+                        Platform *platform, u32 slotCount);
+
+        // Destroys the buffers. The device must be idle.
+        void Shutdown();
+
+        /**
+         * (Re)creates the buffers for frames of a new size. Frames still pending are read back first; the device must
+         * be idle.
+         * @param format Format of the rendered images, with 4 bytes per pixel.
+         */
+        StatusCode Resize(u32 width, u32 height, VkFormat format);
+
+        // Buffer of a slot, for declaring the copy to it in the render graph.
+        [[nodiscard]] inline VkBuffer GetBuffer(u32 slot) const { return mSlots[slot].buffer.handle; }
+
+        /**
+         * Records the copy of a frame to a slot's buffer and makes it visible to the host.
+         * @param image The rendered image, in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL.
+         */
+        void RecordCopy(VkCommandBuffer commandBuffer, u32 slot, VkImage image);
+
+        /**
+         * Marks a slot's copy as submitted.
+         * @param fence Signaled once the frame, and with it the copy, has completed.
+         */
+        void Submit(u32 slot, u64 frameNumber, VkFence fence);
+
+        // Reads back every submitted frame whose fence has signaled, oldest first.
+        void Poll();
+
+        // Hands every frame read back to the callback, e.g. for comparing against golden images.
+        inline void SetCallback(ReadbackCallback &&callback) { mCallback = std::move(callback); }
+
+        // Writes every frame read back to the directory, as Frame_<number>.ppm. Null stops writing frames.
+        inline void SetCaptureDirectory(const char *directory) { mCaptureDirectory = directory ? directory : ""; }
+
+        [[nodiscard]] ReadbackStats GetStats() const;
+
+        // Logs the frame rate and readback latency of every frame read back so far.
+        void LogStats() const;
+
+    private:
+        struct Slot
+        {
+            VulkanBuffer buffer{};
+            VkFence fence{};
+            u64 frameNumber{};
+            f64 submitTime{};
+            bool pending = false;           // Submitted, but not read back yet.
+        };
+
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        VulkanMemoryAllocator *mpMemoryAllocator{};
+        Platform *mpPlatform{};
+        std::vector<Slot> mSlots;
+        u32 mWidth{};
+        u32 mHeight{};
+        VkFormat mFormat = VK_FORMAT_UNDEFINED;
+
+        ReadbackCallback mCallback;
+        std::string mCaptureDirectory;
+
+        u64 mFrames{};
+        f64 mFirstSubmitTime{};
+        f64 mLastReadTime{};
+        f64 mLatencySumMs{};
+        f64 mMaxLatencyMs{};
+
+        void Read(Slot &slot, f64 now);
+        void WriteCapture(const ReadbackFrame &frame) const;
+        void DestroyBuffers();
+    };
+}
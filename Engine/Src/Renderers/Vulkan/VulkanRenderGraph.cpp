@@ -0,0 +1,632 @@
+#include "VulkanRenderGraph.h"
+
+namespace Vkr
+{
+	// Accesses that modify memory; everything else only reads it.
+	constexpr VkAccessFlags2 WRITE_ACCESS = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+											VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+	RenderGraphPassBuilder &RenderGraphPassBuilder::Read(RenderGraphResource resource, const RenderGraphUsage &usage)
+	{
+		mpGraph->AddAccess(mPass, resource, usage, true, false);
+		return *this;
+	}
+
+	RenderGraphPassBuilder &RenderGraphPassBuilder::Write(RenderGraphResource resource, const RenderGraphUsage &usage)
+	{
+		mpGraph->AddAccess(mPass, resource, usage, false, true);
+		return *this;
+	}
+
+	RenderGraphPassBuilder &RenderGraphPassBuilder::ColorAttachment(RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkAttachmentStoreOp storeOp,
+																	VkClearColorValue clearValue)
+	{
+		const bool load = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+		RenderGraphUsage usage{VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+							   VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | (load ? VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT : VK_ACCESS_2_NONE),
+							   VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+		mpGraph->AddAccess(mPass, resource, usage, load, true);
+
+		VkClearValue clear{};
+		clear.color = clearValue;
+		mpGraph->mPasses[mPass].colorAttachments.push_back({resource, loadOp, storeOp, clear});
+		return *this;
+	}
+
+	RenderGraphPassBuilder &RenderGraphPassBuilder::DepthAttachment(RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkAttachmentStoreOp storeOp,
+																	VkClearDepthStencilValue clearValue)
+	{
+		// Depth tests read the attachment either way, but only loading it reads what earlier passes wrote.
+		RenderGraphUsage usage{VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+							   VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+							   VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+		mpGraph->AddAccess(mPass, resource, usage, loadOp == VK_ATTACHMENT_LOAD_OP_LOAD, true);
+
+		VkClearValue clear{};
+		clear.depthStencil = clearValue;
+		mpGraph->mPasses[mPass].depthAttachment = {resource, loadOp, storeOp, clear};
+		return *this;
+	}
+
+	RenderGraphPassBuilder &RenderGraphPassBuilder::Execute(RenderGraphExecuteFunction &&execute, VkRenderingFlags renderingFlags)
+	{
+		mpGraph->mPasses[mPass].execute = std::move(execute);
+		mpGraph->mPasses[mPass].renderingFlags = renderingFlags;
+		return *this;
+	}
+
+	void VulkanRenderGraph::Initialize(VkDevice device, const VkAllocationCallbacks *allocator, VulkanMemoryAllocator *memoryAllocator,
+									   VulkanDeletionQueue *deletionQueue)
+	{
+		mDevice = device;
+		mAllocator = allocator;
+		mpMemoryAllocator = memoryAllocator;
+		mpDeletionQueue = deletionQueue;
+	}
+
+	void VulkanRenderGraph::Shutdown()
+	{
+		if (!mDevice)
+			return;
+
+		DestroyTransients(&mTransients);
+		mResources.clear();
+		mPasses.clear();
+		mImportedStates.clear();
+		mDevice = VK_NULL_HANDLE;
+	}
+
+	RenderGraphResource VulkanRenderGraph::ImportImage(const char *name, VkImage image, VkImageView view, const RenderGraphImageDesc &desc, bool discard,
+													   VkPipelineStageFlags2 waitStages, VkImageLayout finalLayout)
+	{
+		Resource resource{name, true, true};
+		resource.imageHandle = image;
+		resource.view = view;
+		resource.desc = desc;
+		resource.finalLayout = finalLayout;
+		resource.discard = discard;
+
+		auto it = mImportedStates.find((u64)image);
+		if (it != mImportedStates.end())
+			resource.state = it->second;
+
+		// Chains the first access to the semaphore wait.
+		resource.state.readStages |= waitStages;
+
+		mResources.push_back(resource);
+		return mResources.size() - 1;
+	}
+
+	RenderGraphResource VulkanRenderGraph::ImportBuffer(const char *name, VkBuffer buffer)
+	{
+		Resource resource{name, false, true};
+		resource.buffer = buffer;
+
+		auto it = mImportedStates.find((u64)buffer);
+		if (it != mImportedStates.end())
+			resource.state = it->second;
+
+		mResources.push_back(resource);
+		return mResources.size() - 1;
+	}
+
+	RenderGraphResource VulkanRenderGraph::CreateImage(const char *name, const RenderGraphImageDesc &desc)
+	{
+		Resource resource{name, true, false};
+		resource.desc = desc;
+		resource.discard = true;
+
+		mResources.push_back(resource);
+		return mResources.size() - 1;
+	}
+
+	RenderGraphPassBuilder VulkanRenderGraph::AddPass(const char *name)
+	{
+		Pass pass{};
+		pass.name = name;
+		mPasses.push_back(std::move(pass));
+		return {this, (u32)mPasses.size() - 1};
+	}
+
+	void VulkanRenderGraph::AddAccess(u32 pass, RenderGraphResource resource, const RenderGraphUsage &usage, bool read, bool write)
+	{
+		VASSERT(resource < mResources.size())
+
+		// One access per resource and pass; the barrier before the pass covers all of them.
+		for (auto &access : mPasses[pass].accesses)
+		{
+			if (access.resource == resource)
+			{
+				VASSERT(!mResources[resource].image || access.usage.layout == usage.layout)
+				access.usage.stages |= usage.stages;
+				access.usage.access |= usage.access;
+				access.read |= read;
+				access.write |= write;
+				return;
+			}
+		}
+
+		mPasses[pass].accesses.push_back({resource, usage, read, write});
+	}
+
+	void VulkanRenderGraph::ForgetImportedResources()
+	{
+		mImportedStates.clear();
+	}
+
+	void VulkanRenderGraph::ForgetImportedImage(VkImage image)
+	{
+		mImportedStates.erase((u64)image);
+	}
+
+	VkImage VulkanRenderGraph::GetImage(RenderGraphResource resource) const
+	{
+		return mResources[resource].imageHandle;
+	}
+
+	VkImageView VulkanRenderGraph::GetImageView(RenderGraphResource resource) const
+	{
+		return mResources[resource].view;
+	}
+
+	void VulkanRenderGraph::CullPasses()
+	{
+		// Imported resources outlive the frame, so writing them is output. Walking backwards, a pass is needed if it writes
+		// something needed, and then whatever it reads is needed too.
+		std::vector<bool> needed(mResources.size());
+		for (u32 i = 0; i < mResources.size(); ++i)
+		{
+			needed[i] = mResources[i].imported;
+		}
+
+		mStats.culledPasses = 0;
+		for (u32 i = mPasses.size(); i-- > 0;)
+		{
+			Pass &pass = mPasses[i];
+			bool contributes = false;
+			for (const auto &access : pass.accesses)
+			{
+				contributes = contributes || (access.write && needed[access.resource]);
+			}
+
+			pass.culled = !contributes || !pass.execute;
+			if (pass.culled)
+			{
+				++mStats.culledPasses;
+				continue;
+			}
+
+			for (const auto &access : pass.accesses)
+			{
+				if (access.read)
+					needed[access.resource] = true;
+			}
+		}
+
+		// Lifetimes of the transient images, in passes that execute.
+		u32 executed = 0;
+		for (const auto &pass : mPasses)
+		{
+			if (pass.culled)
+				continue;
+
+			for (const auto &access : pass.accesses)
+			{
+				Resource &resource = mResources[access.resource];
+				resource.firstPass = VMIN(resource.firstPass, executed);
+				resource.lastPass = VMAX(resource.lastPass, executed);
+			}
+
+			++executed;
+		}
+	}
+
+	StatusCode VulkanRenderGraph::PrepareTransients(u64 frameNumber)
+	{
+		// The images this frame needs; unchanged from the last frame, as is usually the case, the current ones are reused.
+		std::vector<TransientImage> images;
+		for (u32 i = 0; i < mResources.size(); ++i)
+		{
+			Resource &resource = mResources[i];
+			if (resource.imported || resource.firstPass == ~0u)
+				continue;
+
+			resource.transient = images.size();
+			images.push_back({resource.desc, resource.firstPass, resource.lastPass});
+		}
+
+		bool unchanged = images.size() == mTransients.images.size();
+		for (u32 i = 0; unchanged && i < images.size(); ++i)
+		{
+			const TransientImage &a = images[i];
+			const TransientImage &b = mTransients.images[i];
+			unchanged = a.desc.format == b.desc.format && a.desc.width == b.desc.width && a.desc.height == b.desc.height &&
+						a.desc.usage == b.desc.usage && a.desc.aspect == b.desc.aspect && a.firstPass == b.firstPass && a.lastPass == b.lastPass;
+		}
+
+		if (!unchanged)
+		{
+			// Frames in flight may still use the current images.
+			if (!mTransients.images.empty())
+			{
+				auto retired = std::make_shared<Transients>(std::move(mTransients));
+				mpDeletionQueue->Push(frameNumber, [this, retired]() { DestroyTransients(retired.get()); });
+			}
+
+			mTransients = {};
+			mTransients.images = std::move(images);
+
+			std::vector<VkMemoryRequirements> requirements(mTransients.images.size());
+			for (u32 i = 0; i < mTransients.images.size(); ++i)
+			{
+				TransientImage &image = mTransients.images[i];
+
+				VkImageCreateInfo imageCreateInfo{};
+				imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+				imageCreateInfo.format = image.desc.format;
+				imageCreateInfo.extent = {image.desc.width, image.desc.height, 1};
+				imageCreateInfo.mipLevels = 1;
+				imageCreateInfo.arrayLayers = 1;
+				imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+				imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+				imageCreateInfo.usage = image.desc.usage;
+				imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				VK_CHECK(vkCreateImage(mDevice, &imageCreateInfo, mAllocator, &image.image))
+				vkGetImageMemoryRequirements(mDevice, image.image, &requirements[i]);
+			}
+
+			// Largest first, each into the first slot whose images all live at other times.
+			std::vector<u32> order(mTransients.images.size());
+			for (u32 i = 0; i < order.size(); ++i)
+			{
+				order[i] = i;
+			}
+			std::stable_sort(order.begin(), order.end(), [&requirements](u32 a, u32 b) { return requirements[a].size > requirements[b].size; });
+
+			mStats.unaliasedBytes = 0;
+			for (u32 i : order)
+			{
+				TransientImage &image = mTransients.images[i];
+				mStats.unaliasedBytes += requirements[i].size;
+
+				u32 slot = 0;
+				for (; slot < mTransients.slots.size(); ++slot)
+				{
+					const MemorySlot &candidate = mTransients.slots[slot];
+					bool fits = (candidate.requirements.memoryTypeBits & requirements[i].memoryTypeBits) != 0;
+					for (u32 other : candidate.images)
+					{
+						const TransientImage &occupant = mTransients.images[other];
+						fits = fits && (image.lastPass < occupant.firstPass || occupant.lastPass < image.firstPass);
+					}
+
+					if (fits)
+						break;
+				}
+
+				if (slot == mTransients.slots.size())
+				{
+					mTransients.slots.emplace_back();
+					mTransients.slots.back().requirements = requirements[i];
+				}
+
+				MemorySlot &memorySlot = mTransients.slots[slot];
+				memorySlot.requirements.size = VMAX(memorySlot.requirements.size, requirements[i].size);
+				memorySlot.requirements.alignment = VMAX(memorySlot.requirements.alignment, requirements[i].alignment);
+				memorySlot.requirements.memoryTypeBits &= requirements[i].memoryTypeBits;
+				memorySlot.images.push_back(i);
+				image.slot = slot;
+			}
+
+			mStats.transientBytes = 0;
+			for (auto &slot : mTransients.slots)
+			{
+				// Attachments that never leave the tile memory of a tiler need no backing memory at all.
+				bool lazy = true;
+				for (u32 i : slot.images)
+				{
+					lazy = lazy && (mTransients.images[i].desc.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+				}
+
+				StatusCode statusCode = StatusCode::VulkanNoSuitableMemoryType;
+				if (lazy)
+					statusCode = mpMemoryAllocator->AllocateMemory(slot.requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+																   VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, &slot.allocation);
+				if (statusCode != StatusCode::Successful)
+					statusCode = mpMemoryAllocator->AllocateMemory(slot.requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &slot.allocation);
+				if (statusCode != StatusCode::Successful)
+				{
+					VERROR("Failed to allocate %llu bytes for transient images.", (unsigned long long)slot.requirements.size)
+					DestroyTransients(&mTransients);
+					return statusCode;
+				}
+
+				mStats.transientBytes += slot.requirements.size;
+
+				for (u32 i : slot.images)
+				{
+					TransientImage &image = mTransients.images[i];
+					VK_CHECK(vkBindImageMemory(mDevice, image.image, slot.allocation.memory, slot.allocation.offset))
+
+					VkImageViewCreateInfo viewCreateInfo{};
+					viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+					viewCreateInfo.image = image.image;
+					viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+					viewCreateInfo.format = image.desc.format;
+					// Depth only for combined formats, so the view can be sampled as well as rendered to.
+					const VkImageAspectFlags viewAspect = image.desc.aspect & VK_IMAGE_ASPECT_DEPTH_BIT ? VK_IMAGE_ASPECT_DEPTH_BIT : image.desc.aspect;
+					viewCreateInfo.subresourceRange = {viewAspect, 0, 1, 0, 1};
+					VK_CHECK(vkCreateImageView(mDevice, &viewCreateInfo, mAllocator, &image.view))
+				}
+			}
+
+			VDEBUG("Render graph: %u transient images in %u allocations, %llu KiB instead of %llu KiB.", (u32)mTransients.images.size(),
+				   (u32)mTransients.slots.size(), (unsigned long long)(mStats.transientBytes >> 10), (unsigned long long)(mStats.unaliasedBytes >> 10))
+		}
+
+		for (auto &resource : mResources)
+		{
+			if (resource.transient == ~0u)
+				continue;
+
+			resource.imageHandle = mTransients.images[resource.transient].image;
+			resource.view = mTransients.images[resource.transient].view;
+		}
+
+		return StatusCode::Successful;
+	}
+
+	void VulkanRenderGraph::DestroyTransients(Transients *transients)
+	{
+		for (auto &image : transients->images)
+		{
+			if (image.view)
+				vkDestroyImageView(mDevice, image.view, mAllocator);
+			if (image.image)
+				vkDestroyImage(mDevice, image.image, mAllocator);
+		}
+
+		for (auto &slot : transients->slots)
+		{
+			mpMemoryAllocator->Free(&slot.allocation);
+		}
+
+		*transients = {};
+	}
+
+	void VulkanRenderGraph::Synchronize(Resource &resource, const RenderGraphUsage &usage, bool write)
+	{
+		ResourceState &state = resource.state;
+		const bool transition = resource.image && (resource.discard || usage.layout != state.layout);
+
+		// Writes wait for every earlier access; reads only for the last write, unless an earlier barrier already made
+		// it visible to them.
+		bool needed;
+		VkPipelineStageFlags2 srcStages;
+		if (write || transition)
+		{
+			srcStages = state.writeStages | state.readStages;
+			needed = transition || srcStages != 0;
+		}
+		else
+		{
+			srcStages = state.writeStages;
+			needed = srcStages != 0 && ((usage.stages & ~state.readStages) != 0 || (usage.access & ~state.readAccess) != 0);
+		}
+
+		if (needed)
+		{
+			if (resource.image)
+			{
+				VkImageMemoryBarrier2 barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+				barrier.srcStageMask = srcStages ? srcStages : VK_PIPELINE_STAGE_2_NONE;
+				barrier.srcAccessMask = state.writeAccess;
+				barrier.dstStageMask = usage.stages;
+				barrier.dstAccessMask = usage.access;
+				barrier.oldLayout = resource.discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+				barrier.newLayout = usage.layout;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.image = resource.imageHandle;
+				barrier.subresourceRange = {resource.desc.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+				mImageBarriers.push_back(barrier);
+			}
+			else
+			{
+				VkBufferMemoryBarrier2 barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+				barrier.srcStageMask = srcStages;
+				barrier.srcAccessMask = state.writeAccess;
+				barrier.dstStageMask = usage.stages;
+				barrier.dstAccessMask = usage.access;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.buffer = resource.buffer;
+				barrier.offset = 0;
+				barrier.size = VK_WHOLE_SIZE;
+				mBufferBarriers.push_back(barrier);
+			}
+		}
+
+		if (write)
+		{
+			state.writeStages = usage.stages;
+			state.writeAccess = usage.access & WRITE_ACCESS;
+			state.readStages = 0;
+			state.readAccess = 0;
+		}
+		else if (transition)
+		{
+			// The transition is a write, which later reads in other stages chain to through this access.
+			state.writeStages = usage.stages;
+			state.writeAccess = 0;
+			state.readStages = usage.stages;
+			state.readAccess = usage.access;
+		}
+		else
+		{
+			state.readStages |= usage.stages;
+			state.readAccess |= usage.access;
+		}
+
+		state.layout = usage.layout;
+		resource.discard = false;
+	}
+
+	void VulkanRenderGraph::FlushBarriers(VkCommandBuffer commandBuffer)
+	{
+		if (mImageBarriers.empty() && mBufferBarriers.empty())
+			return;
+
+		VkDependencyInfo dependencyInfo{};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.bufferMemoryBarrierCount = mBufferBarriers.size();
+		dependencyInfo.pBufferMemoryBarriers = mBufferBarriers.data();
+		dependencyInfo.imageMemoryBarrierCount = mImageBarriers.size();
+		dependencyInfo.pImageMemoryBarriers = mImageBarriers.data();
+		vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+		mImageBarriers.clear();
+		mBufferBarriers.clear();
+		++mStats.barriers;
+	}
+
+	void VulkanRenderGraph::BeginRendering(VkCommandBuffer commandBuffer, const Pass &pass)
+	{
+		std::array<VkRenderingAttachmentInfo, 8> colorAttachments{};
+		VASSERT(pass.colorAttachments.size() <= colorAttachments.size())
+
+		const RenderGraphImageDesc *extent = nullptr;
+		for (u32 i = 0; i < pass.colorAttachments.size(); ++i)
+		{
+			const Attachment &attachment = pass.colorAttachments[i];
+			const Resource &resource = mResources[attachment.resource];
+			colorAttachments[i].sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+			colorAttachments[i].imageView = resource.view;
+			colorAttachments[i].imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			colorAttachments[i].loadOp = attachment.loadOp;
+			colorAttachments[i].storeOp = attachment.storeOp;
+			colorAttachments[i].clearValue = attachment.clearValue;
+			extent = &resource.desc;
+		}
+
+		VkRenderingAttachmentInfo depthAttachment{};
+		const bool hasDepth = pass.depthAttachment.resource != RENDER_GRAPH_INVALID_RESOURCE;
+		if (hasDepth)
+		{
+			const Resource &resource = mResources[pass.depthAttachment.resource];
+			depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+			depthAttachment.imageView = resource.view;
+			depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+			depthAttachment.loadOp = pass.depthAttachment.loadOp;
+			depthAttachment.storeOp = pass.depthAttachment.storeOp;
+			depthAttachment.clearValue = pass.depthAttachment.clearValue;
+			extent = &resource.desc;
+		}
+
+		VkRenderingInfo renderingInfo{};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+		renderingInfo.flags = pass.renderingFlags;
+		renderingInfo.renderArea.offset = {0, 0};
+		renderingInfo.renderArea.extent = {extent->width, extent->height};
+		renderingInfo.layerCount = 1;
+		renderingInfo.colorAttachmentCount = pass.colorAttachments.size();
+		renderingInfo.pColorAttachments = colorAttachments.data();
+		renderingInfo.pDepthAttachment = hasDepth ? &depthAttachment : nullptr;
+		vkCmdBeginRendering(commandBuffer, &renderingInfo);
+	}
+
+	StatusCode VulkanRenderGraph::Execute(VkCommandBuffer commandBuffer, VulkanGpuProfiler *profiler, u64 frameNumber)
+	{
+		mStats.passes = mPasses.size();
+		mStats.barriers = 0;
+
+		CullPasses();
+		StatusCode statusCode = PrepareTransients(frameNumber);
+		if (statusCode != StatusCode::Successful)
+		{
+			mResources.clear();
+			mPasses.clear();
+			return statusCode;
+		}
+
+		u32 executed = 0;
+		for (auto &pass : mPasses)
+		{
+			if (pass.culled)
+				continue;
+
+			const u32 zone = profiler ? profiler->BeginZone(commandBuffer, pass.name) : 0;
+
+			for (const auto &access : pass.accesses)
+			{
+				Resource &resource = mResources[access.resource];
+
+				// The first image bound to transient memory synchronizes with the last one of the previous frame.
+				MemorySlot *slot = resource.transient != ~0u ? &mTransients.slots[mTransients.images[resource.transient].slot] : nullptr;
+				if (slot && resource.firstPass == executed)
+					resource.state = slot->state;
+
+				Synchronize(resource, access.usage, access.write);
+
+				if (slot)
+					slot->state = resource.state;
+			}
+
+			FlushBarriers(commandBuffer);
+
+			const bool rendering = !pass.colorAttachments.empty() || pass.depthAttachment.resource != RENDER_GRAPH_INVALID_RESOURCE;
+			if (rendering)
+				BeginRendering(commandBuffer, pass);
+
+			pass.execute(commandBuffer);
+
+			if (rendering)
+				vkCmdEndRendering(commandBuffer);
+
+			if (profiler)
+				profiler->EndZone(commandBuffer, zone);
+
+			++executed;
+		}
+
+		// Leave imported images as whatever comes after the frame expects them, e.g. presentation.
+		for (auto &resource : mResources)
+		{
+			if (!resource.imported || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.finalLayout == resource.state.layout)
+				continue;
+
+			VkImageMemoryBarrier2 barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+			barrier.srcStageMask = resource.state.writeStages | resource.state.readStages;
+			barrier.srcAccessMask = resource.state.writeAccess;
+			barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;	// A semaphore signal covers whatever comes next.
+			barrier.dstAccessMask = VK_ACCESS_2_NONE;
+			barrier.oldLayout = resource.discard ? VK_IMAGE_LAYOUT_UNDEFINED : resource.state.layout;
+			barrier.newLayout = resource.finalLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = resource.imageHandle;
+			barrier.subresourceRange = {resource.desc.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+			mImageBarriers.push_back(barrier);
+
+			// Keeps the stages of the last access, so the next frame's first access still waits for them.
+			resource.state.layout = resource.finalLayout;
+		}
+
+		FlushBarriers(commandBuffer);
+
+		for (const auto &resource : mResources)
+		{
+			if (resource.imported)
+				mImportedStates[resource.image ? (u64)resource.imageHandle : (u64)resource.buffer] = resource.state;
+		}
+
+		mResources.clear();
+		mPasses.clear();
+		return StatusCode::Successful;
+	}
+}
@@ -0,0 +1,275 @@
+#pragma once
+#include "Defines.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanMemoryAllocator.h"
+
+namespace Vkr
+{
+    // Handle of a resource declared in the render graph for the current frame.
+    using RenderGraphResource = u32;
+
+    constexpr RenderGraphResource RENDER_GRAPH_INVALID_RESOURCE = ~0u;
+
+    // How a pass accesses a resource: the stages and accesses, and for images the layout they are accessed in.
+    struct RenderGraphUsage
+    {
+        VkPipelineStageFlags2 stages;
+        VkAccessFlags2 access;
+        VkImageLayout layout;           // Ignored for buffers.
+    };
+
+    // Usages most passes need.
+    namespace RenderGraphUsages
+    {
+        inline constexpr RenderGraphUsage ComputeSampled{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        inline constexpr RenderGraphUsage FragmentSampled{VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        inline constexpr RenderGraphUsage ComputeSampledDepth{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                                                              VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+        inline constexpr RenderGraphUsage ComputeStorageRead{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                                                             VK_IMAGE_LAYOUT_GENERAL};
+        inline constexpr RenderGraphUsage ComputeStorageWrite{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                                              VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                                              VK_IMAGE_LAYOUT_GENERAL};
+        inline constexpr RenderGraphUsage IndirectRead{VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                                                       VK_IMAGE_LAYOUT_UNDEFINED};
+        inline constexpr RenderGraphUsage TransferRead{VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                                                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+        inline constexpr RenderGraphUsage TransferWrite{VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+    }
+
+    struct RenderGraphImageDesc
+    {
+        VkFormat format;
+        u32 width;
+        u32 height;
+        VkImageUsageFlags usage;        // Of transient images; imported ones were created elsewhere.
+        VkImageAspectFlags aspect;      // Of barriers and views; depth and stencil for combined formats.
+    };
+
+    struct RenderGraphStats
+    {
+        u32 passes{};                   // Declared in the last frame.
+        u32 culledPasses{};             // Declared, but contributing to nothing the frame outputs.
+        u32 barriers{};                 // vkCmdPipelineBarrier2 calls recorded in the last frame.
+        VkDeviceSize transientBytes{};  // Memory backing the transient images.
+        VkDeviceSize unaliasedBytes{};  // What they would take without aliasing.
+    };
+
+    // Records a pass. Passes with attachments are recorded inside a rendering instance of those attachments.
+    using RenderGraphExecuteFunction = std::function<void(VkCommandBuffer commandBuffer)>;
+
+    class VulkanRenderGraph;
+
+    // Declares what a pass accesses. Returned by VulkanRenderGraph::AddPass; every method returns the builder for chaining.
+    class RenderGraphPassBuilder
+    {
+    public:
+        RenderGraphPassBuilder(VulkanRenderGraph *graph, u32 pass) : mpGraph(graph), mPass(pass) {}
+
+        RenderGraphPassBuilder &Read(RenderGraphResource resource, const RenderGraphUsage &usage);
+        RenderGraphPassBuilder &Write(RenderGraphResource resource, const RenderGraphUsage &usage);
+
+        // Renders to the image; loading its contents makes it a read as well.
+        RenderGraphPassBuilder &ColorAttachment(RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkAttachmentStoreOp storeOp,
+                                                VkClearColorValue clearValue = {});
+        RenderGraphPassBuilder &DepthAttachment(RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkAttachmentStoreOp storeOp,
+                                                VkClearDepthStencilValue clearValue = {1.0f, 0});
+
+        /**
+         * Sets what the pass records.
+         * @param renderingFlags Flags of the rendering instance, e.g. whether secondary command buffers record its contents.
+         */
+        RenderGraphPassBuilder &Execute(RenderGraphExecuteFunction &&execute, VkRenderingFlags renderingFlags = 0);
+
+    private:
+        VulkanRenderGraph *mpGraph;
+        u32 mPass;
+    };
+
+    // The frame as a graph of passes and the resources they access. Every frame the renderer declares its passes in
+    // execution order, and the graph:
+    //  - culls the passes that contribute nothing to the frame's output, i.e. to imported resources,
+    //  - records the barriers and layout transitions between passes, merged into one vkCmdPipelineBarrier2 per pass and
+    //    only where a hazard or a layout change requires one,
+    //  - backs transient images, which live for one frame, with memory shared by those whose lifetimes don't overlap.
+    //
+    // Passes never synchronize with each other themselves; within a pass they synchronize their own commands.
+    //
+    // The state of imported resources is carried over from one frame to the next, so the first access of a frame
+    // synchronizes with the last access of the previous one. Transient images and their memory are kept for as long as
+    // the frame declares the same ones.
+    class VulkanRenderGraph
+    {
+    public:
+        VulkanRenderGraph() = default;
+        ~VulkanRenderGraph() = default;
+
+        VulkanRenderGraph(const VulkanRenderGraph &) = delete;
+        void operator=(VulkanRenderGraph const &) = delete;
+
+        /**
+         * Prepares the graph for use.
+         * @param device The logical device, with synchronization2 enabled.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param memoryAllocator Allocator the transient images' memory comes from.
+         * @param deletionQueue Queue replaced transient images are retired through.
+         */
+        void Initialize(VkDevice device, const VkAllocationCallbacks *allocator, VulkanMemoryAllocator *memoryAllocator,
+                        VulkanDeletionQueue *deletionQueue);
+
+        // Destroys the transient images. The device must be idle.
+        void Shutdown();
+
+        /**
+         * Declares an image created elsewhere for the current frame.
+         * @param view View attachments are rendered through, if the image is used as one.
+         * @param discard Whether the previous contents are not needed, e.g. because the first pass clears them.
+         * @param waitStages Stages the frame's submission waits on a semaphore for before they may access the image.
+         * @param finalLayout Layout the image is left in at the end of the frame, VK_IMAGE_LAYOUT_UNDEFINED for any.
+         */
+        RenderGraphResource ImportImage(const char *name, VkImage image, VkImageView view, const RenderGraphImageDesc &desc, bool discard,
+                                        VkPipelineStageFlags2 waitStages = VK_PIPELINE_STAGE_2_NONE,
+                                        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+        // Declares a buffer created elsewhere for the current frame.
+        RenderGraphResource ImportBuffer(const char *name, VkBuffer buffer);
+
+        // Declares an image that only lives within the current frame. Its contents are undefined at its first access.
+        RenderGraphResource CreateImage(const char *name, const RenderGraphImageDesc &desc);
+
+        // Declares the next pass. Passes execute in the order they are added.
+        RenderGraphPassBuilder AddPass(const char *name);
+
+        /**
+         * Records the passes declared since the last call, with their barriers, and starts declaring the next frame.
+         * @param commandBuffer The frame's primary command buffer.
+         * @param profiler Times each pass, if given.
+         * @param frameNumber The frame being recorded, for retiring transient images the frame no longer declares.
+         * @return Whether the transient images could be allocated; nothing is recorded if not.
+         */
+        StatusCode Execute(VkCommandBuffer commandBuffer, VulkanGpuProfiler *profiler, u64 frameNumber);
+
+        // Forgets the states of imported resources, e.g. once the images were recreated and their handles may be reused.
+        // Only safe once the device is idle; otherwise forget just the retired images.
+        void ForgetImportedResources();
+
+        // Forgets the state of an imported image that is being retired, so a new image reusing its handle starts afresh.
+        void ForgetImportedImage(VkImage image);
+
+        // Image and view of a resource, for the execute function of a pass accessing it.
+        [[nodiscard]] VkImage GetImage(RenderGraphResource resource) const;
+        [[nodiscard]] VkImageView GetImageView(RenderGraphResource resource) const;
+
+        [[nodiscard]] inline RenderGraphStats GetStats() const { return mStats; }
+
+    private:
+        friend class RenderGraphPassBuilder;
+
+        // Accesses since the last write, and the write itself, which the next access synchronizes with.
+        struct ResourceState
+        {
+            VkPipelineStageFlags2 writeStages{};
+            VkAccessFlags2 writeAccess{};
+            VkPipelineStageFlags2 readStages{};     // Reads that already wait for the write.
+            VkAccessFlags2 readAccess{};
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        };
+
+        struct Resource
+        {
+            const char *name;
+            bool image;
+            bool imported;
+            VkImage imageHandle{};
+            VkImageView view{};
+            VkBuffer buffer{};
+            RenderGraphImageDesc desc{};
+            VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            ResourceState state;
+            bool discard = false;                   // The next access doesn't preserve the contents.
+            u32 firstPass = ~0u;                    // Lifetime in executed passes, for aliasing.
+            u32 lastPass = 0;
+            u32 transient = ~0u;                    // Index into the transient images.
+        };
+
+        struct Access
+        {
+            RenderGraphResource resource;
+            RenderGraphUsage usage;
+            bool read;
+            bool write;
+        };
+
+        struct Attachment
+        {
+            RenderGraphResource resource;
+            VkAttachmentLoadOp loadOp;
+            VkAttachmentStoreOp storeOp;
+            VkClearValue clearValue;
+        };
+
+        struct Pass
+        {
+            const char *name;
+            std::vector<Access> accesses;
+            std::vector<Attachment> colorAttachments;
+            Attachment depthAttachment{RENDER_GRAPH_INVALID_RESOURCE};
+            RenderGraphExecuteFunction execute;
+            VkRenderingFlags renderingFlags{};
+            bool culled = false;
+        };
+
+        // A transient image, bound to the memory of one aliasing slot.
+        struct TransientImage
+        {
+            RenderGraphImageDesc desc;
+            u32 firstPass;
+            u32 lastPass;
+            VkImage image{};
+            VkImageView view{};
+            u32 slot{};
+        };
+
+        // Memory shared by transient images with disjoint lifetimes, and the state of its last access, which the first
+        // access of the next image bound to it synchronizes with.
+        struct MemorySlot
+        {
+            VulkanAllocation allocation{};
+            VkMemoryRequirements requirements{};
+            std::vector<u32> images;
+            ResourceState state;
+        };
+
+        struct Transients
+        {
+            std::vector<TransientImage> images;
+            std::vector<MemorySlot> slots;
+        };
+
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        VulkanMemoryAllocator *mpMemoryAllocator{};
+        VulkanDeletionQueue *mpDeletionQueue{};
+
+        std::vector<Resource> mResources;
+        std::vector<Pass> mPasses;
+        std::unordered_map<u64, ResourceState> mImportedStates;     // By handle, carried over between frames.
+        Transients mTransients;
+        RenderGraphStats mStats;
+
+        std::vector<VkImageMemoryBarrier2> mImageBarriers;
+        std::vector<VkBufferMemoryBarrier2> mBufferBarriers;
+
+        void AddAccess(u32 pass, RenderGraphResource resource, const RenderGraphUsage &usage, bool read, bool write);
+        void CullPasses();
+        StatusCode PrepareTransients(u64 frameNumber);
+        void DestroyTransients(Transients *transients);
+        void Synchronize(Resource &resource, const RenderGraphUsage &usage, bool write);
+        void FlushBarriers(VkCommandBuffer commandBuffer);
+        void BeginRendering(VkCommandBuffer commandBuffer, const Pass &pass);
+    };
+}
@@ -1,24 +1,167 @@
 #include "VulkanRenderer.h"
+#include <cmath>
 
 namespace Vkr
 {
 #define LOG_DONE VINFO("\tDone.")
 
+	// A resize burst (e.g. dragging the window border) is applied once no new size has arrived for this long...
+	constexpr f64 RESIZE_SETTLE_SECONDS = 0.1;
+	// ...or, while the burst continues, at most this often so the content keeps up with the window.
+	constexpr f64 RESIZE_MAX_INTERVAL_SECONDS = 0.25;
+	// Fewer draws than this aren't worth a secondary command buffer, and another thread, of their own.
+	constexpr u32 MIN_DRAWS_PER_SLICE = 64;
+
     VKAPI_ATTR VkBool32 VKAPI_CALL VulkanDebugCallback(
         VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
         VkDebugUtilsMessageTypeFlagsEXT messageTypes,
         const VkDebugUtilsMessengerCallbackDataEXT *callbackData,
         void *userData);
 
+	// Barriers on a combined depth/stencil image must cover both aspects.
+	static VkImageAspectFlags GetDepthAspectFlags(VkFormat format)
+	{
+		if (format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT)
+			return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+
+		return VK_IMAGE_ASPECT_DEPTH_BIT;
+	}
+
+	// Formats a device UUID the way tools such as vulkaninfo print it, e.g. 8e0a6c3e-0b2a-4b53-9d0e-f3a1c2d4e5f6.
+	static void FormatDeviceUuid(const u8 uuid[VK_UUID_SIZE], char outText[37])
+	{
+		char *text = outText;
+		for (u32 i = 0; i < VK_UUID_SIZE; ++i)
+		{
+			if (i == 4 || i == 6 || i == 8 || i == 10)
+				*text++ = '-';
+
+			text += snprintf(text, 3, "%02x", uuid[i]);
+		}
+	}
+
+	// Compares a formatted UUID to one given by the user, ignoring case and dashes.
+	static bool DeviceUuidMatches(const char *uuid, const char *requested)
+	{
+		while (*uuid || *requested)
+		{
+			if (*uuid == '-')
+				++uuid;
+			else if (*requested == '-')
+				++requested;
+			else if (tolower(*uuid) != tolower(*requested))
+				return false;
+			else
+				++uuid, ++requested;
+		}
+
+		return true;
+	}
+
+	// What a latency profile picks.
+	struct LatencySettings
+	{
+		const char *name;
+		std::array<VkPresentModeKHR, 2> presentModes;	// In order of preference; FIFO is always supported.
+		u32 extraImages;								// Swapchain images beyond the minimum.
+		u8 framesInFlight;
+		u32 queuedPresents;								// Presents not yet shown when a frame starts, with present_wait.
+		bool lateStart;									// Whether frames start as late as they can still make the vblank.
+	};
+
+	static LatencySettings GetLatencySettings(LatencyProfile profile)
+	{
+		switch (profile)
+		{
+			case LatencyProfile::LowLatency:
+				return {"low latency", {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR}, 0, 1, 1, true};
+			case LatencyProfile::PowerSaving:
+				return {"power saving", {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR}, 0, 2, 2, false};
+			case LatencyProfile::Balanced:
+			default:
+				return {"balanced", {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR}, 1, 2, 2, false};
+		}
+	}
+
+	static const char *GetDeviceTypeName(VkPhysicalDeviceType type)
+	{
+		switch (type)
+		{
+			case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+				return "Integrated";
+			case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+				return "Discrete";
+			case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+				return "Virtual";
+			case VK_PHYSICAL_DEVICE_TYPE_CPU:
+				return "CPU";
+			default:
+				return "Unknown";
+		}
+	}
+
+	// Whether the device has VK_KHR_present_id and VK_KHR_present_wait, and their features.
+	static bool SupportsPresentWait(VkPhysicalDevice device)
+	{
+		u32 extensionCount = 0;
+		if (vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr) != VK_SUCCESS)
+			return false;
+
+		std::vector<VkExtensionProperties> extensions(extensionCount);
+		if (vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data()) != VK_SUCCESS)
+			return false;
+
+		bool presentId = false;
+		bool presentWait = false;
+		for (const auto &extension : extensions)
+		{
+			presentId |= strcmp(extension.extensionName, VK_KHR_PRESENT_ID_EXTENSION_NAME) == 0;
+			presentWait |= strcmp(extension.extensionName, VK_KHR_PRESENT_WAIT_EXTENSION_NAME) == 0;
+		}
+
+		if (!presentId || !presentWait)
+			return false;
+
+		VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+		presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+		VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+		presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+		presentIdFeatures.pNext = &presentWaitFeatures;
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &presentIdFeatures;
+		vkGetPhysicalDeviceFeatures2(device, &features2);
+
+		return presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+	}
+
     VulkanRenderer::VulkanRenderer(const std::shared_ptr<Platform> &platform)
     {
         mPlatform = platform;
     }
 
-    StatusCode VulkanRenderer::Initialize(const char *appName)
+    StatusCode VulkanRenderer::Initialize(const RendererConfig &config)
     {
+		// Startup is timed to tell how much a warm pipeline cache saves.
+		const f64 startTime = mPlatform->GetAbsoluteTime();
+
+		mFrameBufferWidth = config.width;
+		mFrameBufferHeight = config.height;
+
+		// More than 3 frames ahead only adds latency.
+		mLatencyProfile = config.latencyProfile;
+		mOffscreen = config.offscreen;
+		const LatencySettings latency = GetLatencySettings(mLatencyProfile);
+		mSwapchain.maxFramesInFlight = latency.framesInFlight;
+		if (config.framesInFlight != 0)
+			mSwapchain.maxFramesInFlight = VCLAMP(config.framesInFlight, 1, 3);
+
+		// Route the driver's host allocations through the engine.
+		mHostAllocator.SetByteLimit(config.hostMemoryLimit);
+		mAllocator = mHostAllocator.GetCallbacks();
+
 		// Create Vulkan Instance.
-		StatusCode statusCode = CreateVulkanInstance(appName);
+		StatusCode statusCode = CreateVulkanInstance(config.appName);
 		RETURN_ON_FAIL(statusCode)
 
 #if defined(_DEBUG)
@@ -26,21 +169,94 @@ namespace Vkr
 		CreateVulkanDebugger();
 #endif
 
-		// Create Platform specific Vulkan surface.
-		statusCode = CreateVulkanSurface();
-		RETURN_ON_FAIL(statusCode)
+		// Create Platform specific Vulkan surface. Offscreen frames are never presented.
+		if (!mOffscreen)
+		{
+			statusCode = CreateVulkanSurface();
+			RETURN_ON_FAIL(statusCode)
+		}
 
 		// Create Logical device.
-        statusCode = CreateLogicalDevice();
+        statusCode = CreateLogicalDevice(config);
+		RETURN_ON_FAIL(statusCode)
+
+		mFramePacer.Initialize(mDevice.presentWait ? mDevice.logicalDevice : VK_NULL_HANDLE, mPlatform.get(),
+							   latency.queuedPresents, latency.lateStart);
+
+		mMemoryAllocator.Initialize(mDevice.physicalDevice, mDevice.logicalDevice, mAllocator);
+		statusCode = mUploadManager.Initialize(mDevice, &mMemoryAllocator, mAllocator, config.uploadRingSize, config.uploadFrameBudget);
+		RETURN_ON_FAIL(statusCode)
+
+		BindlessLimits bindlessLimits{config.bindlessImages, config.bindlessBuffers, config.bindlessSamplers, config.bindlessStorageImages};
+		statusCode = mBindlessHeap.Initialize(mDevice.physicalDevice, mDevice.logicalDevice, mAllocator, bindlessLimits);
 		RETURN_ON_FAIL(statusCode)
 
-		// Create swapchain.
-		statusCode = CreateSwapchain(mFrameBufferWidth, mFrameBufferHeight);
+		mScene.Initialize(mDevice.logicalDevice, mAllocator, &mMemoryAllocator, &mUploadManager, &mBindlessHeap);
+		mRenderGraph.Initialize(mDevice.logicalDevice, mAllocator, &mMemoryAllocator, &mDeletionQueue);
+
+		mPipelineCache.Initialize(mDevice.logicalDevice, mDevice.properties, mAllocator, config.pipelineCachePath, mPlatform->GetAbsoluteTime());
+		mShaderCompiler.Initialize(config.shaderCacheDirectory);
+		mShaderRegistry.Initialize(mDevice.logicalDevice, mAllocator, config.assetRoot, &mShaderCompiler);
+		mShaderRegistry.OpenPack(config.shaderPack);
+		// A fixed worker count, e.g. for measuring how recording scales with threads.
+		const char *workerThreads = getenv("VKR_WORKER_THREADS");
+		mThreadPool.Initialize(workerThreads ? (u32)strtoul(workerThreads, nullptr, 10) : 0);
+		mPipelineManager.Initialize(mDevice.logicalDevice, mAllocator, &mPipelineCache, &mThreadPool);
+
+		if (config.shaderHotReload)
+			mShaderWatcher.Watch(mShaderRegistry.ResolvePath("Shaders"));
+
+		// Before the swapchain, whose size the culler's depth pyramid follows.
+		if (config.gpuCulling)
+		{
+			statusCode = mCuller.Initialize(mDevice.logicalDevice, mAllocator, &mMemoryAllocator, &mBindlessHeap, &mShaderRegistry,
+											mPipelineCache.GetHandle(), mSwapchain.maxFramesInFlight);
+			RETURN_ON_FAIL(statusCode)
+
+			mGpuCulling = true;
+			mScene.SetCulled(true);
+		}
+
+		// Create swapchain, or the images taking its place.
+		if (mOffscreen)
+		{
+			mReadback.Initialize(mDevice.logicalDevice, mAllocator, &mMemoryAllocator, mPlatform.get(), mSwapchain.maxFramesInFlight);
+			mReadback.SetCaptureDirectory(getenv("VKR_CAPTURE_DIRECTORY"));
+			statusCode = CreateOffscreenTargets(mFrameBufferWidth, mFrameBufferHeight);
+		}
+		else
+		{
+			statusCode = CreateSwapchain(mFrameBufferWidth, mFrameBufferHeight);
+		}
 		RETURN_ON_FAIL(statusCode)
 
-		CreateRenderPass();
 //		CreateGraphicsPipeline();
 
+		CreateFrames();
+		mRecorder.Initialize(mDevice.logicalDevice, mAllocator, mDevice.graphicsQueueIndex, mSwapchain.maxFramesInFlight, &mThreadPool,
+							 MIN_DRAWS_PER_SLICE);
+
+		if (config.gpuProfiling)
+			mGpuProfiler.Initialize(mDevice.physicalDevice, mDevice.logicalDevice, mAllocator, mDevice.properties, mDevice.graphicsQueueIndex,
+									mSwapchain.maxFramesInFlight);
+
+		VINFO("Renderer initialized in %.1f ms, %s pipeline cache.", (mPlatform->GetAbsoluteTime() - startTime) * 1000.0,
+			  mPipelineCache.IsWarm() ? "with a warm" : "without a")
+
+		// A synthetic load for measuring recording cost, see Tools/Benchmark: this many draws every frame, through the draw list.
+		if (const char *benchmarkDraws = getenv("VKR_BENCHMARK_DRAWS"))
+		{
+			CreateGraphicsPipeline();
+			if (!mPipelineManager.Wait(mGraphicsPipeline))
+				VWARN("The benchmark pipeline failed to compile; its draws will be skipped.")
+			mBenchmarkDraws = (u32)strtoul(benchmarkDraws, nullptr, 10);
+			VINFO("Benchmark: %u draws per frame through the draw list.", mBenchmarkDraws)
+		}
+
+		// Or as many scene objects, drawn with one indirect count draw.
+		if (const char *benchmarkObjects = getenv("VKR_BENCHMARK_OBJECTS"))
+			CreateBenchmarkScene((u32)strtoul(benchmarkObjects, nullptr, 10));
+
         return statusCode;
     }
 
@@ -62,8 +278,11 @@ namespace Vkr
 		// Required instance extensions.
 		std::vector<const char *> instanceExtensions;
 		instanceExtensions.reserve(3);
-		instanceExtensions.emplace_back(VK_KHR_SURFACE_EXTENSION_NAME);
-		mPlatform->AddRequiredVulkanExtensions(instanceExtensions);
+		if (!mOffscreen)
+		{
+			instanceExtensions.emplace_back(VK_KHR_SURFACE_EXTENSION_NAME);
+			mPlatform->AddRequiredVulkanExtensions(instanceExtensions);
+		}
 
 #if defined(_DEBUG)
 		instanceExtensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -194,9 +413,39 @@ namespace Vkr
 
     StatusCode VulkanRenderer::Shutdown()
     {
+		// Nothing may be destroyed while the GPU is still using it.
+		vkDeviceWaitIdle(mDevice.logicalDevice);
+		mDeletionQueue.FlushAll();
+
         // Destroy in the opposite order of creation.
-		DestroyRenderPass();			// Destroy Render pass.
+		mGpuProfiler.LogStats();
+		mGpuProfiler.Shutdown();		// Destroy the query pools.
+		mReadback.Poll();				// Read back the last frames, so the stats include them.
+		mReadback.LogStats();
+		mReadback.Shutdown();			// Destroy the readback buffers.
+		mRecorder.LogStats();
+		if (mBenchmarkDraws + mBenchmarkObjects != 0)
+		{
+			const RecorderStats recorderStats = mRecorder.GetStats();
+			const f64 recordMs = recorderStats.frames ? recorderStats.recordMs / recorderStats.frames : 0.0;
+			VINFO("Benchmark: %u draws and %u scene objects, %.3f ms recording per frame, %.2f ns per draw or object.", mBenchmarkDraws,
+				  mBenchmarkObjects, recordMs, recordMs * 1e6 / (mBenchmarkDraws + mBenchmarkObjects))
+		}
+		mRecorder.Shutdown();			// Destroy the per thread command pools.
+		DestroyFrames();				// Destroy per frame resources.
         DestroySwapchain();				// Destroy the swapchain.
+		mPipelineManager.Shutdown();	// Wait for compiles and destroy pipelines.
+		mThreadPool.Shutdown();			// Stop the workers.
+		mShaderRegistry.Shutdown();		// Destroy shader modules.
+		mShaderCompiler.Shutdown();		// Release the GLSL compiler.
+		mCuller.Shutdown();				// Destroy the culling pipelines and the depth pyramid.
+		mPipelineCache.Shutdown();		// Save and destroy the pipeline cache.
+		mRenderGraph.Shutdown();		// Destroy the transient images.
+		mScene.Shutdown();				// Destroy the scene buffers.
+		mUploadManager.Shutdown();		// Destroy the staging ring.
+		mBindlessHeap.Shutdown();		// Destroy the global descriptor set and pipeline layout.
+		mMemoryAllocator.LogStats();
+		mMemoryAllocator.Shutdown();	// Release device memory.
 		DestroyLogicalDevice();			// Destroy logical device.
 		DestroyVulkanSurface();			// Destroy Vulkan Surface.
 
@@ -205,19 +454,34 @@ namespace Vkr
 #endif
 
 		DestroyVulkanInstance();		// Destroys Vulkan instance.
+		mHostAllocator.LogStats();		// Whatever is still in use now was leaked by the driver.
 
         return StatusCode::Successful;
     }
 
-	void VulkanRenderer::DestroyRenderPass(){
-		vkDestroyRenderPass(mDevice.logicalDevice, mRenderPass, mAllocator);
-		mRenderPass = nullptr;
-	}
-
 	void VulkanRenderer::DestroySwapchain()
 	{
 		VDEBUG("Destroying Swapchain.")
-		DestroyImage(&mSwapchain.depthAttachment);
+
+		for (auto semaphore : mSwapchain.renderComplete)
+		{
+			vkDestroySemaphore(mDevice.logicalDevice, semaphore, mAllocator);
+		}
+
+		mSwapchain.renderComplete.clear();
+
+		// Offscreen images are the engine's own.
+		if (mOffscreen)
+		{
+			for (auto &image : mOffscreenImages)
+			{
+				DestroyImage(&image);
+			}
+
+			mOffscreenImages.clear();
+			LOG_DONE
+			return;
+		}
 
 		// Only destroy the views, not the images, since those are owned by the swapchain and are thus
 		// destroyed when it is.
@@ -237,16 +501,14 @@ namespace Vkr
 			vkDestroyImageView(mDevice.logicalDevice, image->view, mAllocator);
 			image->view = nullptr;
 		}
-		if (image->memory)
-		{
-			vkFreeMemory(mDevice.logicalDevice, image->memory, mAllocator);
-			image->memory = nullptr;
-		}
 		if (image->handle)
 		{
 			vkDestroyImage(mDevice.logicalDevice, image->handle, mAllocator);
 			image->handle = nullptr;
 		}
+
+		// Return the memory only once nothing is bound to it anymore.
+		mMemoryAllocator.Free(&image->allocation);
 	}
 
 	void VulkanRenderer::DestroyLogicalDevice()
@@ -341,27 +603,424 @@ namespace Vkr
 
     void VulkanRenderer::OnResize(u16 width, u16 height)
     {
+		if (!mResizePending && width == mFrameBufferWidth && height == mFrameBufferHeight)
+			return;
+
+		// Only record the request; recreating the swapchain for every step of a drag would stall the frame loop.
+		const f64 now = mPlatform->GetAbsoluteTime();
+
+		if (!mResizePending)
+			mResizeStartTime = now;
+
+		mResizePending = true;
+		mPendingWidth = width;
+		mPendingHeight = height;
+		mLastResizeTime = now;
+    }
+
+    bool VulkanRenderer::PaceFrame()
+    {
+		// Skip pacing while a resize is pending; the swapchain is about to be replaced.
+		if (mResizePending)
+			return false;
+
+		return mFramePacer.Wait();
     }
 
     StatusCode VulkanRenderer::BeginFrame(f32 deltaTime)
     {
+		mFrameInProgress = false;
+		VulkanFrame &frame = mFrames[mCurrentFrame];
+
+		const f64 frameStartTime = mPlatform->GetAbsoluteTime();
+		mFrameIntervalMs = mFrameStartTime > 0 ? (frameStartTime - mFrameStartTime) * 1000.0 : 0.0;
+		mFrameStartTime = frameStartTime;
+
+		// Wait until the GPU is done with the last frame recorded into this slot. This only blocks
+		// when the CPU has gotten more than `maxFramesInFlight` frames ahead.
+		VK_CHECK(vkWaitForFences(mDevice.logicalDevice, 1, &frame.inFlight, VK_TRUE, UINT64_MAX))
+		mFenceWaitMs = (mPlatform->GetAbsoluteTime() - frameStartTime) * 1000.0;
+
+		// That frame's copy, and those of any later frames completed since, can be read back now.
+		mReadback.Poll();
+
+		// Reload edited shaders in the background; pipelines switch over as their rebuilds complete.
+		std::vector<std::string> changedShaders;
+		mShaderWatcher.Poll(&changedShaders);
+		for (auto &path : changedShaders)
+		{
+			mThreadPool.Submit([this, path]() { ReloadShader(path); });
+		}
+
+		// Pipelines replaced by rebuilds may still be in use by frames in flight.
+		std::vector<VkPipeline> retiredPipelines;
+		mPipelineManager.TakeRetiredPipelines(&retiredPipelines);
+		mCuller.TakeRetiredPipelines(&retiredPipelines);
+		if (!retiredPipelines.empty())
+		{
+			mDeletionQueue.Push(mFrameNumber, [this, retiredPipelines]()
+			{
+				for (auto pipeline : retiredPipelines)
+				{
+					vkDestroyPipeline(mDevice.logicalDevice, pipeline, mAllocator);
+				}
+			});
+		}
+
+		// Persist newly compiled pipelines every once in a while, in case the application never shuts down cleanly.
+		mPipelineManager.Update();
+		mPipelineCache.Update(mPlatform->GetAbsoluteTime());
+		mGpuProfiler.Update(mPlatform->GetAbsoluteTime());
+
+		// That frame, and every one before it, has completed; destroy what they retired.
+		if (mFrameNumber >= mSwapchain.maxFramesInFlight)
+			mDeletionQueue.Flush(mFrameNumber - mSwapchain.maxFramesInFlight);
+
+		// Queue the uploads of a rebuilt scene; they start with this frame's uploads.
+		mScene.Update(&mDeletionQueue, mFrameNumber);
+
+		if (mResizePending)
+		{
+			// A zero-sized (e.g. minimized) window cannot be presented to, so skip frames until it has a size again.
+			if (mPendingWidth == 0 || mPendingHeight == 0)
+				return StatusCode::Successful;
+
+			const f64 now = mPlatform->GetAbsoluteTime();
+			const bool settled = now - mLastResizeTime >= RESIZE_SETTLE_SECONDS;
+			const bool overdue = now - mResizeStartTime >= RESIZE_MAX_INTERVAL_SECONDS;
+
+			// Until then keep presenting the old swapchain, which the compositor scales to the window.
+			if (settled || overdue)
+			{
+				StatusCode statusCode = RecreateSwapchain(mPendingWidth, mPendingHeight);
+				ENSURE_SUCCESS(statusCode, "Failed to recreate the swapchain.")
+			}
+		}
+
+		// Skip the frame if the swapchain had to be recreated; the next one will use the new swapchain. Offscreen, every
+		// frame in flight has its own image, free once the frame's fence has signaled.
+		if (mOffscreen)
+		{
+			mImageIndex = mCurrentFrame;
+		}
+		else
+		{
+			bool acquired = false;
+			StatusCode statusCode = AcquireNextImageIndex(UINT64_MAX, frame.imageAvailable, VK_NULL_HANDLE, &mImageIndex, &acquired);
+			ENSURE_SUCCESS(statusCode, "Failed to acquire the next swapchain image.")
+
+			if (!acquired)
+				return StatusCode::Successful;
+		}
+
+		// Only reset the fence once work is certain to be submitted with it, or the next wait would never return.
+		VK_CHECK(vkResetFences(mDevice.logicalDevice, 1, &frame.inFlight))
+
+		// Everything allocated from the pool is known to be unused by now.
+		VK_CHECK(vkResetCommandPool(mDevice.logicalDevice, frame.commandPool, 0))
+		mRecorder.BeginFrame(mCurrentFrame);
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;	// Re-recorded every frame.
+		VK_CHECK(vkBeginCommandBuffer(frame.commandBuffer, &beginInfo))
+
+		// Reads the timings of the frame that last used this slot, which has completed.
+		mGpuProfiler.BeginFrame(frame.commandBuffer, mCurrentFrame);
+
+		// Take over what finished uploading, then start this frame's uploads; they overlap with its rendering.
+		{
+			VulkanGpuZone zone(&mGpuProfiler, frame.commandBuffer, "Upload acquire");
+			mUploadManager.RecordAcquires(frame.commandBuffer, &mUploadWaitValue);
+		}
+		mUploadManager.Update();
+
+		// Decided once per frame: the upload may complete while the frame is being recorded, and the scene must not be drawn
+		// from culled buffers culling didn't fill.
+		mSceneReady = mScene.IsReady();
+
+		mFrameInProgress = true;
         return StatusCode::Successful;
     }
 
     StatusCode VulkanRenderer::EndFrame(f32 deltaTime)
     {
+		if (!mFrameInProgress)
+		{
+			mDrawList.clear();
+			return StatusCode::Successful;
+		}
+
+		VulkanFrame &frame = mFrames[mCurrentFrame];
+
+		DrawCommand benchmarkDraw{mGraphicsPipeline, 3};
+		mDrawList.insert(mDrawList.end(), mBenchmarkDraws, benchmarkDraw);
+
+		DeclareFramePasses();
+		StatusCode statusCode = mRenderGraph.Execute(frame.commandBuffer, &mGpuProfiler, mFrameNumber);
+		mDrawList.clear();
+		ENSURE_SUCCESS(statusCode, "Failed to record the frame's passes.")
+
+		mGpuProfiler.EndFrame(frame.commandBuffer, mFrameIntervalMs, mFenceWaitMs);
+		VK_CHECK(vkEndCommandBuffer(frame.commandBuffer))
+
+		// Rendering may start before the image is acquired; only writing the color attachment has to wait.
+		// Acquired uploads are waited on before anything runs; their transfers have already completed.
+		std::array<VkSemaphore, 2> waitSemaphores = {frame.imageAvailable, mUploadManager.GetTimelineSemaphore()};
+		std::array<VkPipelineStageFlags, 2> waitStages = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+		std::array<uint64_t, 2> waitValues = {0, mUploadWaitValue};		// The binary semaphore's value is ignored.
+
+		// Offscreen images are neither acquired nor presented, so there is nothing to wait for or signal.
+		const u32 firstWait = mOffscreen ? 1 : 0;
+		const u32 waitCount = (mUploadWaitValue ? 2 : 1) - firstWait;
+		VkSemaphore renderComplete = mOffscreen ? VK_NULL_HANDLE : mSwapchain.renderComplete[mImageIndex];
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.waitSemaphoreValueCount = waitCount;
+		timelineInfo.pWaitSemaphoreValues = waitValues.data() + firstWait;
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.waitSemaphoreCount = waitCount;
+		submitInfo.pWaitSemaphores = waitSemaphores.data() + firstWait;
+		submitInfo.pWaitDstStageMask = waitStages.data() + firstWait;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &frame.commandBuffer;
+		submitInfo.signalSemaphoreCount = mOffscreen ? 0 : 1;
+		submitInfo.pSignalSemaphores = &renderComplete;
+
+		VK_CHECK(vkQueueSubmit(mDevice.graphicsQueue, 1, &submitInfo, frame.inFlight))
+
+		statusCode = StatusCode::Successful;
+		if (mOffscreen)
+		{
+			mReadback.Submit(mCurrentFrame, mFrameNumber, frame.inFlight);
+		}
+		else
+		{
+			statusCode = Present(renderComplete, mImageIndex);
+			mFramePacer.EndFrame(mGpuProfiler.GetLatest().gpuFrameMs);
+		}
+
+		// The frame was submitted either way, so move on to the next one before reporting a failed present.
+		mFrameInProgress = false;
+		mCurrentFrame = (mCurrentFrame + 1) % mSwapchain.maxFramesInFlight;
+		++mFrameNumber;
+
+		ENSURE_SUCCESS(statusCode, "Failed to present the swapchain image.")
         return StatusCode::Successful;
     }
 
-    StatusCode VulkanRenderer::CreateLogicalDevice()
+	void VulkanRenderer::Draw(const DrawCommand &draw)
+	{
+		mDrawList.push_back(draw);
+	}
+
+	void VulkanRenderer::DeclareFramePasses()
+	{
+		// Both attachments are cleared. The color attachment is first written at the stage the acquire semaphore is
+		// waited on, and is presented afterwards; offscreen, it is copied to a readback buffer instead.
+		RenderGraphImageDesc colorDesc{mSwapchain.imageFormat.format, mFrameBufferWidth, mFrameBufferHeight,
+									   VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_ASPECT_COLOR_BIT};
+		RenderGraphResource color = mOffscreen
+			? mRenderGraph.ImportImage("Offscreen image", mSwapchain.images[mImageIndex], mSwapchain.views[mImageIndex], colorDesc, true)
+			: mRenderGraph.ImportImage("Swapchain image", mSwapchain.images[mImageIndex], mSwapchain.views[mImageIndex], colorDesc, true,
+									   VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+		// The depth only lives within the frame. With culling it is stored and sampled to build the pyramid; without, it is
+		// cleared and discarded within the main pass, so tilers never need to write it out to memory.
+		const VkImageUsageFlags depthUsage = mGpuCulling ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+														 : VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		RenderGraphImageDesc depthDesc{mDevice.depthFormat, mFrameBufferWidth, mFrameBufferHeight, depthUsage, GetDepthAspectFlags(mDevice.depthFormat)};
+		RenderGraphResource depth = mRenderGraph.CreateImage("Depth attachment", depthDesc);
+
+		// This frame's draws of the scene are those of the objects culling finds visible, tested against the pyramid of
+		// the previous frame's depth, which is then rebuilt from this frame's.
+		const bool culling = mGpuCulling && mSceneReady && mCuller.GetPyramid();
+		RenderGraphResource pyramid = RENDER_GRAPH_INVALID_RESOURCE;
+		RenderGraphResource culledCommands = RENDER_GRAPH_INVALID_RESOURCE;
+		RenderGraphResource culledCounts = RENDER_GRAPH_INVALID_RESOURCE;
+		if (culling)
+		{
+			const SceneCullTargets targets = mScene.GetCullTargets();
+			RenderGraphImageDesc pyramidDesc{VK_FORMAT_R32_SFLOAT, mFrameBufferWidth / 2, mFrameBufferHeight / 2,
+											 VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT, VK_IMAGE_ASPECT_COLOR_BIT};
+			pyramid = mRenderGraph.ImportImage("Depth pyramid", mCuller.GetPyramid(), VK_NULL_HANDLE, pyramidDesc, false);
+			culledCommands = mRenderGraph.ImportBuffer("Culled commands", targets.commands);
+			culledCounts = mRenderGraph.ImportBuffer("Culled counts", targets.counts);
+
+			const RenderGraphUsage cullWrite{VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+											 VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+											 VK_IMAGE_LAYOUT_UNDEFINED};
+			const RenderGraphUsage pyramidRead{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+
+			mRenderGraph.AddPass("Culling")
+				.Read(pyramid, pyramidRead)
+				.Write(culledCommands, cullWrite)
+				.Write(culledCounts, cullWrite)
+				.Execute([this](VkCommandBuffer commandBuffer) { mCuller.RecordCulling(commandBuffer, mCurrentFrame, mScene); });
+		}
+
+		// Draws are recorded on the thread pool. The depth is only stored for the pyramid.
+		RenderGraphPassBuilder mainPass = mRenderGraph.AddPass("Main pass");
+		mainPass.ColorAttachment(color, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, {{0.0f, 0.0f, 0.2f, 1.0f}})
+			.DepthAttachment(depth, VK_ATTACHMENT_LOAD_OP_CLEAR, culling ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE)
+			.Execute([this](VkCommandBuffer commandBuffer) { RecordDrawList(commandBuffer); }, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT);
+
+		if (culling)
+		{
+			mainPass.Read(culledCommands, RenderGraphUsages::IndirectRead).Read(culledCounts, RenderGraphUsages::IndirectRead);
+
+			const RenderGraphUsage pyramidWrite{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+												VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+												VK_IMAGE_LAYOUT_GENERAL};
+
+			mRenderGraph.AddPass("Depth pyramid")
+				.Read(depth, RenderGraphUsages::ComputeSampledDepth)
+				.Write(pyramid, pyramidWrite)
+				.Execute([this, depth](VkCommandBuffer commandBuffer)
+				{
+					mCuller.SetDepth(mRenderGraph.GetImageView(depth), &mDeletionQueue, mFrameNumber);
+					mCuller.RecordPyramid(commandBuffer);
+				});
+		}
+
+		if (mOffscreen)
+		{
+			RenderGraphResource readback = mRenderGraph.ImportBuffer("Readback buffer", mReadback.GetBuffer(mCurrentFrame));
+			VkImage image = mSwapchain.images[mImageIndex];
+
+			mRenderGraph.AddPass("Readback")
+				.Read(color, RenderGraphUsages::TransferRead)
+				.Write(readback, RenderGraphUsages::TransferWrite)
+				.Execute([this, image](VkCommandBuffer commandBuffer) { mReadback.RecordCopy(commandBuffer, mCurrentFrame, image); });
+		}
+	}
+
+	void VulkanRenderer::RecordDrawList(VkCommandBuffer commandBuffer)
+	{
+		VkFormat colorFormat = mSwapchain.imageFormat.format;
+
+		// Must match the rendering instance of the main pass.
+		VkCommandBufferInheritanceRenderingInfo renderingInfo{};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+		renderingInfo.colorAttachmentCount = 1;
+		renderingInfo.pColorAttachmentFormats = &colorFormat;
+		renderingInfo.depthAttachmentFormat = mDevice.depthFormat;
+		renderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		// Secondary command buffers inherit no state. Pipelines leave viewport and scissor dynamic; they always cover the
+		// whole frame-buffer. This is the only descriptor set bind of a slice; draws select their resources through push
+		// constants.
+		auto beginSlice = [this](VkCommandBuffer slice)
+		{
+			VkViewport viewport{0.0f, 0.0f, (f32)mFrameBufferWidth, (f32)mFrameBufferHeight, 0.0f, 1.0f};
+			VkRect2D scissor{{0, 0}, {mFrameBufferWidth, mFrameBufferHeight}};
+			vkCmdSetViewport(slice, 0, 1, &viewport);
+			vkCmdSetScissor(slice, 0, 1, &scissor);
+			mBindlessHeap.Bind(slice, VK_PIPELINE_BIND_POINT_GRAPHICS);
+		};
+
+		// The whole scene is a handful of indirect draws, not worth splitting.
+		if (mSceneReady)
+		{
+			mRecorder.Record(commandBuffer, renderingInfo, 1, [this, &beginSlice](VkCommandBuffer slice, u32, u32)
+			{
+				beginSlice(slice);
+				mScene.Record(slice, &mPipelineManager);
+			});
+		}
+
+		mRecorder.Record(commandBuffer, renderingInfo, mDrawList.size(), [this, &beginSlice](VkCommandBuffer slice, u32 first, u32 count)
+		{
+			beginSlice(slice);
+
+			VkPipeline boundPipeline = VK_NULL_HANDLE;
+			for (u32 i = first; i < first + count; ++i)
+			{
+				const DrawCommand &draw = mDrawList[i];
+
+				// Skipped while its pipeline is still compiling, unless there is a fallback.
+				VkPipeline pipeline = mPipelineManager.Get(draw.pipeline);
+				if (pipeline == VK_NULL_HANDLE)
+					continue;
+
+				if (pipeline != boundPipeline)
+				{
+					vkCmdBindPipeline(slice, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+					boundPipeline = pipeline;
+				}
+
+				mBindlessHeap.PushConstants(slice, draw.constants);
+				vkCmdDraw(slice, draw.vertexCount, draw.instanceCount, draw.firstVertex, draw.firstInstance);
+			}
+		});
+	}
+
+	void VulkanRenderer::CreateFrames()
+	{
+		VDEBUG("Creating resources for %u frames in flight.", mSwapchain.maxFramesInFlight)
+		mFrames.resize(mSwapchain.maxFramesInFlight);
+
+		for (auto &frame : mFrames)
+		{
+			// Every frame records into its own pool so the pool can be reset as a whole once the frame completes.
+			VkCommandPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.queueFamilyIndex = mDevice.graphicsQueueIndex;
+			poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			VK_CHECK(vkCreateCommandPool(mDevice.logicalDevice, &poolInfo, mAllocator, &frame.commandPool))
+
+			VkCommandBufferAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.commandPool = frame.commandPool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = 1;
+			VK_CHECK(vkAllocateCommandBuffers(mDevice.logicalDevice, &allocateInfo, &frame.commandBuffer))
+
+			VkSemaphoreCreateInfo semaphoreInfo{};
+			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			VK_CHECK(vkCreateSemaphore(mDevice.logicalDevice, &semaphoreInfo, mAllocator, &frame.imageAvailable))
+
+			// Created signaled, so the first wait on every frame returns immediately.
+			VkFenceCreateInfo fenceInfo{};
+			fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+			fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+			VK_CHECK(vkCreateFence(mDevice.logicalDevice, &fenceInfo, mAllocator, &frame.inFlight))
+		}
+
+		mCurrentFrame = 0;
+		LOG_DONE
+	}
+
+	void VulkanRenderer::DestroyFrames()
+	{
+		VDEBUG("Destroying frame resources.")
+		for (auto &frame : mFrames)
+		{
+			vkDestroyFence(mDevice.logicalDevice, frame.inFlight, mAllocator);
+			vkDestroySemaphore(mDevice.logicalDevice, frame.imageAvailable, mAllocator);
+
+			// Destroying the pool frees its command buffers.
+			vkDestroyCommandPool(mDevice.logicalDevice, frame.commandPool, mAllocator);
+		}
+
+		mFrames.clear();
+		LOG_DONE
+	}
+
+    StatusCode VulkanRenderer::CreateLogicalDevice(const RendererConfig &config)
     {
-        StatusCode statusCode = SelectPhysicalDevice();
+        StatusCode statusCode = SelectPhysicalDevice(config);
         ENSURE_SUCCESS(statusCode, "Failed to create device!")
 
         VDEBUG("Creating logical device.")
         // NOTE: Do not create additional queues for shared indices.
         // This is why std::set is being used on the following line.
-        std::unordered_set<i32> queueFamilyIndices = {mDevice.graphicsQueueIndex, mDevice.presentQueueIndex, mDevice.transferQueueIndex};
+        std::unordered_set<i32> queueFamilyIndices = {mDevice.graphicsQueueIndex, mDevice.presentQueueIndex, mDevice.transferQueueIndex,
+                                                      mDevice.computeQueueIndex};
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
         queueCreateInfos.reserve(queueFamilyIndices.size());
 
@@ -390,15 +1049,59 @@ namespace Vkr
         VkPhysicalDeviceFeatures deviceFeatures = {};
         deviceFeatures.samplerAnisotropy = VK_TRUE; // Request anisotropy
 		deviceFeatures.depthClamp = VK_TRUE;
+		deviceFeatures.multiDrawIndirect = VK_TRUE;             // Scene objects are drawn through indirect commands,
+		deviceFeatures.drawIndirectFirstInstance = VK_TRUE;     // whose first instance selects the object.
+
+        // Dynamic rendering replaces render passes and framebuffers.
+        VkPhysicalDeviceVulkan13Features vulkan13Features = {};
+        vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+        vulkan13Features.dynamicRendering = VK_TRUE;
+        vulkan13Features.synchronization2 = VK_TRUE;    // The render graph records its barriers with vkCmdPipelineBarrier2.
+
+        // Timeline semaphores track uploads.
+        VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+        vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        vulkan12Features.pNext = &vulkan13Features;
+        vulkan12Features.timelineSemaphore = VK_TRUE;
+        // Descriptor indexing for the bindless descriptor set.
+        vulkan12Features.descriptorIndexing = VK_TRUE;
+        vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+        vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+        vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        vulkan12Features.descriptorBindingStorageImageUpdateAfterBind = VK_TRUE;
+        vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        vulkan12Features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+        vulkan12Features.drawIndirectCount = VK_TRUE;   // Indirect draw counts read from a buffer.
+
+        std::vector<const char *> extensionNames;
+        if (!mOffscreen)
+            extensionNames.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
+        // Present ids and waiting on them pace frames, where the device supports them.
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+        presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+        presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+        mDevice.presentWait = !mOffscreen && SupportsPresentWait(mDevice.physicalDevice);
+        if (mDevice.presentWait)
+        {
+            presentIdFeatures.presentId = VK_TRUE;
+            presentWaitFeatures.presentWait = VK_TRUE;
+            presentIdFeatures.pNext = &presentWaitFeatures;
+            vulkan13Features.pNext = &presentIdFeatures;
+            extensionNames.emplace_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            extensionNames.emplace_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        }
 
         VkDeviceCreateInfo deviceCreateInfo = {};
         deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;   // Logical device creation structure.
+        deviceCreateInfo.pNext = &vulkan12Features;                      // Vulkan 1.2 and 1.3 features to enable.
         deviceCreateInfo.queueCreateInfoCount = queueCreateInfos.size(); // Queue create info count.
         deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();    // Queue create info.
         deviceCreateInfo.pEnabledFeatures = &deviceFeatures;             // Device features to enable.
-        deviceCreateInfo.enabledExtensionCount = 1;                      // Enabled extensions count.
-        const char *extensionNames[1] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
-        deviceCreateInfo.ppEnabledExtensionNames = extensionNames; // Enabled extension name.
+        deviceCreateInfo.enabledExtensionCount = extensionNames.size();  // Enabled extensions count.
+        deviceCreateInfo.ppEnabledExtensionNames = extensionNames.data(); // Enabled extension names.
 
         // Deprecated and ignored, so pass nothing.
         deviceCreateInfo.enabledLayerCount = 0;
@@ -413,12 +1116,13 @@ namespace Vkr
         vkGetDeviceQueue(mDevice.logicalDevice, mDevice.graphicsQueueIndex, 0, &mDevice.graphicsQueue);
         vkGetDeviceQueue(mDevice.logicalDevice, mDevice.presentQueueIndex, 0, &mDevice.presentQueue);
         vkGetDeviceQueue(mDevice.logicalDevice, mDevice.transferQueueIndex, 0, &mDevice.transferQueue);
+        vkGetDeviceQueue(mDevice.logicalDevice, mDevice.computeQueueIndex, 0, &mDevice.computeQueue);
         LOG_DONE
 
         return statusCode;
     }
 
-    StatusCode VulkanRenderer::SelectPhysicalDevice()
+    StatusCode VulkanRenderer::SelectPhysicalDevice(const RendererConfig &config)
     {
         // Initialize a variable to hold number of available physical devices that support Vulkan.
         u32 physicalDeviceCount = 0;
@@ -441,108 +1145,217 @@ namespace Vkr
         // configuration.
         DeviceRequirements requirements{};
         requirements.graphics = true;
-        requirements.present = true;
+        requirements.present = !mOffscreen;
         requirements.transfer = true;
-        // NOTE: Enable this if compute will be required.
-        // requirements.compute = true;
+        requirements.compute = true;
         requirements.samplerAnisotropy = true;
-        requirements.discreteGpu = true;
-        requirements.deviceExtensionNames.reserve(1);
-        requirements.deviceExtensionNames.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
-
-        // Try to select the most appropriate device.
+        requirements.discreteGpu = false;				// Ranked by score instead, see `ScorePhysicalDevice`.
+        requirements.cpuDevice = config.allowCpuDevice;
+        requirements.descriptorIndexing = true;
+        requirements.drawIndirectCount = true;
+        requirements.apiVersion = VK_API_VERSION_1_3;		// Dynamic rendering, timeline semaphores.
+        if (!mOffscreen)
+            requirements.deviceExtensionNames.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
+        // Pins the device, e.g. for benchmark runs on hosts with several GPUs. Every candidate's UUID is logged below.
+        const char *forcedUuid = getenv("VKR_DEVICE_UUID");
+        if (forcedUuid && !*forcedUuid)
+            forcedUuid = nullptr;
+
+        struct Candidate
+        {
+            VkPhysicalDevice device{};
+            VkPhysicalDeviceProperties properties{};
+            VkPhysicalDeviceFeatures features{};
+            VkPhysicalDeviceMemoryProperties memory{};
+            QueueFamilyInfo queues{};
+            u64 score{};
+        };
+        Candidate best{};
+
+        // Every device meeting the requirements is scored; the highest score wins, the first one on a tie.
         for (const auto &device : physicalDevices)
         {
-            VkPhysicalDeviceProperties properties;
-            vkGetPhysicalDeviceProperties(device, &properties); // Get device physical properties.
+            VkPhysicalDeviceIDProperties idProperties{};
+            idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+            VkPhysicalDeviceProperties2 properties2{};
+            properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties2.pNext = &idProperties;
+            vkGetPhysicalDeviceProperties2(device, &properties2); // Get device physical properties.
+            const VkPhysicalDeviceProperties &properties = properties2.properties;
+
+            char uuid[37];
+            FormatDeviceUuid(idProperties.deviceUUID, uuid);
+            VINFO("Device candidate: %s (%s, %s)", properties.deviceName, GetDeviceTypeName(properties.deviceType), uuid)
+
+            if (forcedUuid && !DeviceUuidMatches(uuid, forcedUuid))
+            {
+                VINFO("\tNot the device selected by VKR_DEVICE_UUID, skipping.")
+                continue;
+            }
 
-            VkPhysicalDeviceFeatures features;
-            vkGetPhysicalDeviceFeatures(device, &features); // Get physical device features.
+            VkPhysicalDeviceVulkan12Features features12{};
+            features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            VkPhysicalDeviceFeatures2 features2{};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &features12;
+            vkGetPhysicalDeviceFeatures2(device, &features2); // Get physical device features.
+            const VkPhysicalDeviceFeatures &features = features2.features;
 
             VkPhysicalDeviceMemoryProperties memory;
             vkGetPhysicalDeviceMemoryProperties(device, &memory); // Get memory information
 
-            QueueFamilyInfo outQueueFamilyInfo{};
+            QueueFamilyInfo queueFamilyInfo{};
             PhysicalDeviceInfo deviceInfo{};
             deviceInfo.features = &features;
+            deviceInfo.features12 = &features12;
             deviceInfo.properties = &properties;
+            deviceInfo.memory = &memory;
             deviceInfo.requirements = &requirements;
 
             // Check if physical device meets requirements.
-            StatusCode statusCode = PhysicalDeviceMeetsRequirements(device, deviceInfo, &outQueueFamilyInfo);
+            StatusCode statusCode = PhysicalDeviceMeetsRequirements(device, deviceInfo, &queueFamilyInfo);
+            if (statusCode != StatusCode::Successful)
+                continue;
 
-            if (statusCode == StatusCode::Successful)
+            u64 score = ScorePhysicalDevice(device, deviceInfo, queueFamilyInfo, config.preferDiscreteGpu);
+            if (!best.device || score > best.score)
+                best = {device, properties, features, memory, queueFamilyInfo, score};
+        }
+
+        // Ensure a device was selected
+        if (best.device == nullptr)
+        {
+            if (forcedUuid)
             {
-#if defined(_DEBUG)
-                VDEBUG("Selected device: %s", properties.deviceName)
+                VERROR("No device with the UUID '%s' given by VKR_DEVICE_UUID meets the requirements.", forcedUuid)
+                return StatusCode::VulkanForcedDeviceNotFound;
+            }
 
-                // GPU type, etc.
-                switch (properties.deviceType)
-                {
-					case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
-						VINFO("\tGPU type: Integrated")
-						break;
-					case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
-						VINFO("\tGPU type: Discrete")
-						break;
-					case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
-						VINFO("\tGPU type: Virtual")
-						break;
-					case VK_PHYSICAL_DEVICE_TYPE_CPU:
-						VINFO("\tGPU type: CPU")
-						break;
-					default:
-						VINFO("\tGPU type: Unknown")
-						break;
-                }
+            VERROR("No physical devices were found which meet the requirements.")
+            return StatusCode::VulkanNoPhysicalDeviceMeetsRequirements;
+        }
 
-                VINFO("\tGPU Driver version: %d.%d.%d", VK_VERSION_MAJOR(properties.driverVersion), VK_VERSION_MINOR(properties.driverVersion), VK_VERSION_PATCH(properties.driverVersion))
-                VINFO("\tVulkan API version: %d.%d.%d", VK_VERSION_MAJOR(properties.apiVersion), VK_VERSION_MINOR(properties.apiVersion), VK_VERSION_PATCH(properties.apiVersion))
+        const VkPhysicalDeviceProperties &properties = best.properties;
+        VINFO("Selected device: %s (score %llu)", properties.deviceName, (unsigned long long)best.score)
+        if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+            VWARN("Rendering on a CPU implementation; expect it to be slow.")
 
-                // Memory information
-                for (u32 j = 0; j < memory.memoryHeapCount; ++j)
-                {
-                    f32 memorySizeGib = (((f32)memory.memoryHeaps[j].size) / 1024.0f / 1024.0f / 1024.0f);
-                    if (memory.memoryHeaps[j].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
-                    {
-                        VINFO("\tLocal GPU memory: %.2f GiB", memorySizeGib)
-                    }
-                    else
-                    {
-                        VINFO("\tShared System memory: %.2f GiB", memorySizeGib)
-                    }
-                }
+#if defined(_DEBUG)
+        // GPU type, etc.
+        VINFO("\tGPU type: %s", GetDeviceTypeName(properties.deviceType))
+        VINFO("\tGPU Driver version: %d.%d.%d", VK_VERSION_MAJOR(properties.driverVersion), VK_VERSION_MINOR(properties.driverVersion), VK_VERSION_PATCH(properties.driverVersion))
+        VINFO("\tVulkan API version: %d.%d.%d", VK_VERSION_MAJOR(properties.apiVersion), VK_VERSION_MINOR(properties.apiVersion), VK_VERSION_PATCH(properties.apiVersion))
+
+        // Memory information
+        for (u32 j = 0; j < best.memory.memoryHeapCount; ++j)
+        {
+            f32 memorySizeGib = (((f32)best.memory.memoryHeaps[j].size) / 1024.0f / 1024.0f / 1024.0f);
+            if (best.memory.memoryHeaps[j].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            {
+                VINFO("\tLocal GPU memory: %.2f GiB", memorySizeGib)
+            }
+            else
+            {
+                VINFO("\tShared System memory: %.2f GiB", memorySizeGib)
+            }
+        }
 #endif
 
-                mDevice.physicalDevice = device;
-                mDevice.graphicsQueueIndex = outQueueFamilyInfo.graphicsFamilyIndex;
-                mDevice.presentQueueIndex = outQueueFamilyInfo.presentFamilyIndex;
-                mDevice.transferQueueIndex = outQueueFamilyInfo.transferFamilyIndex;
-                // NOTE: set compute index here if needed.
+        mDevice.physicalDevice = best.device;
+        mDevice.graphicsQueueIndex = best.queues.graphicsFamilyIndex;
+        // Offscreen, nothing is presented; the graphics queue stands in so every queue index is valid.
+        mDevice.presentQueueIndex = mOffscreen ? best.queues.graphicsFamilyIndex : best.queues.presentFamilyIndex;
+        mDevice.transferQueueIndex = best.queues.transferFamilyIndex;
+        mDevice.computeQueueIndex = best.queues.computeFamilyIndex;
 
-                // Keep a copy of properties, features and memory info for later use.
-                mDevice.properties = properties;
-                mDevice.features = features;
-                mDevice.memory = memory;
+        // Keep a copy of properties, features and memory info for later use.
+        mDevice.properties = best.properties;
+        mDevice.features = best.features;
+        mDevice.memory = best.memory;
 
-                // We've found and selected a suitable device,
-                // Stop iterating over physical devices.
+        // Checking the requirements left the support of the last candidate checked.
+        if (!mOffscreen)
+            QuerySwapchainSupport(best.device);
+
+        return StatusCode::Successful;
+    }
+
+    u64 VulkanRenderer::ScorePhysicalDevice(VkPhysicalDevice device, const PhysicalDeviceInfo &deviceInfo, const QueueFamilyInfo &queueFamilyInfo,
+                                            bool preferDiscreteGpu)
+    {
+        // The device type decides, then the largest device local heap, then optional features and queue topology. Each
+        // component has its own bits of the score, so a lower one never outweighs a higher one.
+        u64 typeRank;
+        switch (deviceInfo.properties->deviceType)
+        {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+                typeRank = preferDiscreteGpu ? 4 : 3;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+                typeRank = preferDiscreteGpu ? 3 : 4;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+                typeRank = 2;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_CPU:
+                typeRank = 1;
+                break;
+            default:
+                typeRank = 0;
                 break;
-            }
         }
 
-        // Ensure a device was selected
-        if (mDevice.physicalDevice == nullptr)
+        VkDeviceSize deviceLocalBytes = 0;
+        for (u32 i = 0; i < deviceInfo.memory->memoryHeapCount; ++i)
         {
-            VERROR("No physical devices were found which meet the requirements.")
-            return StatusCode::VulkanNoPhysicalDeviceMeetsRequirements;
+            if (deviceInfo.memory->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+                deviceLocalBytes = VMAX(deviceLocalBytes, deviceInfo.memory->memoryHeaps[i].size);
         }
+        const u64 deviceLocalMib = VMIN(deviceLocalBytes >> 20, 0xFFFFFFFFull);
 
-        return StatusCode::Successful;
+        u64 featurePoints = 0;
+        featurePoints += deviceInfo.features->textureCompressionBC ? 4 : 0;
+        featurePoints += deviceInfo.properties->limits.timestampComputeAndGraphics ? 4 : 0;	// GPU profiling.
+        for (u32 i = 0; i < deviceInfo.memory->memoryTypeCount; ++i)
+        {
+            if (deviceInfo.memory->memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+            {
+                featurePoints += 2;		// Transient attachments.
+                break;
+            }
+        }
+
+        // Queues of their own let uploads and compute run alongside rendering.
+        u32 queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+        VkQueueFamilyProperties queueFamilies[queueFamilyCount];
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies);
+
+        const VkQueueFlags computeFlags = queueFamilies[queueFamilyInfo.computeFamilyIndex].queueFlags;
+        const VkQueueFlags transferFlags = queueFamilies[queueFamilyInfo.transferFamilyIndex].queueFlags;
+        u64 queuePoints = 0;
+        queuePoints += !(computeFlags & VK_QUEUE_GRAPHICS_BIT) ? 16 : 0;
+        queuePoints += !(transferFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) ? 16 : 0;
+        queuePoints += queueFamilyInfo.presentFamilyIndex == queueFamilyInfo.graphicsFamilyIndex ? 8 : 0;
+
+        const u64 score = (typeRank << 40) | (deviceLocalMib << 8) | (featurePoints + queuePoints);
+        VINFO("\tScore %llu: type rank %llu, %llu MiB device local, %llu feature points, %llu queue points.", (unsigned long long)score,
+              (unsigned long long)typeRank, (unsigned long long)deviceLocalMib, (unsigned long long)featurePoints, (unsigned long long)queuePoints)
+
+        return score;
     }
 
     StatusCode VulkanRenderer::PhysicalDeviceMeetsRequirements(VkPhysicalDevice device, const PhysicalDeviceInfo &deviceInfo, QueueFamilyInfo *outQueueFamilyInfo)
     {
+        // Vulkan version?
+        if (deviceInfo.properties->apiVersion < deviceInfo.requirements->apiVersion)
+        {
+            VINFO("Device does not support Vulkan %d.%d, skipping.", VK_VERSION_MAJOR(deviceInfo.requirements->apiVersion),
+                  VK_VERSION_MINOR(deviceInfo.requirements->apiVersion))
+            return StatusCode::VulkanApiVersionNotSupported;
+        }
+
         // Discrete GPU?
         if (deviceInfo.requirements->discreteGpu)
         {
@@ -553,6 +1366,13 @@ namespace Vkr
             }
         }
 
+        // Software implementation?
+        if (!deviceInfo.requirements->cpuDevice && deviceInfo.properties->deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+        {
+            VINFO("Device is a CPU implementation, and those are not allowed. Skipping.")
+            return StatusCode::VulkanCpuDeviceNotAllowed;
+        }
+
         // Initialize variable to hold queue family count.
         u32 queueFamilyCount = 0;
         // Get queue family count.
@@ -578,7 +1398,8 @@ namespace Vkr
 
                 // If also a presentation queue, this prioritizes grouping of the 2.
                 VkBool32 supportsPresent = VK_FALSE;
-                VK_CHECK(vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &supportsPresent))
+                if (deviceInfo.requirements->present)
+                    VK_CHECK(vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &supportsPresent))
 
                 if (supportsPresent)
                 {
@@ -587,10 +1408,12 @@ namespace Vkr
                 }
             }
 
-            // Compute queue?
+            // Compute queue? A family without graphics is preferred; its queue runs alongside the graphics queue.
             if (queueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT)
             {
-                outQueueFamilyInfo->computeFamilyIndex = i;
+                if (outQueueFamilyInfo->computeFamilyIndex == -1 || !(queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+                    outQueueFamilyInfo->computeFamilyIndex = i;
+
                 ++currentTransferScore;
             }
 
@@ -609,7 +1432,7 @@ namespace Vkr
 
         // If a present queue hasn't been found, iterate again and take the first one.
         // This should only happen if there is a queue that supports graphics but NOT present.
-        if (outQueueFamilyInfo->presentFamilyIndex == -1)
+        if (outQueueFamilyInfo->presentFamilyIndex == -1 && deviceInfo.requirements->present)
         {
             for (i32 i = 0; i < queueFamilyCount; ++i)
             {
@@ -650,12 +1473,15 @@ namespace Vkr
             VINFO("\tCompute Family Index: %i", outQueueFamilyInfo->computeFamilyIndex)
 
             // Query swapchain support.
-            QuerySwapchainSupport(device);
-
-            if (mDevice.swapchainSupport.formats.empty() || mDevice.swapchainSupport.presentModes.empty())
+            if (deviceInfo.requirements->present)
             {
-                VINFO("Required swapchain support not present, skipping device.")
-                return StatusCode::VulkanRequiredSwapchainNotSupported;
+                QuerySwapchainSupport(device);
+
+                if (mDevice.swapchainSupport.formats.empty() || mDevice.swapchainSupport.presentModes.empty())
+                {
+                    VINFO("Required swapchain support not present, skipping device.")
+                    return StatusCode::VulkanRequiredSwapchainNotSupported;
+                }
             }
 
             // Device extensions.
@@ -698,6 +1524,28 @@ namespace Vkr
                 return StatusCode::VulkanSamplerAnisotropyNotSupported;
             }
 
+            // Descriptor indexing, for the bindless descriptor set.
+            if (deviceInfo.requirements->descriptorIndexing)
+            {
+                const VkPhysicalDeviceVulkan12Features *features12 = deviceInfo.features12;
+                if (!features12->descriptorIndexing || !features12->runtimeDescriptorArray || !features12->descriptorBindingPartiallyBound ||
+                    !features12->descriptorBindingSampledImageUpdateAfterBind || !features12->descriptorBindingStorageBufferUpdateAfterBind ||
+                    !features12->descriptorBindingStorageImageUpdateAfterBind ||
+                    !features12->shaderSampledImageArrayNonUniformIndexing || !features12->shaderStorageBufferArrayNonUniformIndexing)
+                {
+                    VINFO("Device does not support bindless descriptor indexing, skipping.")
+                    return StatusCode::VulkanDescriptorIndexingNotSupported;
+                }
+            }
+
+            // Indirect draws with their count in a buffer, for GPU-driven rendering.
+            if (deviceInfo.requirements->drawIndirectCount &&
+                (!deviceInfo.features12->drawIndirectCount || !deviceInfo.features->multiDrawIndirect || !deviceInfo.features->drawIndirectFirstInstance))
+            {
+                VINFO("Device does not support indirect draw counts, skipping.")
+                return StatusCode::VulkanDrawIndirectCountNotSupported;
+            }
+
             // Device meets all requirements.
             return StatusCode::Successful;
         }
@@ -710,6 +1558,10 @@ namespace Vkr
         // Surface capabilities
         VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &mDevice.swapchainSupport.capabilities))
 
+        // Called for every candidate device; nothing may be left over from the previous one.
+        mDevice.swapchainSupport.formats.clear();
+        mDevice.swapchainSupport.presentModes.clear();
+
         // Surface formats
         u32 formatCount = 0;
         VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, nullptr))
@@ -731,11 +1583,10 @@ namespace Vkr
         }
     }
 
-    StatusCode VulkanRenderer::CreateSwapchain(u32 width, u32 height)
+    StatusCode VulkanRenderer::CreateSwapchain(u32 width, u32 height, VkSwapchainKHR oldSwapchain)
     {
         VDEBUG("Creating swapchain.")
         VkExtent2D swapchainExtent = {width, height};
-        mSwapchain.maxFramesInFlight = 2;
 
         // Choose a swap surface format.
         bool found = false;
@@ -755,18 +1606,28 @@ namespace Vkr
             mSwapchain.imageFormat = mDevice.swapchainSupport.formats[0];
         }
 
+        // Re-query swapchain support.
+        QuerySwapchainSupport(mDevice.physicalDevice);
+
+        // The latency profile picks the present mode, falling back to FIFO which is always supported.
+        const LatencySettings latency = GetLatencySettings(mLatencyProfile);
         VkPresentModeKHR presentationMode = VK_PRESENT_MODE_FIFO_KHR;
-        for (const auto &p : mDevice.swapchainSupport.presentModes)
+        found = false;
+        for (const auto &preferred : latency.presentModes)
         {
-            if (p == VK_PRESENT_MODE_MAILBOX_KHR)
+            for (const auto &p : mDevice.swapchainSupport.presentModes)
             {
-                presentationMode = p;
-                break;
+                if (p == preferred)
+                {
+                    presentationMode = p;
+                    found = true;
+                    break;
+                }
             }
-        }
 
-        // Re-query swapchain support.
-        QuerySwapchainSupport(mDevice.physicalDevice);
+            if (found)
+                break;
+        }
 
         // Swapchain extent
         if (mDevice.swapchainSupport.capabilities.currentExtent.width != UINT32_MAX)
@@ -780,12 +1641,19 @@ namespace Vkr
         swapchainExtent.width = VCLAMP(swapchainExtent.width, min.width, max.width);
         swapchainExtent.height = VCLAMP(swapchainExtent.height, min.height, max.height);
 
-        u32 imageCount = mDevice.swapchainSupport.capabilities.minImageCount + 1;
+        // Mailbox needs an image to render to besides the one shown and the one queued; every extra image under FIFO
+        // is another frame of latency.
+        u32 imageCount = mDevice.swapchainSupport.capabilities.minImageCount + latency.extraImages;
+        imageCount = VMAX(imageCount, presentationMode == VK_PRESENT_MODE_MAILBOX_KHR ? 3u : 2u);
         if (mDevice.swapchainSupport.capabilities.maxImageCount > 0 && imageCount > mDevice.swapchainSupport.capabilities.maxImageCount)
         {
             imageCount = mDevice.swapchainSupport.capabilities.maxImageCount;
         }
 
+        VINFO("Latency profile: %s, %s with %u images, %u frames in flight, %s.", latency.name,
+              presentationMode == VK_PRESENT_MODE_MAILBOX_KHR ? "mailbox" : "FIFO", imageCount,
+              (u32)mSwapchain.maxFramesInFlight, mFramePacer.IsEnabled() ? "paced with present_wait" : "unpaced")
+
         // Swapchain create info
         VkSwapchainCreateInfoKHR swapchainCreateInfo{};
         swapchainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -820,14 +1688,12 @@ namespace Vkr
             swapchainCreateInfo.pQueueFamilyIndices = nullptr;
         }
 
-        // If old swapchain has been destroyed and this one replaces it,
-        // then link the old one to quickly hand over responsibilities.
-        swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
+        // If this swapchain replaces an old one, link the old one to quickly hand over responsibilities.
+        // The old swapchain is retired by this call, but its images may still be in use by frames in flight.
+        swapchainCreateInfo.oldSwapchain = oldSwapchain;
 
         VK_CHECK(vkCreateSwapchainKHR(mDevice.logicalDevice, &swapchainCreateInfo, mAllocator, &mSwapchain.handle))
-
-        // Start with a zero frame index.
-        mCurrentFrame = 0;
+        mFramePacer.Reset(mSwapchain.handle);
 
         // Images
         mSwapchain.imageCount = 0;
@@ -856,39 +1722,150 @@ namespace Vkr
             VK_CHECK(vkCreateImageView(mDevice.logicalDevice, &viewInfo, mAllocator, &mSwapchain.views[i]))
         }
 
-        // Depth resources
-        if (!DetectDepthFormat())
+        // A semaphore per image rather than per frame in flight: presentation doesn't signal anything, so a
+        // semaphore is only known to be free again once its image has been acquired again.
+        mSwapchain.renderComplete.resize(mSwapchain.imageCount);
+
+        for (auto &semaphore : mSwapchain.renderComplete)
         {
-            mDevice.depthFormat = VK_FORMAT_UNDEFINED;
-            VFATAL("Failed to find a supported format!")
+            VkSemaphoreCreateInfo semaphoreInfo{};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            VK_CHECK(vkCreateSemaphore(mDevice.logicalDevice, &semaphoreInfo, mAllocator, &semaphore))
         }
 
-        // Create depth image and its view.
+        StatusCode statusCode = PrepareDepth(swapchainExtent.width, swapchainExtent.height);
+        ENSURE_SUCCESS(statusCode, "Failed to prepare the depth attachment.")
+
+        mFrameBufferWidth = swapchainExtent.width;
+        mFrameBufferHeight = swapchainExtent.height;
+
+        LOG_DONE
+
+		return StatusCode::Successful;
+    }
+
+    StatusCode VulkanRenderer::CreateOffscreenTargets(u32 width, u32 height)
+    {
+        VDEBUG("Creating offscreen render targets.")
+
+        // The format a swapchain is preferably created with, which every device can render to and copy from.
+        mSwapchain.imageFormat = {VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
+        mSwapchain.imageCount = mSwapchain.maxFramesInFlight;
+        mSwapchain.images.resize(mSwapchain.imageCount);
+        mSwapchain.views.resize(mSwapchain.imageCount);
+        mOffscreenImages.resize(mSwapchain.imageCount);
+
         ImageInfo imageInfo{};
         imageInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageInfo.width = swapchainExtent.width;
-        imageInfo.height = swapchainExtent.height;
-        imageInfo.format = mDevice.depthFormat;
+        imageInfo.width = width;
+        imageInfo.height = height;
+        imageInfo.format = mSwapchain.imageFormat.format;
         imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-        imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
         imageInfo.memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
         imageInfo.createView = true;
-        imageInfo.viewAspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
-        CreateImage(imageInfo, &mSwapchain.depthAttachment);
+        imageInfo.viewAspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+
+        for (u32 i = 0; i < mSwapchain.imageCount; ++i)
+        {
+            CreateImage(imageInfo, &mOffscreenImages[i]);
+            mSwapchain.images[i] = mOffscreenImages[i].handle;
+            mSwapchain.views[i] = mOffscreenImages[i].view;
+        }
+
+        StatusCode statusCode = PrepareDepth(width, height);
+        ENSURE_SUCCESS(statusCode, "Failed to prepare the depth attachment.")
+
+        mFrameBufferWidth = width;
+        mFrameBufferHeight = height;
+
+        statusCode = mReadback.Resize(width, height, mSwapchain.imageFormat.format);
+        ENSURE_SUCCESS(statusCode, "Failed to create the readback buffers.")
 
         LOG_DONE
+        return StatusCode::Successful;
+    }
 
-		return StatusCode::Successful;
+    StatusCode VulkanRenderer::PrepareDepth(u32 width, u32 height)
+    {
+        // The depth attachment itself is a transient image of the render graph; only its format is chosen here.
+        if (!DetectDepthFormat())
+        {
+            mDevice.depthFormat = VK_FORMAT_UNDEFINED;
+            VFATAL("Failed to find a supported format!")
+        }
+
+        if (mGpuCulling)
+        {
+            StatusCode statusCode = mCuller.Resize(width, height, &mDeletionQueue, mFrameNumber);
+            ENSURE_SUCCESS(statusCode, "Failed to create the depth pyramid.")
+        }
+
+        return StatusCode::Successful;
     }
 
-    void VulkanRenderer::RecreateSwapchain(u32 width, u32 height)
+    StatusCode VulkanRenderer::RecreateSwapchain(u32 width, u32 height)
     {
-        DestroySwapchain();
-        CreateSwapchain(width, height);
+        // Offscreen targets are only resized on request, never through a drag, so simply wait for the frames using them.
+        if (mOffscreen)
+        {
+            vkDeviceWaitIdle(mDevice.logicalDevice);
+            DestroySwapchain();
+
+            StatusCode statusCode = CreateOffscreenTargets(width, height);
+            mRenderGraph.ForgetImportedResources();
+            mResizePending = false;
+
+            return statusCode;
+        }
+
+        // Hold on to the outgoing swapchain's resources; frames still in flight may reference them.
+        VkSwapchainKHR oldHandle = mSwapchain.handle;
+        std::vector<VkImageView> oldViews(mSwapchain.views.begin(), mSwapchain.views.begin() + mSwapchain.imageCount);
+        std::vector<VkSemaphore> oldRenderComplete = std::move(mSwapchain.renderComplete);
+        std::vector<VkImage> oldImages(mSwapchain.images.begin(), mSwapchain.images.begin() + mSwapchain.imageCount);
+        VkImage oldPyramid = mCuller.GetPyramid();
+        mSwapchain.renderComplete.clear();
+
+        // Pipelines only know the attachment formats, so nothing else needs rebuilding.
+        StatusCode statusCode = CreateSwapchain(width, height, oldHandle);
+
+        // Later images may reuse the retired handles, in whose states they are not. Only those are forgotten: frames in
+        // flight still access the buffers, which the next frame has to synchronize with. The depth attachment is the
+        // graph's own, recreated once the frame declares it at the new size.
+        for (const auto &image : oldImages)
+        {
+            mRenderGraph.ForgetImportedImage(image);
+        }
+        if (oldPyramid != mCuller.GetPyramid())
+            mRenderGraph.ForgetImportedImage(oldPyramid);
+
+        // The old swapchain is retired either way, so it is destroyed once the current frame has completed
+        // instead of waiting for the device to go idle.
+        mDeletionQueue.Push(mFrameNumber, [this, oldHandle, oldViews, oldRenderComplete]()
+        {
+            for (const auto &semaphore : oldRenderComplete)
+            {
+                vkDestroySemaphore(mDevice.logicalDevice, semaphore, mAllocator);
+            }
+
+            for (const auto &view : oldViews)
+            {
+                vkDestroyImageView(mDevice.logicalDevice, view, mAllocator);
+            }
+
+            vkDestroySwapchainKHR(mDevice.logicalDevice, oldHandle, mAllocator);
+        });
+
+        mResizePending = false;
+
+        return statusCode;
     }
 
-    bool VulkanRenderer::AcquireNextImageIndex(u64 nanoSeconds, VkSemaphore imageAvailableSemaphore, VkFence fence, u32 *outImageIndex)
+    StatusCode VulkanRenderer::AcquireNextImageIndex(u64 nanoSeconds, VkSemaphore imageAvailableSemaphore, VkFence fence, u32 *outImageIndex,
+                                                     bool *outAcquired)
     {
+        *outAcquired = false;
         VkResult result = vkAcquireNextImageKHR(
             mDevice.logicalDevice,
             mSwapchain.handle,
@@ -899,20 +1876,20 @@ namespace Vkr
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR)
         {
-            // Trigger swapchain recreation, then boot out of the render loop.
-            RecreateSwapchain(mFrameBufferWidth, mFrameBufferHeight);
-            return false;
+            // The swapchain can no longer be used at all, so recreate it right away, then boot out of the render loop.
+            return RecreateSwapchain(mResizePending ? mPendingWidth : mFrameBufferWidth, mResizePending ? mPendingHeight : mFrameBufferHeight);
         }
         else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
         {
             VFATAL("Failed to acquire swapchain image!")
-            return false;
+            return StatusCode::VulkanAcquireFailed;
         }
 
-        return true;
+        *outAcquired = true;
+        return StatusCode::Successful;
     }
 
-    void VulkanRenderer::Present(VkSemaphore renderCompleteSemaphore, u32 presentImageIndex)
+    StatusCode VulkanRenderer::Present(VkSemaphore renderCompleteSemaphore, u32 presentImageIndex)
     {
         // Return the image to the swapchain for presentation.
         VkPresentInfoKHR presentInfo = {VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
@@ -923,16 +1900,41 @@ namespace Vkr
         presentInfo.pImageIndices = &presentImageIndex;
         presentInfo.pResults = nullptr;
 
+        // Tag the present so the frame pacer can wait for it to be shown.
+        VkPresentIdKHR presentId = {VK_STRUCTURE_TYPE_PRESENT_ID_KHR};
+        uint64_t id = 0;
+        if (mFramePacer.IsEnabled())
+        {
+            id = mFramePacer.NextPresentId();
+            presentId.swapchainCount = 1;
+            presentId.pPresentIds = &id;
+            presentInfo.pNext = &presentId;
+        }
+
         VkResult result = vkQueuePresentKHR(mDevice.presentQueue, &presentInfo);
-        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
         {
-            // Swapchain is out of date, suboptimal or a frame-buffer resize has occurred. Trigger swapchain recreation.
-            RecreateSwapchain(mFrameBufferWidth, mFrameBufferHeight);
+            // Swapchain is out of date and can't be presented to anymore. Recreate it right away.
+            return RecreateSwapchain(mResizePending ? mPendingWidth : mFrameBufferWidth, mResizePending ? mPendingHeight : mFrameBufferHeight);
+        }
+        else if (result == VK_SUBOPTIMAL_KHR)
+        {
+            // Still presentable, most likely mid-resize. Let the pending resize settle instead of recreating every frame.
+            if (!mResizePending)
+            {
+                mResizePending = true;
+                mPendingWidth = mFrameBufferWidth;
+                mPendingHeight = mFrameBufferHeight;
+                mResizeStartTime = mLastResizeTime = mPlatform->GetAbsoluteTime();
+            }
         }
         else if (result != VK_SUCCESS)
         {
             VFATAL("Failed to present swap chain image!")
+            return StatusCode::VulkanPresentFailed;
         }
+
+        return StatusCode::Successful;
     }
 
     void VulkanRenderer::CreateImage(const ImageInfo &imageInfo, VulkanImage *outImage)
@@ -940,43 +1942,43 @@ namespace Vkr
         // Copy params
         outImage->width = imageInfo.width;
         outImage->height = imageInfo.height;
+        outImage->mipLevels = imageInfo.mipLevels;
+        outImage->arrayLayers = imageInfo.arrayLayers;
 
         // Creation info.
         VkImageCreateInfo imageCreateInfo = {};
         imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.imageType = imageInfo.imageType;
         imageCreateInfo.extent.width = imageInfo.width;
         imageCreateInfo.extent.height = imageInfo.height;
         imageCreateInfo.extent.depth = 1; // TODO: Support configurable depth.
-        imageCreateInfo.mipLevels = 4;    // TODO: Support mip mapping
-        imageCreateInfo.arrayLayers = 1;  // TODO: Support number of layers in the image.
+        imageCreateInfo.mipLevels = imageInfo.mipLevels;
+        imageCreateInfo.arrayLayers = imageInfo.arrayLayers;
         imageCreateInfo.format = imageInfo.format;
         imageCreateInfo.tiling = imageInfo.tiling;
         imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         imageCreateInfo.usage = imageInfo.usage;
-        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;         // TODO: Configurable sample count.
+        imageCreateInfo.samples = imageInfo.samples;
         imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // TODO: Configurable sharing mode.
 
         VK_CHECK(vkCreateImage(mDevice.logicalDevice, &imageCreateInfo, mAllocator, &outImage->handle))
 
-        // Query memory requirements.
-        VkMemoryRequirements memoryRequirements;
-        vkGetImageMemoryRequirements(mDevice.logicalDevice, outImage->handle, &memoryRequirements);
-
-        i32 memoryType = FindMemoryIndex(memoryRequirements.memoryTypeBits, imageInfo.memoryFlags);
-        if (memoryType == -1)
+        // Lazily allocated memory is only committed as far as tile memory doesn't suffice, which for transient attachments
+        // is usually not at all. Desktop GPUs don't have it; there the attachment is regular memory.
+        VkMemoryPropertyFlags memoryFlags = imageInfo.memoryFlags;
+        if (memoryFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
         {
-            VERROR("Required memory type not found. Image not valid.")
+            VkMemoryRequirements requirements;
+            vkGetImageMemoryRequirements(mDevice.logicalDevice, outImage->handle, &requirements);
+            if (mMemoryAllocator.FindMemoryType(requirements.memoryTypeBits, memoryFlags) == -1)
+                memoryFlags &= ~VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
         }
 
-        // Allocate memory
-        VkMemoryAllocateInfo memoryAllocateInfo = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-        memoryAllocateInfo.allocationSize = memoryRequirements.size;
-        memoryAllocateInfo.memoryTypeIndex = memoryType;
-        VK_CHECK(vkAllocateMemory(mDevice.logicalDevice, &memoryAllocateInfo, mAllocator, &outImage->memory))
-
-        // Bind the memory
-        VK_CHECK(vkBindImageMemory(mDevice.logicalDevice, outImage->handle, outImage->memory, 0)) // TODO: configurable memory offset.
+        // Allocate and bind memory.
+        if (mMemoryAllocator.AllocateImageMemory(outImage->handle, memoryFlags, &outImage->allocation) != StatusCode::Successful)
+        {
+            VERROR("Failed to allocate image memory. Image not valid.")
+        }
 
         // Create view
         if (imageInfo.createView)
@@ -991,325 +1993,146 @@ namespace Vkr
         VkImageViewCreateInfo viewCreateInfo = {};
         viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewCreateInfo.image = image->handle;
-        viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D; // TODO: Make configurable.
+        viewCreateInfo.viewType = image->arrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
         viewCreateInfo.format = format;
         viewCreateInfo.subresourceRange.aspectMask = aspectFlags;
 
-        // TODO: Make configurable
+        // Every mip level and layer of the image.
         viewCreateInfo.subresourceRange.baseMipLevel = 0;
-        viewCreateInfo.subresourceRange.levelCount = 1;
+        viewCreateInfo.subresourceRange.levelCount = image->mipLevels;
         viewCreateInfo.subresourceRange.baseArrayLayer = 0;
-        viewCreateInfo.subresourceRange.layerCount = 1;
+        viewCreateInfo.subresourceRange.layerCount = image->arrayLayers;
 
         VK_CHECK(vkCreateImageView(mDevice.logicalDevice, &viewCreateInfo, mAllocator, &image->view))
     }
 
-    i32 VulkanRenderer::FindMemoryIndex(u32 typeFilter, u32 propertyFlags) const
-    {
-        VkPhysicalDeviceMemoryProperties memoryProperties;
-        vkGetPhysicalDeviceMemoryProperties(mDevice.physicalDevice, &memoryProperties);
-
-        for (i32 i = 0; i < memoryProperties.memoryTypeCount; ++i)
-        {
-            // Check each memory type to see if its bit is set to 1.
-            if (typeFilter & (1 << i) && (memoryProperties.memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags)
-            {
-                return i;
-            }
-        }
-
-        VWARN("Unable to find suitable memory type!")
-        return -1;
-    }
-
     void VulkanRenderer::CreateGraphicsPipeline()
     {
-        auto vertexShaderCode = ReadFile("/home/raj/Projects/Vulkyrie/Assets/Shaders/vert.spv");
-        auto fragmentShaderCode = ReadFile("/home/raj/Projects/Vulkyrie/Assets/Shaders/frag.spv");
-
-        // Build Shader module to link to the graphics pipeline.
-		VkShaderModule vertexShaderModule = CreateShaderModule(vertexShaderCode);
-		VkShaderModule fragmentShaderModule = CreateShaderModule(fragmentShaderCode);
-
-		// Create Pipeline.
-		// Vertex Stage creation information.
-		VkPipelineShaderStageCreateInfo vertexShaderCreateInfo{};
-		vertexShaderCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		vertexShaderCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;				// Shader stage name.
-		vertexShaderCreateInfo.module = vertexShaderModule;						// Shader module to be used by stage.
-		vertexShaderCreateInfo.pName = "main";									// Entry point into shader.// 1. Vertex Stage creation information.
-
-		// Fragment stage creation information.
-		VkPipelineShaderStageCreateInfo fragmentShaderCreateInfo{};
-		fragmentShaderCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		fragmentShaderCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;			// Shader stage name.
-		fragmentShaderCreateInfo.module = fragmentShaderModule;					// Shader module to be used by stage.
-		fragmentShaderCreateInfo.pName = "main";								// Entry point into shader.
-
-		// Put shader stages creation info into an array.
-		// Graphics pipeline creation info requires an array of shader stage creates.
-		VkPipelineShaderStageCreateInfo shaderStages[] = { vertexShaderCreateInfo, fragmentShaderCreateInfo };
-
-		// --- VERTEX INPUT ---
-		VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{};
-		vertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputStateCreateInfo.vertexBindingDescriptionCount = 0;
-		vertexInputStateCreateInfo.pVertexBindingDescriptions = nullptr;	// List of vertex binding descriptions (data spacing/stride information).
-		vertexInputStateCreateInfo.vertexAttributeDescriptionCount = 0;
-		vertexInputStateCreateInfo.pVertexAttributeDescriptions = nullptr;	// List of vertex attribute descriptions. (data format that we are using and where to bind to/from).
-
-		// --- INPUT ASSEMBLY ---
-		VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo{};
-		pipelineInputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		pipelineInputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;	// Primitive type to assemble vertices as.
-		pipelineInputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;					// Allow overriding of strip" topology to start new primitives.
-
-
-		// ==================================================================================
-		// --- VIEWPORT AND SCISSOR ---
-		// Create viewport info struct.
-		VkViewport viewport{};
-		viewport.x = 0.0f;					// X start coordinate.
-		viewport.y = 0.0f;					// Y start coordinate.
-		// TODO: COME BACK AND FINISH THIS BASED ON THE UDEMY COURSE.
-//		viewport.width = (float)mSwapchain.
-//		viewport.height = (float)mSwapchain.
-		viewport.minDepth = 0.0f;			// min fame buffer depth.
-		viewport.maxDepth = 1.0f;			// max fame buffer depth.
-
-		// Create a scissor info struct.
-		VkRect2D scissor{};
-		scissor.offset = { 0, 0 };	// Offset to use region from.
-		// TODO: COME BACK AND FINISH THIS BASED ON THE UDEMY COURSE.
-//		scissor.extent =
-		// ==================================================================================
-
-		VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
-		viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportStateCreateInfo.viewportCount = 1;
-		viewportStateCreateInfo.pViewports = &viewport;
-		viewportStateCreateInfo.scissorCount = 1;
-		viewportStateCreateInfo.pScissors = &scissor;
-
-
-		//==========================================================================================
-		// TODO: ENABLE THIS WHEN RESIZING WINDOW.
-//		std::vector<VkDynamicState> dynamicStateEnables;
-//		dynamicStateEnables.reserve(2);
-//		dynamicStateEnables.emplace_back(VK_DYNAMIC_STATE_VIEWPORT);
-//		dynamicStateEnables.emplace_back(VK_DYNAMIC_STATE_SCISSOR);
-//
-//		VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
-//		dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-//		dynamicStateCreateInfo.dynamicStateCount = dynamicStateEnables.size();
-//		dynamicStateCreateInfo.pDynamicStates = dynamicStateEnables.data();
-		//==========================================================================================
-
-		// --- RASTERIZER ---
-		VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo{};
-		rasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterizationStateCreateInfo.depthClampEnable = VK_FALSE;			// Change if fragments beyond near/far planes are clipped (default) or clamped to plane.
-		rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;	// Whether to discard data and skip rasterizer. Never creates fragments, only suitable for pipeline without framebuffer output.
-		rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;	// How to handle filling points between vertices.
-		rasterizationStateCreateInfo.lineWidth = 1.0f;						// How thick the lines should be when drawn.
-		rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;		// Which face of the tri to cull.
-		rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;	// Winding to determine which side is the front.
-		rasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;			// Whether to add depth bias to fragments (good for stopping "shadow acne" in shadow mapping.)
-
-		// --- MULTISAMPLING ---
-		VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo{};
-		multisampleStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisampleStateCreateInfo.sampleShadingEnable = VK_FALSE;					// Enable multisample shading or not.
-		multisampleStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;	// Number of fragments to use per fragment.
-
-
-		// --- BLENDING ---
-		// Blending decides how to blend a new color being written to a fragment. with the old value.
-
-		// Blend attachment state.
-		VkPipelineColorBlendAttachmentState colorState{};
-		colorState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colorState.blendEnable = VK_TRUE;
-
-		// Blending uses equation: (srcColorBlendFactor * new color) colorBlendOp (dstColorBlendFactor * old color)
-		colorState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-		colorState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-		colorState.colorBlendOp = VK_BLEND_OP_ADD;
+		// From the shader pack; compiled from source if the pack is missing or out of date.
+		VulkanShader vertexShader, fragmentShader;
+		if (mShaderRegistry.Load("Shaders/test.vert", &vertexShader) != StatusCode::Successful ||
+			mShaderRegistry.Load("Shaders/test.frag", &fragmentShader) != StatusCode::Successful)
+		{
+			VERROR("Failed to load the graphics pipeline's shaders.")
+			return;
+		}
+
+		GraphicsPipelineInfo pipelineInfo{};
+		pipelineInfo.stages.push_back({VK_SHADER_STAGE_VERTEX_BIT, vertexShader.module, vertexShader.hash});
+		pipelineInfo.stages.push_back({VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader.module, fragmentShader.hash});
 
 		// Summarised: (VK_BLEND_FACTOR_SRC_ALPHA * new color) + (VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA * old color)
 		// Or to summarize: (new color alpha * new color) + ((1 - new color alpha) * old color)
-		colorState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-		colorState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-		colorState.alphaBlendOp = VK_BLEND_OP_ADD;				// In summary: new alpha = (1 * alpha) + (0 * old alpha)
-
-
-		VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo{};
-		colorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
-		colorBlendStateCreateInfo.attachmentCount = 1;
-		colorBlendStateCreateInfo.pAttachments = &colorState;
-
-		// --- PIPELINE LAYOUTS TODO: Apply future descriptor set updates.
-		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
-		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutCreateInfo.setLayoutCount = 0;
-		pipelineLayoutCreateInfo.pSetLayouts = nullptr;
-		pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-		pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
-
-		// --- CREATE PIPELINE LAYOUT ---
-		VK_CHECK(vkCreatePipelineLayout(mDevice.logicalDevice, &pipelineLayoutCreateInfo, mAllocator, &pipelineLayout))
-
-		// --- DEPTH STENCIL TESTING ---
-		// TODO: SET UP DEPTH STENCIL TESTING.
-
-		// --- GRAPHICS PIPELINE CREATION ---
-		VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
-		pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineCreateInfo.stageCount = 2;													// NUmber of shader stages.
-		pipelineCreateInfo.pStages = shaderStages;											// List of shader stages.
-		pipelineCreateInfo.pVertexInputState = &vertexInputStateCreateInfo;					// All the fixes function pipeline states.
-		pipelineCreateInfo.pInputAssemblyState = &pipelineInputAssemblyStateCreateInfo;
-		pipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
-		pipelineCreateInfo.pDynamicState = nullptr;
-		pipelineCreateInfo.pRasterizationState = &rasterizationStateCreateInfo;
-		pipelineCreateInfo.pMultisampleState = &multisampleStateCreateInfo;
-		pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
-		pipelineCreateInfo.pDepthStencilState = nullptr;
-		pipelineCreateInfo.layout = pipelineLayout;											// Pipeline layout the pipeline should use.
-		pipelineCreateInfo.renderPass = mRenderPass;										// Render pass description the pipeline is compatible with.
-		pipelineCreateInfo.subpass = 0;														// Subpass of render pass to use with pipeline.
-
-		// Pipeline derivatives - Can create multiple pipeline that can derive from one another for optimization.
-		pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;								// Existing pipeline to derive from.
-		pipelineCreateInfo.basePipelineIndex = -1;											// Or index of pipeline being created to derived from. (in case of creating multiple at once.)
-
-		VK_CHECK(vkCreateGraphicsPipelines(mDevice.logicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, mAllocator, &mGraphicsPipeline))
-
-		// Shader modules are not required after pipeline is created so we can go ahead and destroy them now.
-		vkDestroyShaderModule(mDevice.logicalDevice, fragmentShaderModule, mAllocator);
-		vkDestroyShaderModule(mDevice.logicalDevice, vertexShaderModule, mAllocator);
+		pipelineInfo.blendEnable = true;
+
+		pipelineInfo.layout = mBindlessHeap.GetPipelineLayout();		// Every pipeline shares the bindless layout.
+		pipelineInfo.colorFormats = {mSwapchain.imageFormat.format};	// Attachments the pipeline renders to.
+		pipelineInfo.depthFormat = mDevice.depthFormat;
+
+		// Compiles in the background; draws skip the pipeline until it is ready.
+		mGraphicsPipeline = mPipelineManager.RequestGraphicsPipeline(pipelineInfo);
     }
 
-	void VulkanRenderer::DestroyGraphicsPipeline(){
-		vkDestroyPipeline(mDevice.logicalDevice, mGraphicsPipeline, mAllocator);
-	}
+	void VulkanRenderer::CreateBenchmarkScene(u32 objectCount)
+	{
+		VulkanShader vertexShader, fragmentShader;
+		if (objectCount == 0 || mShaderRegistry.Load("Shaders/scene.vert", &vertexShader) != StatusCode::Successful ||
+			mShaderRegistry.Load("Shaders/scene.frag", &fragmentShader) != StatusCode::Successful)
+		{
+			VERROR("Failed to create the benchmark scene.")
+			return;
+		}
 
-	void VulkanRenderer::DestroyPipeline() {
-		vkDestroyPipelineLayout(mDevice.logicalDevice, pipelineLayout, mAllocator);
-	}
+		GraphicsPipelineInfo pipelineInfo{};
+		pipelineInfo.stages.push_back({VK_SHADER_STAGE_VERTEX_BIT, vertexShader.module, vertexShader.hash});
+		pipelineInfo.stages.push_back({VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader.module, fragmentShader.hash});
+		pipelineInfo.cullMode = VK_CULL_MODE_NONE;
+		pipelineInfo.depthTest = true;
+		pipelineInfo.depthWrite = true;
+		pipelineInfo.layout = mBindlessHeap.GetPipelineLayout();
+		pipelineInfo.colorFormats = {mSwapchain.imageFormat.format};
+		pipelineInfo.depthFormat = mDevice.depthFormat;
+
+		PipelineHandle pipeline = mPipelineManager.RequestGraphicsPipeline(pipelineInfo);
+		if (!mPipelineManager.Wait(pipeline))
+			VWARN("The benchmark pipeline failed to compile; the scene will not be drawn.")
+
+		// A unit cube, with its own vertices per face for flat normals.
+		std::vector<SceneVertex> vertices;
+		std::vector<u32> indices;
+		for (u32 axis = 0; axis < 3; ++axis)
+		{
+			for (f32 side : {-0.5f, 0.5f})
+			{
+				const u32 first = vertices.size();
+				for (u32 corner = 0; corner < 4; ++corner)
+				{
+					SceneVertex vertex{};
+					vertex.position[axis] = side;
+					vertex.position[(axis + 1) % 3] = corner & 1 ? 0.5f : -0.5f;
+					vertex.position[(axis + 2) % 3] = corner & 2 ? 0.5f : -0.5f;
+					vertex.normal[axis] = side * 2.0f;
+					vertex.uv[0] = corner & 1 ? 1.0f : 0.0f;
+					vertex.uv[1] = corner & 2 ? 1.0f : 0.0f;
+					vertices.push_back(vertex);
+				}
 
-	VkShaderModule VulkanRenderer::CreateShaderModule(const std::vector<char> &code)
-    {
-		VkShaderModuleCreateInfo shaderModuleCreateInfo{};
-		shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		shaderModuleCreateInfo.codeSize = code.size();									// Size of code.
-		shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());	// Pointer to code (of type uint32_t type)
+				indices.insert(indices.end(), {first, first + 1, first + 2, first + 2, first + 1, first + 3});
+			}
+		}
+
+		mScene.Clear();
+		MeshId cube = mScene.AddMesh(vertices.data(), vertices.size(), indices.data(), indices.size());
 
-		VkShaderModule shaderModule;
-		VK_CHECK(vkCreateShaderModule(mDevice.logicalDevice, &shaderModuleCreateInfo, mAllocator, &shaderModule))
+		// A square grid filling the view; with an identity view-projection, clip space is world space.
+		const u32 side = (u32)std::ceil(std::sqrt((f64)objectCount));
+		const f32 cell = 2.0f / side;
+		for (u32 i = 0; i < objectCount; ++i)
+		{
+			SceneObject object{};
+			object.mesh = cube;
+			object.pipeline = pipeline;
+
+			const f32 scale = cell * 0.8f;
+			object.transform[0] = scale;
+			object.transform[5] = scale;
+			object.transform[10] = scale;
+			object.transform[12] = -1.0f + cell * ((f32)(i % side) + 0.5f);
+			object.transform[13] = -1.0f + cell * ((f32)(i / side) + 0.5f);
+			object.transform[14] = 0.5f;
+			object.transform[15] = 1.0f;
+			mScene.AddObject(object);
+		}
 
-		return shaderModule;
+		mScene.Build();
+		mBenchmarkObjects = objectCount;
+		VINFO("Benchmark: %u scene objects drawn through indirect commands.", objectCount)
 	}
 
-	void VulkanRenderer::CreateRenderPass() {
-		u32 attachmentCount = 2;
-		VkAttachmentDescription attachmentDescriptions[attachmentCount];
-
-		VkAttachmentDescription colorAttachment{};
-		colorAttachment.format = mSwapchain.imageFormat.format;				// format to use for attachment.
-		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;					// Number of samples to write for multisampling.
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;				// Describes what to do with attachment before rendering.
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;				// Describes what to do with attachment after rendering.
-		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;	// Describes what to do with stencil before rendering.
-		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;	// Describes what to do with stencil after rendering.
-
-		// Framebuffer data will be stored as an image. But image can be given different data layouts.
-		// to give optimal use for certain operations.
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;			// Image data layout before render pass starts.
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;		// Image data layout after render pass starts.
-		colorAttachment.flags = 0;
-
-		attachmentDescriptions[0] = colorAttachment;
-
-		// Attachment reference uses an attachment index that refers to the attachment list passed to renderPassCreateInfo.
-		VkAttachmentReference colorAttachmentReference{};
-		colorAttachmentReference.attachment = 0;							// Attachment description arry index.
-		colorAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkAttachmentDescription depthAttachment{};
-		depthAttachment.format = mDevice.depthFormat;
-		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		attachmentDescriptions[1] = depthAttachment;
-
-		VkAttachmentReference depthAttachmentReference{};
-		depthAttachmentReference.attachment = 1;
-		depthAttachmentReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		// Information about a particular subpass the Render pass s using.
-		VkSubpassDescription subpassDescription{};
-		subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;		// Pipeline type sub-pass needs to be bound to.
-		subpassDescription.colorAttachmentCount = 1;
-		subpassDescription.pColorAttachments = &colorAttachmentReference;
-		subpassDescription.pDepthStencilAttachment = &depthAttachmentReference;
-		subpassDescription.inputAttachmentCount = 0;
-		subpassDescription.pInputAttachments = nullptr;
-		subpassDescription.pResolveAttachments = nullptr;
-		subpassDescription.preserveAttachmentCount = 0;
-		subpassDescription.pPreserveAttachments = nullptr;
-
-		// Need to determine when layout transitions occur using subpass dependencies.
-		std::array<VkSubpassDependency, 2> subpassDependencies{};
-
-		// Conversion from VK_IMAGE_LAYOUT_UNDEFINED to VK_IMAGE_LAYER_COLOR_ATTACHMENT_OPTIMAL
-		// Transition must happen after...
-		subpassDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-		subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-		subpassDependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-
-		// but must happen before.
-		subpassDependencies[0].dstSubpass = 0;
-		subpassDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		subpassDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		subpassDependencies[0].dependencyFlags = 0;
-
-		// Conversion from VK_IMAGE_LAYER_COLOR_ATTACHMENT_OPTIMAL to VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
-		// Transition must happen after...
-		subpassDependencies[1].srcSubpass = 0;
-		subpassDependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		subpassDependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-		// but must happen before.
-		subpassDependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-		subpassDependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-		subpassDependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-		subpassDependencies[1].dependencyFlags = 0;
-
-		// Create info for render pass.
-		VkRenderPassCreateInfo renderPassCreateInfo{};
-		renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassCreateInfo.attachmentCount = attachmentCount;
-		renderPassCreateInfo.pAttachments = attachmentDescriptions;
-		renderPassCreateInfo.subpassCount = 1;
-		renderPassCreateInfo.pSubpasses = &subpassDescription;
-		renderPassCreateInfo.dependencyCount = subpassDependencies.size();
-		renderPassCreateInfo.pDependencies = subpassDependencies.data();
-		renderPassCreateInfo.pNext = nullptr;
-		renderPassCreateInfo.flags = 0;
-
-		VK_CHECK(vkCreateRenderPass(mDevice.logicalDevice, &renderPassCreateInfo, mAllocator, &mRenderPass))
+	void VulkanRenderer::ReloadShader(const std::string &path)
+	{
+		std::vector<std::pair<u64, VulkanShader>> changed;
+		if (mShaderRegistry.Reload(path, &changed) != StatusCode::Successful)
+		{
+			VWARN("Keeping the previous version of '%s'.", path.c_str())
+			return;
+		}
+
+		for (const auto &[oldHash, shader] : changed)
+		{
+			mPipelineManager.ReplaceShader(oldHash, shader);
+			if (mGpuCulling)
+				mCuller.ReplaceShader(oldHash, shader);
+		}
+
+		if (!changed.empty())
+			VINFO("Reloaded '%s'.", path.c_str())
 	}
 
 
 
 
+
     VKAPI_ATTR VkBool32 VKAPI_CALL VulkanDebugCallback(
         VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
         VkDebugUtilsMessageTypeFlagsEXT messageTypes,
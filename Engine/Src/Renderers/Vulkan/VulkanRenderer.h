@@ -6,7 +6,27 @@
 #include "VulkanSwapchain.h"
 #include "ImageInfo.h"
 #include "PhysicalDeviceInfo.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanFrame.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanHostAllocator.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanPipelineManager.h"
+#include "VulkanShaderRegistry.h"
+#include "VulkanShaderCompiler.h"
+#include "VulkanUploadManager.h"
+#include "VulkanBindlessHeap.h"
+#include "VulkanParallelRecorder.h"
+#include "DrawCommand.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanGpuScene.h"
+#include "VulkanGpuCuller.h"
+#include "VulkanRenderGraph.h"
+#include "VulkanFramePacer.h"
+#include "VulkanReadback.h"
+#include "Core/Threading/ThreadPool.h"
 #include "Platform/Platform.h"
+#include "Platform/FileWatcher.h"
 
 namespace Vkr
 {
@@ -16,30 +36,76 @@ namespace Vkr
         explicit VulkanRenderer(const std::shared_ptr<Platform> &platform);
         DESTRUCTOR_LOG(VulkanRenderer);
 
-        StatusCode Initialize(const char *appName) override;
+        StatusCode Initialize(const RendererConfig &config) override;
         StatusCode Shutdown() override;
         void OnResize(u16 width, u16 height) override;
         StatusCode BeginFrame(f32 deltaTime) override;
         StatusCode EndFrame(f32 deltaTime) override;
+        bool PaceFrame() override;
 
+        // Queues a draw for the frame being recorded. Draws are recorded in parallel at the end of the frame, in queue order.
+        void Draw(const DrawCommand &draw);
+
+        // Opaque geometry drawn with indirect commands every frame.
+        inline VulkanGpuScene &GetScene() { return mScene; }
+
+        // Frames read back to the host, in offscreen mode.
+        inline VulkanReadbackRing &GetReadback() { return mReadback; }
 
     private:
         std::shared_ptr<Platform> mPlatform; 		// Underlying platform instance.
         VkSurfaceKHR surface{};              		// Vulkan Surface KHR
         VkInstance mInstance{};              		// Vulkan Instance
-        VkAllocationCallbacks *mAllocator{}; 		// Custom memory allocator
+        VulkanHostAllocator mHostAllocator;			// Serves and tracks the driver's host allocations.
+        VkAllocationCallbacks *mAllocator{}; 		// Custom memory allocator, handed to every vkCreate*/vkDestroy* call.
         VulkanDevice mDevice;                		// Vulkan Devices metadata
+        VulkanMemoryAllocator mMemoryAllocator;		// Sub-allocates device memory for images and buffers.
+        VulkanUploadManager mUploadManager;			// Streams data to device memory on the transfer queue.
         VulkanSwapchain mSwapchain{};        		// Vulkan swapchain metadata.
 
-		VkRenderPass mRenderPass{};					// Render Pass.
-		VkPipelineLayout pipelineLayout{};			// Pipeline layout.
-		VkPipeline mGraphicsPipeline{};				// Graphics pipeline.
+		VulkanBindlessHeap mBindlessHeap;			// Global descriptor set and the pipeline layout shared by every pipeline.
+		PipelineHandle mGraphicsPipeline{};			// Graphics pipeline.
+		VulkanPipelineCache mPipelineCache;			// Compiled pipelines, persisted between runs.
+		ThreadPool mThreadPool;						// Workers for background renderer jobs.
+		VulkanPipelineManager mPipelineManager;		// Compiles pipelines on the thread pool.
+		VulkanShaderRegistry mShaderRegistry;		// Shader modules, shared by content.
+		VulkanShaderCompiler mShaderCompiler;		// Compiles GLSL shaders, caching the results on disk.
+		FileWatcher mShaderWatcher;					// Reports edited shaders, for hot reloading.
 
 		u32 mFrameBufferWidth{};             		// The frame-buffer's current width.
         u32 mFrameBufferHeight{};            		// The frame-buffer's current height.
-        u32 mImageIndex{};
-        u32 mCurrentFrame{};
-        [[nodiscard]] i32 FindMemoryIndex(u32 typeFilter, u32 propertyFlags) const;
+        u32 mImageIndex{};							// Swapchain image acquired for the current frame.
+        u32 mCurrentFrame{};						// Index of the frame in flight being recorded.
+		std::vector<VulkanFrame> mFrames;			// Per frame in flight resources.
+		VulkanParallelRecorder mRecorder;			// Records the draw list on the thread pool.
+		std::vector<DrawCommand> mDrawList;			// Draws queued for the current frame.
+		u32 mBenchmarkDraws{};						// Synthetic draws added to every frame, from VKR_BENCHMARK_DRAWS.
+		u32 mBenchmarkObjects{};					// Synthetic scene objects, from VKR_BENCHMARK_OBJECTS.
+		VulkanGpuScene mScene;						// Objects drawn GPU-driven, through indirect commands.
+		VulkanGpuCuller mCuller;					// Culls the scene on the GPU.
+		bool mGpuCulling = false;					// Whether the scene is culled.
+		bool mSceneReady = false;					// Whether the current frame draws the scene.
+		VulkanGpuProfiler mGpuProfiler;				// Times frames and passes on the GPU.
+		VulkanRenderGraph mRenderGraph;				// Orders and synchronizes the passes of a frame.
+		LatencyProfile mLatencyProfile{};			// Picks the present mode, swapchain images and frame pacing.
+		VulkanFramePacer mFramePacer;				// Starts frames no earlier than presentation can take them.
+		bool mOffscreen = false;					// Whether frames are rendered into mOffscreenImages instead of the swapchain.
+		std::vector<VulkanImage> mOffscreenImages;	// Images rendered to in offscreen mode, one per frame in flight.
+		VulkanReadbackRing mReadback;				// Copies offscreen frames back to the host.
+		f64 mFrameStartTime{};						// Time the current frame started, before waiting on its fence.
+		f64 mFrameIntervalMs{};						// Time between the starts of the previous and the current frame.
+		f64 mFenceWaitMs{};							// Time the current frame waited on its fence.
+		u64 mFrameNumber{};							// Number of frames submitted so far.
+		bool mFrameInProgress = false;				// Whether the current frame was begun and should be ended.
+		u64 mUploadWaitValue{};						// Upload timeline value the current frame's submission waits on.
+
+		bool mResizePending = false;				// Whether the window size changed since the swapchain was created.
+		u16 mPendingWidth{};						// Most recently requested frame-buffer width.
+		u16 mPendingHeight{};						// Most recently requested frame-buffer height.
+		f64 mResizeStartTime{};						// Time the first resize of the pending burst arrived.
+		f64 mLastResizeTime{};						// Time the most recent resize of the pending burst arrived.
+
+		VulkanDeletionQueue mDeletionQueue;			// Resources retired while frames in flight may still use them.
 
 #if defined(_DEBUG)
         VkDebugUtilsMessengerEXT mDebugMessenger{};
@@ -64,9 +130,13 @@ namespace Vkr
 		void DestroyVulkanSurface();
 
 		// Creates a Vulkan Logical device.
-        StatusCode CreateLogicalDevice();
-		// Select a physical device. (GPU)
-        StatusCode SelectPhysicalDevice();
+        StatusCode CreateLogicalDevice(const RendererConfig &config);
+		// Selects the physical device (GPU) with the highest score among those meeting the requirements, or the one
+		// whose UUID the VKR_DEVICE_UUID environment variable gives.
+        StatusCode SelectPhysicalDevice(const RendererConfig &config);
+		// Ranks a device meeting the requirements: by type, then device local memory, then optional features and queues.
+        u64 ScorePhysicalDevice(VkPhysicalDevice device, const PhysicalDeviceInfo &deviceInfo, const QueueFamilyInfo &queueFamilyInfo,
+                                bool preferDiscreteGpu);
         StatusCode PhysicalDeviceMeetsRequirements(VkPhysicalDevice device, const PhysicalDeviceInfo &deviceInfo, QueueFamilyInfo *outQueueFamilyInfo);
         void QuerySwapchainSupport(VkPhysicalDevice physicalDevice);
         bool DetectDepthFormat();
@@ -74,14 +144,33 @@ namespace Vkr
         void DestroyLogicalDevice();
 
 
-		// Creates Swapchain.
-		StatusCode CreateSwapchain(u32 width, u32 height);
-        void RecreateSwapchain(u32 width, u32 height);
-        bool AcquireNextImageIndex(u64 nanoSeconds, VkSemaphore imageAvailableSemaphore, VkFence fence, u32 *outImageIndex);
-        void Present(VkSemaphore renderCompleteSemaphore, u32 presentImageIndex);
+		/** Creates Swapchain.
+		 * @param oldSwapchain - Swapchain being replaced, if any, so the presentation engine can hand over its images.
+		 * */
+		StatusCode CreateSwapchain(u32 width, u32 height, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+		// Replaces the swapchain, retiring the old one through the deletion queue.
+        StatusCode RecreateSwapchain(u32 width, u32 height);
+		// Creates the images rendered to in offscreen mode, which take the place of the swapchain's, and their readback buffers.
+		StatusCode CreateOffscreenTargets(u32 width, u32 height);
+		// Picks the depth format, and resizes the culling pyramid built from the depth attachment.
+		StatusCode PrepareDepth(u32 width, u32 height);
+		// Acquires the next swapchain image. If the swapchain was out of date it is recreated instead, and outAcquired is false.
+        StatusCode AcquireNextImageIndex(u64 nanoSeconds, VkSemaphore imageAvailableSemaphore, VkFence fence, u32 *outImageIndex, bool *outAcquired);
+		// Presents a swapchain image, recreating the swapchain if it turned out to be out of date.
+        StatusCode Present(VkSemaphore renderCompleteSemaphore, u32 presentImageIndex);
 		// Destroys Swapchain.
 		void DestroySwapchain();
 
+		// Creates the command pool, command buffer and synchronization objects of every frame in flight.
+		void CreateFrames();
+		// Destroys the resources of every frame in flight.
+		void DestroyFrames();
+
+		// Records the frame's draw list and the scene into secondary command buffers and executes them from the primary one.
+		void RecordDrawList(VkCommandBuffer commandBuffer);
+		// Declares the frame's passes in the render graph.
+		void DeclareFramePasses();
+
 
 
 
@@ -90,11 +179,11 @@ namespace Vkr
         void DestroyImage(VulkanImage *image);
 
 		void CreateGraphicsPipeline();
-		VkShaderModule CreateShaderModule(const std::vector<char> &code);
-		void DestroyPipeline();
 
-		void CreateRenderPass();
-		void DestroyRenderPass();
-		void DestroyGraphicsPipeline();
+		// Fills the scene with a grid of cubes, drawn through indirect commands, for measuring recording cost.
+		void CreateBenchmarkScene(u32 objectCount);
+
+		// Reloads an edited shader and rebuilds the pipelines using it. Runs on the thread pool.
+		void ReloadShader(const std::string &path);
     };
 }
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "VulkanShaderCompiler.h"
+#include "Platform/MappedFile.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+namespace Vkr
+{
+    // Bumped whenever compile options change, so results of older options are not picked up from the cache.
+    constexpr u64 SHADER_CACHE_VERSION = 1;
+
+    VulkanShaderCompiler::~VulkanShaderCompiler()
+    {
+        Shutdown();
+    }
+
+    void VulkanShaderCompiler::Initialize(std::string cacheDirectory)
+    {
+        mCacheDirectory = std::move(cacheDirectory);
+
+        std::error_code error;
+        std::filesystem::create_directories(mCacheDirectory, error);
+        if (error)
+            VWARN("Failed to create shader cache directory '%s': %s", mCacheDirectory.c_str(), error.message().c_str())
+
+#if defined(VKR_SHADERC)
+        mCompiler = shaderc_compiler_initialize();
+#else
+        VDEBUG("Built without a shader compiler; GLSL can only be loaded from the shader cache.")
+#endif
+    }
+
+    void VulkanShaderCompiler::Shutdown()
+    {
+#if defined(VKR_SHADERC)
+        if (mCompiler)
+            shaderc_compiler_release(mCompiler);
+
+        mCompiler = nullptr;
+#endif
+    }
+
+    bool VulkanShaderCompiler::IsGlslSource(const std::string &path)
+    {
+        std::string extension = std::filesystem::path(path).extension().string();
+        return extension == ".vert" || extension == ".frag" || extension == ".comp" || extension == ".geom" ||
+               extension == ".tesc" || extension == ".tese";
+    }
+
+    StatusCode VulkanShaderCompiler::Compile(const std::string &sourcePath, const std::vector<std::string> &defines, std::vector<u32> *outSpirv)
+    {
+        MappedFile source;
+        if (!source.Open(sourcePath))
+        {
+            VERROR("Failed to open shader source '%s'.", sourcePath.c_str())
+            return StatusCode::ShaderFileNotFound;
+        }
+
+        // Key on everything that affects the output. The stage is part of the extension, which is part of the path.
+        std::string extension = std::filesystem::path(sourcePath).extension().string();
+        u64 hash = HashBytes(source.GetData(), source.GetSize());
+        hash = HashBytes(extension.data(), extension.size(), hash);
+        hash = HashBytes(&SHADER_CACHE_VERSION, sizeof(SHADER_CACHE_VERSION), hash);
+        for (const auto &define : defines)
+        {
+            hash = HashBytes(define.data(), define.size() + 1, hash);
+        }
+
+        char fileName[32];
+        snprintf(fileName, sizeof(fileName), "%016llx.spv", (unsigned long long)hash);
+        std::string cachePath = (std::filesystem::path(mCacheDirectory) / fileName).string();
+
+        if (ReadCache(cachePath, outSpirv))
+            return StatusCode::Successful;
+
+#if defined(VKR_SHADERC)
+        shaderc_shader_kind kind;
+        if (extension == ".vert")
+            kind = shaderc_vertex_shader;
+        else if (extension == ".frag")
+            kind = shaderc_fragment_shader;
+        else if (extension == ".comp")
+            kind = shaderc_compute_shader;
+        else if (extension == ".geom")
+            kind = shaderc_geometry_shader;
+        else if (extension == ".tesc")
+            kind = shaderc_tess_control_shader;
+        else
+            kind = shaderc_tess_evaluation_shader;
+
+        shaderc_compile_options_t options = shaderc_compile_options_initialize();
+        shaderc_compile_options_set_target_env(options, shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+        shaderc_compile_options_set_optimization_level(options, shaderc_optimization_level_performance);
+
+        for (const auto &define : defines)
+        {
+            size_t separator = define.find('=');
+            if (separator == std::string::npos)
+                shaderc_compile_options_add_macro_definition(options, define.c_str(), define.size(), nullptr, 0);
+            else
+                shaderc_compile_options_add_macro_definition(options, define.c_str(), separator,
+                                                             define.c_str() + separator + 1, define.size() - separator - 1);
+        }
+
+        shaderc_compilation_result_t result = shaderc_compile_into_spv(mCompiler, static_cast<const char *>(source.GetData()),
+                                                                       source.GetSize(), kind, sourcePath.c_str(), "main", options);
+        shaderc_compile_options_release(options);
+
+        if (shaderc_result_get_compilation_status(result) != shaderc_compilation_status_success)
+        {
+            VERROR("Failed to compile '%s':\n%s", sourcePath.c_str(), shaderc_result_get_error_message(result))
+            shaderc_result_release(result);
+            return StatusCode::ShaderCompilationFailed;
+        }
+
+        outSpirv->resize(shaderc_result_get_length(result) / sizeof(u32));
+        std::memcpy(outSpirv->data(), shaderc_result_get_bytes(result), outSpirv->size() * sizeof(u32));
+        shaderc_result_release(result);
+
+        WriteCache(cachePath, *outSpirv);
+        VDEBUG("Compiled '%s'.", sourcePath.c_str())
+        return StatusCode::Successful;
+#else
+        VERROR("'%s' is not in the shader cache, and the engine was built without a shader compiler.", sourcePath.c_str())
+        return StatusCode::ShaderCompilationFailed;
+#endif
+    }
+
+    bool VulkanShaderCompiler::ReadCache(const std::string &cachePath, std::vector<u32> *outSpirv) const
+    {
+        MappedFile file;
+        if (!file.Open(cachePath) || file.GetSize() % sizeof(u32) != 0)
+            return false;
+
+        outSpirv->resize(file.GetSize() / sizeof(u32));
+        std::memcpy(outSpirv->data(), file.GetData(), file.GetSize());
+        return true;
+    }
+
+    void VulkanShaderCompiler::WriteCache(const std::string &cachePath, const std::vector<u32> &spirv) const
+    {
+        // Renamed into place, so another thread or process never reads a half written file. Threads and processes compiling
+        // the same shader each write their own temporary file; whichever rename comes last wins, with identical contents.
+        static std::atomic<u64> writeCount{0};
+        const u64 unique = std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+                           (u64)std::chrono::steady_clock::now().time_since_epoch().count() ^ writeCount.fetch_add(1);
+        std::string tempPath = cachePath + "." + std::to_string(unique) + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(spirv.data()), (std::streamsize)(spirv.size() * sizeof(u32)));
+            if (!file.good())
+            {
+                VWARN("Failed to write '%s'.", tempPath.c_str())
+                file.close();
+                std::error_code error;
+                std::filesystem::remove(tempPath, error);
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, cachePath, error);
+        if (error)
+        {
+            VWARN("Failed to replace '%s': %s", cachePath.c_str(), error.message().c_str())
+            std::filesystem::remove(tempPath, error);
+        }
+    }
+}
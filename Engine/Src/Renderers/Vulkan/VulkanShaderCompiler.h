@@ -0,0 +1,51 @@
+#pragma once
+#include "Defines.h"
+
+#if defined(VKR_SHADERC)
+#include <shaderc/shaderc.h>
+#endif
+
+namespace Vkr
+{
+    // Compiles GLSL to SPIR-V at runtime. Results are cached on disk by a hash of the source, the stage and the defines,
+    // so unchanged shaders are never compiled twice, not even across runs.
+    // The compiler itself is only built with VKR_SHADERC; without it, only shaders already in the cache can be loaded.
+    class VulkanShaderCompiler
+    {
+    public:
+        VulkanShaderCompiler() = default;
+        ~VulkanShaderCompiler();
+
+        VulkanShaderCompiler(const VulkanShaderCompiler &) = delete;
+        void operator=(VulkanShaderCompiler const &) = delete;
+
+        /**
+         * Prepares the compiler for use.
+         * @param cacheDirectory Directory compiled SPIR-V is cached in; created if missing.
+         */
+        void Initialize(std::string cacheDirectory);
+
+        void Shutdown();
+
+        /**
+         * Compiles a GLSL source file, or loads the result of an earlier compile from the cache. Safe to call from any thread.
+         * @param sourcePath Path of the GLSL file. The stage is derived from its extension (.vert, .frag, .comp, ...).
+         * @param defines Preprocessor definitions, each either "NAME" or "NAME=VALUE".
+         * @param outSpirv The SPIR-V words.
+         */
+        StatusCode Compile(const std::string &sourcePath, const std::vector<std::string> &defines, std::vector<u32> *outSpirv);
+
+        // Whether the path names a GLSL source file rather than SPIR-V.
+        static bool IsGlslSource(const std::string &path);
+
+    private:
+        std::string mCacheDirectory;
+
+#if defined(VKR_SHADERC)
+        shaderc_compiler_t mCompiler{};       // Thread safe, shared by every compile.
+#endif
+
+        bool ReadCache(const std::string &cachePath, std::vector<u32> *outSpirv) const;
+        void WriteCache(const std::string &cachePath, const std::vector<u32> &spirv) const;
+    };
+}
@@ -0,0 +1,190 @@
+#include "VulkanShaderRegistry.h"
+#include "VulkanShaderCompiler.h"
+#include "Platform/MappedFile.h"
+#include <filesystem>
+
+namespace Vkr
+{
+    constexpr u32 SPIRV_MAGIC = 0x07230203;
+
+    void VulkanShaderRegistry::Initialize(VkDevice device, const VkAllocationCallbacks *allocator, std::string assetRoot, VulkanShaderCompiler *compiler)
+    {
+        mDevice = device;
+        mAllocator = allocator;
+        mAssetRoot = std::move(assetRoot);
+        mpCompiler = compiler;
+    }
+
+    bool VulkanShaderRegistry::OpenPack(const std::string &path)
+    {
+        std::string resolvedPath = ResolvePath(path);
+        if (!mPack.Open(resolvedPath))
+        {
+            VWARN("No shader pack at '%s'; shaders are loaded from loose files.", resolvedPath.c_str())
+            return false;
+        }
+
+        const auto *header = static_cast<const ShaderPackFormat::Header *>(mPack.GetData());
+        if (mPack.GetSize() < sizeof(ShaderPackFormat::Header) || header->magic != ShaderPackFormat::MAGIC ||
+            header->version != ShaderPackFormat::VERSION ||
+            mPack.GetSize() < sizeof(ShaderPackFormat::Header) + header->entryCount * sizeof(ShaderPackFormat::Entry))
+        {
+            VWARN("'%s' is not a compatible shader pack; rebuild the ShaderBuild target.", resolvedPath.c_str())
+            return false;
+        }
+
+        mpPackEntries = reinterpret_cast<const ShaderPackFormat::Entry *>(header + 1);
+        mPackEntryCount = header->entryCount;
+        VDEBUG("Mapped shader pack '%s' with %u permutations.", resolvedPath.c_str(), mPackEntryCount)
+        return true;
+    }
+
+    void VulkanShaderRegistry::Shutdown()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        VDEBUG("Destroying %zu shader modules.", mModules.size())
+        for (auto &[hash, module] : mModules)
+        {
+            vkDestroyShaderModule(mDevice, module, mAllocator);
+        }
+
+        mModules.clear();
+        mSources.clear();
+        mpPackEntries = nullptr;
+        mPackEntryCount = 0;
+    }
+
+    StatusCode VulkanShaderRegistry::Load(const std::string &path, VulkanShader *outShader, const std::vector<std::string> &defines)
+    {
+        std::string resolvedPath = ResolvePath(path);
+        if (!LoadFromPack(path, defines, outShader))
+        {
+            StatusCode statusCode = LoadResolved(resolvedPath, defines, outShader);
+            RETURN_ON_FAIL(statusCode)
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto &source : mSources)
+        {
+            if (source.resolvedPath == resolvedPath && source.defines == defines)
+            {
+                source.hash = outShader->hash;
+                return StatusCode::Successful;
+            }
+        }
+
+        mSources.push_back({resolvedPath, defines, outShader->hash});
+        return StatusCode::Successful;
+    }
+
+    StatusCode VulkanShaderRegistry::Reload(const std::string &resolvedPath, std::vector<std::pair<u64, VulkanShader>> *outChanged)
+    {
+        std::vector<Source> sources;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (const auto &source : mSources)
+            {
+                if (source.resolvedPath == resolvedPath)
+                    sources.push_back(source);
+            }
+        }
+
+        for (const auto &source : sources)
+        {
+            VulkanShader shader;
+            StatusCode statusCode = LoadResolved(resolvedPath, source.defines, &shader);
+            RETURN_ON_FAIL(statusCode)
+
+            // Saving a file without changing it, or changing only comments, produces the same module.
+            if (shader.hash == source.hash)
+                continue;
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto &known : mSources)
+            {
+                if (known.resolvedPath == resolvedPath && known.defines == source.defines)
+                    known.hash = shader.hash;
+            }
+
+            outChanged->emplace_back(source.hash, shader);
+        }
+
+        return StatusCode::Successful;
+    }
+
+    StatusCode VulkanShaderRegistry::LoadResolved(const std::string &resolvedPath, const std::vector<std::string> &defines, VulkanShader *outShader)
+    {
+        if (VulkanShaderCompiler::IsGlslSource(resolvedPath))
+        {
+            std::vector<u32> spirv;
+            StatusCode statusCode = mpCompiler->Compile(resolvedPath, defines, &spirv);
+            RETURN_ON_FAIL(statusCode)
+
+            outShader->hash = HashBytes(spirv.data(), spirv.size() * sizeof(u32));
+            outShader->module = FindOrCreateModule(spirv.data(), spirv.size() * sizeof(u32), outShader->hash);
+            return StatusCode::Successful;
+        }
+
+        // Mapped memory is page aligned, so the words can be handed to Vulkan as they are.
+        MappedFile file;
+        if (!file.Open(resolvedPath))
+        {
+            VERROR("Failed to open shader '%s'.", resolvedPath.c_str())
+            return StatusCode::ShaderFileNotFound;
+        }
+
+        const auto *code = static_cast<const u32 *>(file.GetData());
+        if (file.GetSize() % sizeof(u32) != 0 || code[0] != SPIRV_MAGIC)
+        {
+            VERROR("'%s' is not a SPIR-V module.", resolvedPath.c_str())
+            return StatusCode::ShaderInvalidSpirv;
+        }
+
+        outShader->hash = HashBytes(code, file.GetSize());
+        outShader->module = FindOrCreateModule(code, file.GetSize(), outShader->hash);
+        return StatusCode::Successful;
+    }
+
+    bool VulkanShaderRegistry::LoadFromPack(const std::string &path, const std::vector<std::string> &defines, VulkanShader *outShader)
+    {
+        u64 key = ShaderPackFormat::PermutationKey(path, defines);
+
+        const ShaderPackFormat::Entry *end = mpPackEntries + mPackEntryCount;
+        const ShaderPackFormat::Entry *entry = std::lower_bound(mpPackEntries, end, key,
+            [](const ShaderPackFormat::Entry &entry, u64 key) { return entry.key < key; });
+
+        if (entry == end || entry->key != key || entry->offset + entry->size > mPack.GetSize())
+            return false;
+
+        // Entries are aligned within the page aligned mapping, so the words go to Vulkan without a copy.
+        const auto *code = reinterpret_cast<const u32 *>(static_cast<const u8 *>(mPack.GetData()) + entry->offset);
+        outShader->hash = entry->contentHash;
+        outShader->module = FindOrCreateModule(code, entry->size, entry->contentHash);
+        return true;
+    }
+
+    VkShaderModule VulkanShaderRegistry::FindOrCreateModule(const u32 *code, size_t size, u64 hash)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mModules.find(hash);
+        if (it == mModules.end())
+        {
+            VkShaderModuleCreateInfo shaderModuleCreateInfo{};
+            shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            shaderModuleCreateInfo.codeSize = size;					// Size of code.
+            shaderModuleCreateInfo.pCode = code;					// Pointer to code (of type uint32_t type)
+
+            VkShaderModule module;
+            VK_CHECK(vkCreateShaderModule(mDevice, &shaderModuleCreateInfo, mAllocator, &module))
+            it = mModules.emplace(hash, module).first;
+        }
+
+        return it->second;
+    }
+
+    std::string VulkanShaderRegistry::ResolvePath(const std::string &path) const
+    {
+        return (std::filesystem::path(mAssetRoot) / path).string();
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "Defines.h"
+#include "Platform/MappedFile.h"
+#include "ShaderPackFormat.h"
+#include <mutex>
+
+namespace Vkr
+{
+    class VulkanShaderCompiler;
+
+    struct VulkanShader
+    {
+        VkShaderModule module{};      // Owned by the registry.
+        u64 hash{};                   // Hash of the SPIR-V the module was created from.
+    };
+
+    // Loads shaders from the asset directory and owns their modules. Permutations built offline are taken from the
+    // memory-mapped shader pack; anything else comes from loose files, with GLSL sources compiled through the shader compiler.
+    // Modules are shared by content hash, so a shader used by many pipelines is created once.
+    class VulkanShaderRegistry
+    {
+    public:
+        VulkanShaderRegistry() = default;
+        ~VulkanShaderRegistry() = default;
+
+        VulkanShaderRegistry(const VulkanShaderRegistry &) = delete;
+        void operator=(VulkanShaderRegistry const &) = delete;
+
+        /**
+         * Prepares the registry for use.
+         * @param device The logical device modules are created on.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param assetRoot Directory shader paths are relative to.
+         * @param compiler Compiler for GLSL sources.
+         */
+        void Initialize(VkDevice device, const VkAllocationCallbacks *allocator, std::string assetRoot, VulkanShaderCompiler *compiler);
+
+        /**
+         * Maps a shader pack built by the ShaderBuild target. Permutations in it are loaded without touching loose files.
+         * @param path Path of the pack, relative to the asset root.
+         * @return Whether the pack could be opened.
+         */
+        bool OpenPack(const std::string &path);
+
+        // Destroys every module. No pipeline may still be compiling with them.
+        void Shutdown();
+
+        /**
+         * Loads a shader, creating its module unless one with the same contents exists already.
+         * @param path Path of the SPIR-V file or GLSL source, relative to the asset root.
+         * @param outShader The module and its hash.
+         * @param defines Preprocessor definitions for GLSL sources, each either "NAME" or "NAME=VALUE".
+         */
+        StatusCode Load(const std::string &path, VulkanShader *outShader, const std::vector<std::string> &defines = {});
+
+        /**
+         * Reloads every shader loaded from a file, after the file changed. The previous modules stay alive until shutdown,
+         * so pipelines built from them remain valid.
+         * @param resolvedPath The changed file, as returned by ResolvePath.
+         * @param outChanged Receives the previous hash and the reloaded shader, for each variant whose contents changed.
+         */
+        StatusCode Reload(const std::string &resolvedPath, std::vector<std::pair<u64, VulkanShader>> *outChanged);
+
+        // Turns a path relative to the asset root into one usable with the file system.
+        [[nodiscard]] std::string ResolvePath(const std::string &path) const;
+
+    private:
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        std::string mAssetRoot;
+        VulkanShaderCompiler *mpCompiler{};
+
+        // A file loaded with one set of defines, remembered so it can be reloaded.
+        struct Source
+        {
+            std::string resolvedPath;
+            std::vector<std::string> defines;
+            u64 hash;                       // Hash of the module currently loaded from it.
+        };
+
+        std::mutex mMutex;
+        std::unordered_map<u64, VkShaderModule> mModules;     // Modules by content hash.
+        std::vector<Source> mSources;
+
+        MappedFile mPack;
+        const ShaderPackFormat::Entry *mpPackEntries{};
+        u32 mPackEntryCount{};
+
+        bool LoadFromPack(const std::string &path, const std::vector<std::string> &defines, VulkanShader *outShader);
+
+        StatusCode LoadResolved(const std::string &resolvedPath, const std::vector<std::string> &defines, VulkanShader *outShader);
+        VkShaderModule FindOrCreateModule(const u32 *code, size_t size, u64 hash);
+    };
+}
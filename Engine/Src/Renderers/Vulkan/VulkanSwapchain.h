@@ -12,6 +12,6 @@ namespace Vkr
         u32 imageCount;
         std::vector<VkImage> images;
         std::vector<VkImageView> views;
-        VulkanImage depthAttachment;
+        std::vector<VkSemaphore> renderComplete;    // One per image, signaled when rendering to that image has finished.
     };
 }
\ No newline at end of file
@@ -0,0 +1,393 @@
+#include "VulkanUploadManager.h"
+
+namespace Vkr
+{
+    static inline VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    StatusCode VulkanUploadManager::Initialize(const VulkanDevice &device, VulkanMemoryAllocator *memoryAllocator, const VkAllocationCallbacks *allocator,
+                                               VkDeviceSize ringSize, VkDeviceSize frameBudget)
+    {
+        mDevice = device.logicalDevice;
+        mAllocator = allocator;
+        mpMemoryAllocator = memoryAllocator;
+        mTransferQueue = device.transferQueue;
+        mTransferFamily = (u32)device.transferQueueIndex;
+        mGraphicsFamily = (u32)device.graphicsQueueIndex;
+        mRingSize = ringSize;
+        mFrameBudget = frameBudget;
+
+        // Image copies need offsets aligned to the texel size; this covers every format.
+        mCopyAlignment = VMAX(mCopyAlignment, device.properties.limits.optimalBufferCopyOffsetAlignment);
+
+        VkBufferCreateInfo bufferCreateInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+        bufferCreateInfo.size = mRingSize;
+        bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        VK_CHECK(vkCreateBuffer(mDevice, &bufferCreateInfo, mAllocator, &mRing))
+
+        // Coherent, so writes through the persistent mapping need no flush.
+        StatusCode statusCode = mpMemoryAllocator->AllocateBufferMemory(mRing, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                                         &mRingAllocation);
+        ENSURE_SUCCESS(statusCode, "Failed to allocate the %llu byte staging ring.", mRingSize)
+
+        VkCommandPoolCreateInfo poolCreateInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+        poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolCreateInfo.queueFamilyIndex = mTransferFamily;
+        VK_CHECK(vkCreateCommandPool(mDevice, &poolCreateInfo, mAllocator, &mCommandPool))
+
+        VkSemaphoreTypeCreateInfo semaphoreTypeInfo{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+        semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        semaphoreTypeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo semaphoreCreateInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+        semaphoreCreateInfo.pNext = &semaphoreTypeInfo;
+        VK_CHECK(vkCreateSemaphore(mDevice, &semaphoreCreateInfo, mAllocator, &mTimeline))
+
+        VDEBUG("Upload manager: %llu byte staging ring, %llu bytes per frame, %s transfer queue.", mRingSize, mFrameBudget,
+               mTransferFamily == mGraphicsFamily ? "shared" : "dedicated")
+        return StatusCode::Successful;
+    }
+
+    void VulkanUploadManager::Shutdown()
+    {
+        LogStats();
+
+        if (mTimeline)
+            vkDestroySemaphore(mDevice, mTimeline, mAllocator);
+
+        // Destroying the pool frees every batch's command buffer.
+        if (mCommandPool)
+            vkDestroyCommandPool(mDevice, mCommandPool, mAllocator);
+
+        if (mRing)
+        {
+            vkDestroyBuffer(mDevice, mRing, mAllocator);
+            mpMemoryAllocator->Free(&mRingAllocation);
+        }
+
+        mTimeline = VK_NULL_HANDLE;
+        mCommandPool = VK_NULL_HANDLE;
+        mRing = VK_NULL_HANDLE;
+        mInFlight.clear();
+        mFreeBatches.clear();
+        mPending.clear();
+    }
+
+    UploadHandle VulkanUploadManager::UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void *data, VkDeviceSize size)
+    {
+        if (size == 0)
+            return {};
+
+        Request request{};
+        request.buffer = buffer;
+        request.bufferOffset = offset;
+        request.data.assign(static_cast<const u8 *>(data), static_cast<const u8 *>(data) + size);
+        return Enqueue(std::move(request));
+    }
+
+    UploadHandle VulkanUploadManager::UploadImage(VkImage image, VkExtent3D extent, VkImageAspectFlags aspect, const void *data, VkDeviceSize size)
+    {
+        // Images are staged whole, so they have to fit the ring.
+        if (size + mCopyAlignment > mRingSize)
+        {
+            VERROR("Image upload of %llu bytes exceeds the %llu byte staging ring.", size, mRingSize)
+            return {};
+        }
+
+        Request request{};
+        request.image = image;
+        request.extent = extent;
+        request.aspect = aspect;
+        request.data.assign(static_cast<const u8 *>(data), static_cast<const u8 *>(data) + size);
+        return Enqueue(std::move(request));
+    }
+
+    UploadHandle VulkanUploadManager::Enqueue(Request &&request)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        request.id = mNextRequestId++;
+        mStats.requests++;
+        mStats.bytesRequested += request.data.size();
+
+        UploadHandle handle{request.id};
+        mPending.push_back(std::move(request));
+        return handle;
+    }
+
+    void VulkanUploadManager::RecordAcquires(VkCommandBuffer commandBuffer, u64 *outWaitValue)
+    {
+        *outWaitValue = 0;
+        if (mInFlight.empty())
+            return;
+
+        uint64_t completedValue;
+        VK_CHECK(vkGetSemaphoreCounterValue(mDevice, mTimeline, &completedValue))
+
+        std::vector<VkBufferMemoryBarrier> bufferAcquires;
+        std::vector<VkImageMemoryBarrier> imageAcquires;
+        while (!mInFlight.empty() && mInFlight.front().value <= completedValue)
+        {
+            Batch &batch = mInFlight.front();
+            bufferAcquires.insert(bufferAcquires.end(), batch.bufferAcquires.begin(), batch.bufferAcquires.end());
+            imageAcquires.insert(imageAcquires.end(), batch.imageAcquires.begin(), batch.imageAcquires.end());
+
+            // The submission still waits on the semaphore: that is what orders the acquires after the releases, and
+            // makes the copies visible when both queues are of the same family.
+            *outWaitValue = batch.value;
+            mRingTail = batch.ringEnd;
+            mCompletedRequestId.store(batch.lastRequestId, std::memory_order_release);
+
+            batch.bufferAcquires.clear();
+            batch.imageAcquires.clear();
+            mFreeBatches.push_back(std::move(batch));
+            mInFlight.pop_front();
+        }
+
+        if (!bufferAcquires.empty() || !imageAcquires.empty())
+        {
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                                 0, nullptr, (u32)bufferAcquires.size(), bufferAcquires.data(), (u32)imageAcquires.size(), imageAcquires.data());
+        }
+    }
+
+    void VulkanUploadManager::Update()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mPending.empty())
+            return;
+
+        // Nothing references the ring, so start over at its beginning and avoid needless wrapping.
+        if (mInFlight.empty())
+        {
+            mRingHead = 0;
+            mRingTail = 0;
+        }
+
+        Batch batch;
+        if (!mFreeBatches.empty())
+        {
+            batch = std::move(mFreeBatches.back());
+            mFreeBatches.pop_back();
+        }
+        else
+        {
+            VkCommandBufferAllocateInfo allocateInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+            allocateInfo.commandPool = mCommandPool;
+            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocateInfo.commandBufferCount = 1;
+            VK_CHECK(vkAllocateCommandBuffers(mDevice, &allocateInfo, &batch.commandBuffer))
+        }
+
+        VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CHECK(vkBeginCommandBuffer(batch.commandBuffer, &beginInfo))
+
+        // Ownership only moves between different families; within one family the semaphore is all that is needed.
+        const bool transferOwnership = mTransferFamily != mGraphicsFamily;
+        const u32 srcFamily = transferOwnership ? mTransferFamily : VK_QUEUE_FAMILY_IGNORED;
+        const u32 dstFamily = transferOwnership ? mGraphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+
+        std::vector<VkBufferMemoryBarrier> bufferReleases;
+        std::vector<VkImageMemoryBarrier> imageReleases;
+        VkDeviceSize staged = 0;
+        auto *ring = static_cast<u8 *>(mRingAllocation.mapped);
+
+        while (!mPending.empty() && staged < mFrameBudget)
+        {
+            Request &request = mPending.front();
+            VkDeviceSize remaining = request.data.size() - request.copied;
+            VkDeviceSize offset;
+
+            if (request.image)
+            {
+                // Staged whole; one that exceeds the budget still goes if it is the first this frame, or it never would.
+                if (staged != 0 && staged + remaining > mFrameBudget)
+                    break;
+
+                if (AllocateStaging(remaining, false, &offset) == 0)
+                    break;
+
+                std::memcpy(ring + offset, request.data.data(), remaining);
+
+                VkImageMemoryBarrier toTransfer{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+                toTransfer.srcAccessMask = 0;
+                toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                toTransfer.image = request.image;
+                toTransfer.subresourceRange = {request.aspect, 0, 1, 0, 1};
+                vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                                     0, nullptr, 0, nullptr, 1, &toTransfer);
+
+                VkBufferImageCopy copy{};
+                copy.bufferOffset = offset;
+                copy.imageSubresource = {request.aspect, 0, 0, 1};
+                copy.imageExtent = request.extent;
+                vkCmdCopyBufferToImage(batch.commandBuffer, mRing, request.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+                // The release also moves the image to its final layout; the acquire repeats the transition, as it must.
+                VkImageMemoryBarrier release = toTransfer;
+                release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                release.dstAccessMask = 0;
+                release.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                release.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                release.srcQueueFamilyIndex = srcFamily;
+                release.dstQueueFamilyIndex = dstFamily;
+                imageReleases.push_back(release);
+
+                if (transferOwnership)
+                {
+                    VkImageMemoryBarrier acquire = release;
+                    acquire.srcAccessMask = 0;
+                    acquire.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                    batch.imageAcquires.push_back(acquire);
+                }
+
+                request.copied = request.data.size();
+                staged += remaining;
+            }
+            else
+            {
+                VkDeviceSize size = AllocateStaging(VMIN(remaining, mFrameBudget - staged), true, &offset);
+                if (size == 0)
+                    break;
+
+                std::memcpy(ring + offset, request.data.data() + request.copied, size);
+
+                VkBufferCopy copy{};
+                copy.srcOffset = offset;
+                copy.dstOffset = request.bufferOffset + request.copied;
+                copy.size = size;
+                vkCmdCopyBuffer(batch.commandBuffer, mRing, request.buffer, 1, &copy);
+
+                if (transferOwnership)
+                {
+                    VkBufferMemoryBarrier release{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+                    release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                    release.dstAccessMask = 0;
+                    release.srcQueueFamilyIndex = srcFamily;
+                    release.dstQueueFamilyIndex = dstFamily;
+                    release.buffer = request.buffer;
+                    release.offset = copy.dstOffset;
+                    release.size = size;
+                    bufferReleases.push_back(release);
+
+                    VkBufferMemoryBarrier acquire = release;
+                    acquire.srcAccessMask = 0;
+                    acquire.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+                    batch.bufferAcquires.push_back(acquire);
+                }
+
+                request.copied += size;
+                staged += size;
+            }
+
+            if (request.copied == request.data.size())
+            {
+                mLastStagedRequestId = request.id;
+                mPending.pop_front();
+            }
+        }
+
+        if (!mPending.empty())
+            mStats.deferredFrames++;
+
+        if (staged == 0)
+        {
+            // The ring is full of data still in flight; try again next frame.
+            VK_CHECK(vkEndCommandBuffer(batch.commandBuffer))
+            mFreeBatches.push_back(std::move(batch));
+            return;
+        }
+
+        if (!bufferReleases.empty() || !imageReleases.empty())
+        {
+            vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                                 0, nullptr, (u32)bufferReleases.size(), bufferReleases.data(), (u32)imageReleases.size(), imageReleases.data());
+        }
+
+        VK_CHECK(vkEndCommandBuffer(batch.commandBuffer))
+
+        batch.value = ++mSubmittedValue;
+        batch.ringEnd = mRingHead;
+        batch.lastRequestId = mLastStagedRequestId;
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &batch.value;
+
+        VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &batch.commandBuffer;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &mTimeline;
+        VK_CHECK(vkQueueSubmit(mTransferQueue, 1, &submitInfo, VK_NULL_HANDLE))
+
+        mStats.batches++;
+        mStats.bytesCopied += staged;
+        mInFlight.push_back(std::move(batch));
+    }
+
+    bool VulkanUploadManager::IsComplete(UploadHandle handle) const
+    {
+        return handle.IsValid() && handle.id <= mCompletedRequestId.load(std::memory_order_acquire);
+    }
+
+    UploadStats VulkanUploadManager::GetStats()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+    void VulkanUploadManager::LogStats()
+    {
+        UploadStats stats = GetStats();
+        VDEBUG("Uploads: %llu requested (%llu bytes), %llu bytes copied in %llu batches, %llu frames over budget.",
+               stats.requests, stats.bytesRequested, stats.bytesCopied, stats.batches, stats.deferredFrames)
+    }
+
+    VkDeviceSize VulkanUploadManager::AllocateStaging(VkDeviceSize size, bool allowPartial, VkDeviceSize *outOffset)
+    {
+        // Used space is [tail, head), possibly wrapping around the end. The head never catches up with the tail, so
+        // head == tail always means empty.
+        VkDeviceSize head = AlignUp(mRingHead, mCopyAlignment);
+        VkDeviceSize offset;
+        VkDeviceSize available;
+
+        if (mRingHead >= mRingTail)
+        {
+            VkDeviceSize atEnd = head < mRingSize ? mRingSize - head : 0;
+            VkDeviceSize atStart = mRingTail > mCopyAlignment ? mRingTail - mCopyAlignment : 0;
+
+            if (atEnd >= size || (allowPartial && atEnd >= atStart))
+            {
+                offset = head;
+                available = atEnd;
+            }
+            else
+            {
+                offset = 0;
+                available = atStart;
+            }
+        }
+        else
+        {
+            offset = head;
+            available = head + mCopyAlignment < mRingTail ? mRingTail - head - mCopyAlignment : 0;
+        }
+
+        VkDeviceSize granted = allowPartial ? VMIN(size, available) : (available >= size ? size : 0);
+        if (granted == 0)
+            return 0;
+
+        *outOffset = offset;
+        mRingHead = offset + granted;
+        return granted;
+    }
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include "Defines.h"
+#include "VulkanDevice.h"
+#include "VulkanMemoryAllocator.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace Vkr
+{
+    // Identifies an upload requested from the `VulkanUploadManager`.
+    struct UploadHandle
+    {
+        u64 id{};
+
+        [[nodiscard]] inline bool IsValid() const { return id != 0; }
+    };
+
+    struct UploadStats
+    {
+        u64 requests{};             // Uploads requested.
+        u64 bytesRequested{};       // Bytes requested.
+        u64 bytesCopied{};          // Bytes copied to device memory so far.
+        u64 batches{};              // Transfer submissions.
+        u64 deferredFrames{};       // Frames that left work for later because the budget or the ring was exhausted.
+    };
+
+    // Copies data into device-local buffers and images through a persistently mapped staging ring, on the dedicated
+    // transfer queue when the device has one, so uploads run alongside graphics work.
+    //
+    // Requests are queued and staged by `Update` once per frame, up to a byte budget; the rest waits for later frames, and
+    // buffers larger than the budget are copied in chunks. Each frame's copies are one transfer submission that signals a
+    // timeline semaphore. Once that value is reached, `RecordAcquires` takes the resources over on the graphics queue
+    // (queue family ownership transfer) and the frame's submission waits on the semaphore. Images end up in
+    // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+    //
+    // Destinations must not be in use by the GPU while they are uploaded to, e.g. freshly created resources.
+    class VulkanUploadManager
+    {
+    public:
+        VulkanUploadManager() = default;
+        ~VulkanUploadManager() = default;
+
+        VulkanUploadManager(const VulkanUploadManager &) = delete;
+        void operator=(VulkanUploadManager const &) = delete;
+
+        /**
+         * Prepares the manager for use.
+         * @param device The device, with its graphics and transfer queues.
+         * @param memoryAllocator Allocator the staging ring is allocated from.
+         * @param allocator Host allocation callbacks passed to Vulkan.
+         * @param ringSize Size of the staging ring in bytes; also the largest image that can be uploaded.
+         * @param frameBudget Bytes staged per frame at most.
+         */
+        StatusCode Initialize(const VulkanDevice &device, VulkanMemoryAllocator *memoryAllocator, const VkAllocationCallbacks *allocator,
+                              VkDeviceSize ringSize, VkDeviceSize frameBudget);
+
+        // Drops pending uploads and destroys the ring. The device must be idle.
+        void Shutdown();
+
+        /**
+         * Queues a copy into a buffer. The data is copied, so it doesn't need to outlive the call. Safe to call from any thread.
+         * @param buffer Destination, created with VK_BUFFER_USAGE_TRANSFER_DST_BIT.
+         * @param offset Offset in the destination.
+         */
+        UploadHandle UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void *data, VkDeviceSize size);
+
+        /**
+         * Queues a copy into the first mip level and layer of an image, whose contents are discarded.
+         * The data is copied, so it doesn't need to outlive the call. Safe to call from any thread.
+         * @param image Destination, created with VK_IMAGE_USAGE_TRANSFER_DST_BIT.
+         * @param extent Size of the image in texels.
+         * @param aspect Aspect the data is for.
+         * @param data Tightly packed texels.
+         */
+        UploadHandle UploadImage(VkImage image, VkExtent3D extent, VkImageAspectFlags aspect, const void *data, VkDeviceSize size);
+
+        /**
+         * Hands the uploads that completed on the transfer queue over to the graphics queue. Call once per frame, at the start of
+         * the frame's graphics command buffer.
+         * @param commandBuffer The graphics command buffer the acquire barriers are recorded into.
+         * @param outWaitValue Value of the timeline semaphore the submission of `commandBuffer` must wait on, 0 for none.
+         */
+        void RecordAcquires(VkCommandBuffer commandBuffer, u64 *outWaitValue);
+
+        // Stages queued uploads up to the frame budget and submits them to the transfer queue. Call once per frame.
+        void Update();
+
+        // Whether an upload reached device memory and was acquired by the graphics queue, i.e. can be used by this frame.
+        [[nodiscard]] bool IsComplete(UploadHandle handle) const;
+
+        // Semaphore signaled by transfer submissions. Its value counts the completed batches.
+        [[nodiscard]] inline VkSemaphore GetTimelineSemaphore() const { return mTimeline; }
+
+        [[nodiscard]] UploadStats GetStats();
+
+        // Logs the upload statistics.
+        void LogStats();
+
+    private:
+        struct Request
+        {
+            u64 id;
+            VkBuffer buffer;                // Either a buffer...
+            VkDeviceSize bufferOffset;
+            VkImage image;                  // ...or an image.
+            VkExtent3D extent;
+            VkImageAspectFlags aspect;
+            std::vector<u8> data;
+            VkDeviceSize copied;            // Bytes staged so far; buffers are staged in chunks.
+        };
+
+        // One transfer submission. Its ring space and command buffer are reused once the timeline reaches `value`.
+        struct Batch
+        {
+            VkCommandBuffer commandBuffer{};
+            uint64_t value{};               // Timeline value signaled on completion.
+            VkDeviceSize ringEnd{};         // Ring offset just past the batch's staging data.
+            u64 lastRequestId{};            // Requests up to this one are complete once the batch is acquired.
+            std::vector<VkBufferMemoryBarrier> bufferAcquires;
+            std::vector<VkImageMemoryBarrier> imageAcquires;
+        };
+
+        VkDevice mDevice{};
+        const VkAllocationCallbacks *mAllocator{};
+        VulkanMemoryAllocator *mpMemoryAllocator{};
+        VkQueue mTransferQueue{};
+        u32 mTransferFamily{};
+        u32 mGraphicsFamily{};
+
+        VkBuffer mRing{};
+        VulkanAllocation mRingAllocation{};
+        VkDeviceSize mRingSize{};
+        VkDeviceSize mRingHead{};               // Where the next staging data goes.
+        VkDeviceSize mRingTail{};               // Start of the oldest staging data still in use.
+        VkDeviceSize mFrameBudget{};
+        VkDeviceSize mCopyAlignment = 16;
+
+        VkCommandPool mCommandPool{};
+        VkSemaphore mTimeline{};
+        u64 mSubmittedValue{};
+        std::deque<Batch> mInFlight;            // Submitted, in submission order.
+        std::vector<Batch> mFreeBatches;        // Acquired; command buffers ready for reuse.
+
+        std::mutex mMutex;                      // Guards the pending requests and stats.
+        std::deque<Request> mPending;
+        u64 mNextRequestId = 1;
+        std::atomic<u64> mCompletedRequestId{};
+        UploadStats mStats{};
+        u64 mLastStagedRequestId{};             // Requests up to this one are fully staged.
+
+        UploadHandle Enqueue(Request &&request);
+
+        /**
+         * Reserves contiguous space in the staging ring.
+         * @param allowPartial Whether less than `size` may be reserved, when that is all there is.
+         * @return The bytes reserved, 0 if the ring is full.
+         */
+        VkDeviceSize AllocateStaging(VkDeviceSize size, bool allowPartial, VkDeviceSize *outOffset);
+    };
+}
@@ -11,6 +11,9 @@ namespace Vkr
         ClientAppInitializationFailed,               	// Failed to initialize client application.
         XcbConnectionHasError,                       	// Platform Linux - XCB Connection has errors.
         XcbFlushError,                               	// Platform Linux - XCB Flush failed.
+        WaylandConnectionFailed,                     	// Platform Linux - Failed to connect to the Wayland compositor.
+        WaylandRequiredGlobalMissing,                	// Platform Linux - Compositor lacks a required Wayland global.
+        PlatformHeadlessHasNoSurface,                	// Platform Headless - There is no window to create a surface for.
         WindowRegistrationFailed,                    	// Window registration failed.
         WindowCreationFailed,                        	// Window creation failed.
         AppNotInitialized,                           	// Application not initialized
@@ -18,13 +21,28 @@ namespace Vkr
         VulkanRequiredValidationLayersMissing,       	// Required vulkan validation layer(s) missing.
         VulkanInstanceExtensionNotFound,             	// Vulkan - instance extension not found.
 		VulkanFailedToCreateXcbSurface,					// Vulkan - failed to create XCB surface.
+		VulkanFailedToCreateWaylandSurface,				// Vulkan - failed to create Wayland surface.
 		VulkanFailedToCreateWindowsSurface,				// Vulkan - failed to create Windows surface.
         VulkanNoDevicesWithVulkanSupport,            	// Vulkan - No device could be found that supports Vulkan
         VulkanDiscreteGpuRequired,                   	// Vulkan - Discrete GPU Required.
+        VulkanApiVersionNotSupported,                	// Vulkan - Device does not support the required API version.
         VulkanPhysicalDeviceDoesNotMeetRequirements, 	// Vulkan - Physical device does not meet requirements.
         VulkanSamplerAnisotropyNotSupported,         	// Vulkan - Sampler Anisotropy is not supported.
+        VulkanDescriptorIndexingNotSupported,        	// Vulkan - Descriptor indexing for bindless resources is not supported.
+        VulkanBindlessLimitsTooLow,                  	// Vulkan - Update-after-bind limits leave no room for a bindless array.
+        VulkanDrawIndirectCountNotSupported,         	// Vulkan - Indirect draws with a draw count buffer are not supported.
         VulkanRequiredSwapchainNotSupported,         	// Vulkan - Required swapchain not supported
         VulkanRequiredExtensionNotFound,             	// Vulkan - Required extension not found
-        VulkanNoPhysicalDeviceMeetsRequirements      	// Vulkan - No physical device meets requirements
+        VulkanNoPhysicalDeviceMeetsRequirements,     	// Vulkan - No physical device meets requirements
+        VulkanCpuDeviceNotAllowed,                   	// Vulkan - Device is a CPU implementation, and those are not allowed.
+        VulkanForcedDeviceNotFound,                  	// Vulkan - The device forced through VKR_DEVICE_UUID was not found or not suitable.
+        VulkanNoSuitableMemoryType,                  	// Vulkan - No memory type has the required properties.
+        VulkanOutOfDeviceMemory,                     	// Vulkan - Device memory could not be allocated.
+        VulkanMemoryMapFailed,                       	// Vulkan - Host visible memory could not be mapped.
+        VulkanAcquireFailed,                         	// Vulkan - Swapchain image could not be acquired, e.g. the device or surface was lost.
+        VulkanPresentFailed,                         	// Vulkan - Swapchain image could not be presented, e.g. the device or surface was lost.
+        ShaderFileNotFound,                          	// Shader file could not be opened.
+        ShaderInvalidSpirv,                          	// Shader file is not a valid SPIR-V module.
+        ShaderCompilationFailed                      	// GLSL shader could not be compiled to SPIR-V.
     };
 }
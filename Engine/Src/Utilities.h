@@ -11,6 +11,9 @@
 
 #define VCLAMP(value, min, max) (value <= min) ? min : (value >= max) ? max : value;
 
+#define VMIN(a, b) ((a) < (b) ? (a) : (b))
+#define VMAX(a, b) ((a) > (b) ? (a) : (b))
+
 // NOTE: DO NOT PASS FUNCTIONS into this macro or else it "could" get executed multiple times.
 #define ENSURE_SUCCESS(statusCode, message, ...) \
     if (statusCode != StatusCode::Successful)    \
@@ -28,6 +31,20 @@
         VASSERT(expr == VK_SUCCESS)  \
     }
 
+// 64-bit FNV-1a hash of a block of memory. Fast and stable across runs, so suitable for on-disk checksums and keys.
+inline u64 HashBytes(const void *data, size_t size, u64 seed = 0xCBF29CE484222325ull)
+{
+    const auto *bytes = static_cast<const u8 *>(data);
+    u64 hash = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
 template <typename E>
 constexpr typename std::underlying_type<E>::type to_underlying(E e) noexcept
 {
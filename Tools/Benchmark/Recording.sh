@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+# Measures the CPU cost of recording frames on lavapipe, rendering offscreen through the headless platform.
+#
+#   Tools/Benchmark/Recording.sh <path to the Sandbox executable> [frames per run]
+#
+# Every run renders VKR_HEADLESS_FRAMES frames and prints the recorder's statistics logged at shutdown. Lavapipe keeps
+# the GPU out of the measurement; only the renderer's own recording is compared across runs.
+set -euo pipefail
+
+sandbox=$(realpath "${1:?usage: $0 <path to Sandbox> [frames per run]}")
+frames=${2:-300}
+
+icd=$(ls /usr/share/vulkan/icd.d/lvp_icd*.json /usr/local/share/vulkan/icd.d/lvp_icd*.json 2>/dev/null | head -n 1 || true)
+if [ -z "$icd" ]; then
+	echo "The lavapipe ICD (lvp_icd.*.json) was not found; install Mesa's Vulkan drivers." >&2
+	exit 1
+fi
+
+# Assets are looked up relative to the working directory.
+cd "$(dirname "$0")/../.."
+
+# Runs the sandbox with extra environment variables and prints the statistics lines.
+run() {
+	env VK_DRIVER_FILES="$icd" VK_ICD_FILENAMES="$icd" VKR_HEADLESS=1 VKR_HEADLESS_FRAMES="$frames" "$@" "$sandbox" 2>&1 |
+		grep -E "Recording:|Benchmark: .* per frame" || echo "No statistics; run with VKR_HEADLESS=1 and look at the log." >&2
+}
+
+cores=$(nproc)
+# The recording thread helps the workers, so N workers record on N + 1 threads. 0 workers would mean the default count.
+echo "Draw list: 10000 draws per frame, by recording threads, on lavapipe."
+for workers in 1 3 7 15; do
+	[ "$workers" -lt "$cores" ] || break
+	echo "== $((workers + 1)) threads"
+	run VKR_BENCHMARK_DRAWS=10000 VKR_WORKER_THREADS="$workers"
+done
+
+# The GPU-driven scene records one indirect count draw per pipeline, so its cost per frame should stay flat as objects
+# are added, while the draw list's grows with every draw.
+echo
+echo "Scene objects through indirect count draws, against as many draws through the draw list, on lavapipe."
+for objects in 1000 10000 100000; do
+	echo "== $objects objects, indirect"
+	run VKR_BENCHMARK_OBJECTS="$objects"
+	echo "== $objects draws, draw list"
+	run VKR_BENCHMARK_DRAWS="$objects"
+done
@@ -0,0 +1,59 @@
+#!/usr/bin/env bash
+# Checks the Wayland platform against a headless weston: the sandbox has to create its window and surface, present
+# through Vulkan, and receive wp_presentation feedback for its frames. The sandbox must be built with VKR_WAYLAND; it
+# renders on lavapipe.
+#
+#   Tools/PlatformTests/Wayland.sh <path to the Sandbox executable>
+set -euo pipefail
+
+sandbox=$(realpath "${1:?usage: $0 <path to Sandbox>}")
+command -v weston >/dev/null || { echo "SKIP: weston is not installed." >&2; exit 77; }
+
+icd=$(ls /usr/share/vulkan/icd.d/lvp_icd*.json /usr/local/share/vulkan/icd.d/lvp_icd*.json 2>/dev/null | head -n 1 || true)
+[ -n "$icd" ] || { echo "SKIP: the lavapipe ICD was not found." >&2; exit 77; }
+
+# Assets are looked up relative to the working directory. The sandbox is killed at the end, so its log is line buffered.
+cd "$(dirname "$0")/../.."
+
+runtime=$(mktemp -d)
+chmod 700 "$runtime"
+socket="vkr-test-$$"
+log="$runtime/sandbox.log"
+weston=
+app=
+cleanup() {
+	[ -z "$app" ] || kill "$app" 2>/dev/null || true
+	[ -z "$weston" ] || kill "$weston" 2>/dev/null || true
+	rm -rf "$runtime"
+}
+trap cleanup EXIT
+
+export XDG_RUNTIME_DIR="$runtime"
+weston --backend=headless-backend.so --socket="$socket" --idle-time=0 >"$runtime/weston.log" 2>&1 &
+weston=$!
+for _ in $(seq 50); do
+	[ -S "$runtime/$socket" ] && break
+	sleep 0.1
+done
+[ -S "$runtime/$socket" ] || { echo "FAIL: weston did not start." >&2; cat "$runtime/weston.log" >&2; exit 1; }
+
+WAYLAND_DISPLAY="$socket" VK_DRIVER_FILES="$icd" VK_ICD_FILENAMES="$icd" stdbuf -oL "$sandbox" >"$log" 2>&1 &
+app=$!
+sleep 5
+
+kill "$app" 2>/dev/null || true
+wait "$app" 2>/dev/null || true
+app=
+
+status=0
+if ! grep -qF "Receiving presentation feedback" "$log"; then
+	echo "FAIL: no wp_presentation feedback was received." >&2
+	status=1
+fi
+if grep -qE "does not support|Lost the connection" "$log"; then
+	echo "FAIL: the compositor connection was incomplete or lost." >&2
+	status=1
+fi
+
+[ "$status" -eq 0 ] && echo "PASS: Wayland window with presentation feedback under headless weston." || cat "$log" >&2
+exit "$status"
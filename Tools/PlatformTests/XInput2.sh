@@ -0,0 +1,55 @@
+#!/usr/bin/env bash
+# Checks the XInput 2 raw pointer path of the X11 platform under Xvfb: the sandbox has to select raw motion events and
+# receive those xdotool generates. The sandbox must be built with VKR_XINPUT2; it renders on lavapipe.
+#
+#   Tools/PlatformTests/XInput2.sh <path to the Sandbox executable>
+set -euo pipefail
+
+sandbox=$(realpath "${1:?usage: $0 <path to Sandbox>}")
+for tool in Xvfb xdotool; do
+	command -v "$tool" >/dev/null || { echo "SKIP: $tool is not installed." >&2; exit 77; }
+done
+
+icd=$(ls /usr/share/vulkan/icd.d/lvp_icd*.json /usr/local/share/vulkan/icd.d/lvp_icd*.json 2>/dev/null | head -n 1 || true)
+[ -n "$icd" ] || { echo "SKIP: the lavapipe ICD was not found." >&2; exit 77; }
+
+# Assets are looked up relative to the working directory. The sandbox is killed at the end, so its log is line buffered.
+cd "$(dirname "$0")/../.."
+
+display=":$((90 + RANDOM % 100))"
+log=$(mktemp)
+xvfb=
+app=
+cleanup() {
+	[ -z "$app" ] || kill "$app" 2>/dev/null || true
+	[ -z "$xvfb" ] || kill "$xvfb" 2>/dev/null || true
+	rm -f "$log"
+}
+trap cleanup EXIT
+
+Xvfb "$display" -screen 0 640x480x24 -nolisten tcp &
+xvfb=$!
+sleep 1
+
+DISPLAY="$display" VK_DRIVER_FILES="$icd" VK_ICD_FILENAMES="$icd" stdbuf -oL "$sandbox" >"$log" 2>&1 &
+app=$!
+sleep 3
+
+# XTEST motion goes through a slave of the master pointer, so it is reported as raw motion too.
+DISPLAY="$display" xdotool mousemove 100 100 mousemove_restore mousemove_relative 40 30
+sleep 1
+
+kill "$app" 2>/dev/null || true
+wait "$app" 2>/dev/null || true
+app=
+
+status=0
+for expected in "Using XInput 2 raw pointer motion." "Receiving XInput 2 raw pointer motion."; do
+	if ! grep -qF "$expected" "$log"; then
+		echo "FAIL: '$expected' was not logged." >&2
+		status=1
+	fi
+done
+
+[ "$status" -eq 0 ] && echo "PASS: raw pointer motion under Xvfb." || cat "$log" >&2
+exit "$status"
@@ -0,0 +1,151 @@
+// Packs compiled SPIR-V permutations into a single indexed file the renderer memory-maps.
+//
+// Usage: ShaderPack <output> <list>
+// Each line of the list names one permutation, fields separated by tabs:
+//   <spir-v file> <shader path relative to the asset root> [define...]
+#include "Renderers/Vulkan/ShaderPackFormat.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace Vkr;
+
+struct Permutation
+{
+    ShaderPackFormat::Entry entry{};
+    std::vector<char> code;
+    std::string description;
+};
+
+static bool ReadPermutation(const std::string &line, Permutation *outPermutation)
+{
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    for (std::string field; std::getline(stream, field, '\t');)
+    {
+        if (!field.empty())
+            fields.push_back(field);
+    }
+
+    if (fields.size() < 2)
+    {
+        fprintf(stderr, "ShaderPack: malformed line '%s'.\n", line.c_str());
+        return false;
+    }
+
+    std::ifstream file(fields[0], std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        fprintf(stderr, "ShaderPack: failed to open '%s'.\n", fields[0].c_str());
+        return false;
+    }
+
+    outPermutation->code.resize((size_t)file.tellg());
+    file.seekg(0);
+    file.read(outPermutation->code.data(), (std::streamsize)outPermutation->code.size());
+
+    if (outPermutation->code.empty() || outPermutation->code.size() % sizeof(uint32_t) != 0)
+    {
+        fprintf(stderr, "ShaderPack: '%s' is not a SPIR-V module.\n", fields[0].c_str());
+        return false;
+    }
+
+    std::vector<std::string> defines(fields.begin() + 2, fields.end());
+    outPermutation->entry.key = ShaderPackFormat::PermutationKey(fields[1], defines);
+    outPermutation->entry.contentHash = ShaderPackFormat::Hash(outPermutation->code.data(), outPermutation->code.size());
+    outPermutation->entry.size = outPermutation->code.size();
+    outPermutation->description = line;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: ShaderPack <output> <list>\n");
+        return 1;
+    }
+
+    std::ifstream list(argv[2]);
+    if (!list.is_open())
+    {
+        fprintf(stderr, "ShaderPack: failed to open '%s'.\n", argv[2]);
+        return 1;
+    }
+
+    std::vector<Permutation> permutations;
+    for (std::string line; std::getline(list, line);)
+    {
+        if (line.empty())
+            continue;
+
+        Permutation permutation;
+        if (!ReadPermutation(line, &permutation))
+            return 1;
+
+        permutations.push_back(std::move(permutation));
+    }
+
+    std::sort(permutations.begin(), permutations.end(),
+              [](const Permutation &a, const Permutation &b) { return a.entry.key < b.entry.key; });
+
+    for (size_t i = 1; i < permutations.size(); ++i)
+    {
+        if (permutations[i].entry.key == permutations[i - 1].entry.key)
+        {
+            fprintf(stderr, "ShaderPack: duplicate permutation '%s'.\n", permutations[i].description.c_str());
+            return 1;
+        }
+    }
+
+    ShaderPackFormat::Header header{};
+    header.magic = ShaderPackFormat::MAGIC;
+    header.version = ShaderPackFormat::VERSION;
+    header.entryCount = (uint32_t)permutations.size();
+
+    uint64_t offset = sizeof(header) + permutations.size() * sizeof(ShaderPackFormat::Entry);
+    for (auto &permutation : permutations)
+    {
+        offset = (offset + ShaderPackFormat::ALIGNMENT - 1) & ~(ShaderPackFormat::ALIGNMENT - 1);
+        permutation.entry.offset = offset;
+        offset += permutation.entry.size;
+    }
+
+    // Written next to the output and renamed over it, so a running engine never maps a half written pack.
+    std::string output = argv[1];
+    std::string tempOutput = output + ".tmp";
+    {
+        std::ofstream file(tempOutput, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        for (const auto &permutation : permutations)
+        {
+            file.write(reinterpret_cast<const char *>(&permutation.entry), sizeof(permutation.entry));
+        }
+
+        const char padding[ShaderPackFormat::ALIGNMENT]{};
+        for (const auto &permutation : permutations)
+        {
+            file.write(padding, (std::streamsize)(permutation.entry.offset - (uint64_t)file.tellp()));
+            file.write(permutation.code.data(), (std::streamsize)permutation.code.size());
+        }
+
+        if (!file.good())
+        {
+            fprintf(stderr, "ShaderPack: failed to write '%s'.\n", tempOutput.c_str());
+            return 1;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempOutput, output, error);
+    if (error)
+    {
+        fprintf(stderr, "ShaderPack: failed to replace '%s': %s\n", output.c_str(), error.message().c_str());
+        return 1;
+    }
+
+    printf("ShaderPack: packed %zu permutations into '%s' (%llu bytes).\n", permutations.size(), output.c_str(),
+           (unsigned long long)offset);
+    return 0;
+}